@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Runtime/HashMap.h"
+#include "Runtime/String.h"
+#include "Runtime/Vector.h"
+#include "Runtime/kmalloc.h"
+#include <stdlib.h>
+
+// kmalloc()/kfree_sized() against malloc()/free() on the same allocation patterns, and a container workload that
+// allocates through kmalloc(). Building with -DRUNTIME_SLAB_ALLOCATOR=OFF sends kmalloc() to malloc() as well, for
+// the container numbers to compare against.
+
+struct Kmalloc {
+
+    static void* allocate(size_t size) { return kmalloc(size); }
+
+    static void free(void* pointer, size_t size) { kfree_sized(pointer, size); }
+};
+
+struct Malloc {
+
+    static void* allocate(size_t size) { return malloc(size); }
+
+    static void free(void* pointer, size_t) { ::free(pointer); }
+};
+
+static constexpr size_t batchSize = 1000;
+
+static constexpr size_t liveBlockCount = 4096;
+
+template<typename Allocator>
+static void allocateAndFreeAtOnce(size_t count) {
+
+    for (size_t i = 0; i < count; ++i) {
+
+        auto* block = Allocator::allocate(48);
+
+        Benchmark::doNotOptimize(block);
+
+        Allocator::free(block, 48);
+    }
+}
+
+template<typename Allocator>
+static void allocateBatchesThenFree(size_t count) {
+
+    void* blocks[batchSize];
+
+    for (size_t done = 0; done < count; done += batchSize) {
+
+        for (size_t i = 0; i < batchSize; ++i) {
+
+            blocks[i] = Allocator::allocate(48);
+        }
+
+        Benchmark::doNotOptimize(blocks);
+
+        for (size_t i = 0; i < batchSize; ++i) {
+
+            Allocator::free(blocks[i], 48);
+        }
+    }
+}
+
+// Frees a random one of `liveBlockCount` blocks and replaces it with one of another random size, 1 to 256 bytes.
+
+template<typename Allocator>
+static void churn(size_t count) {
+
+    static void* blocks[liveBlockCount];
+
+    static size_t sizes[liveBlockCount];
+
+    Benchmark::Random random;
+
+    for (size_t i = 0; i < liveBlockCount; ++i) {
+
+        sizes[i] = random.next() % 256 + 1;
+
+        blocks[i] = Allocator::allocate(sizes[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+
+        auto victim = random.next() % liveBlockCount;
+
+        Allocator::free(blocks[victim], sizes[victim]);
+
+        sizes[victim] = random.next() % 256 + 1;
+
+        blocks[victim] = Allocator::allocate(sizes[victim]);
+
+        *static_cast<char*>(blocks[victim]) = 1;
+    }
+
+    for (size_t i = 0; i < liveBlockCount; ++i) {
+
+        Allocator::free(blocks[i], sizes[i]);
+    }
+}
+
+static void buildMaps(size_t count) {
+
+    for (size_t round = 0; round < count; ++round) {
+
+        HashMap<String, Vector<String>> map;
+
+        for (size_t i = 0; i < 4000; ++i) {
+
+            auto key = String::formatted("a key that is long enough for the heap {}", i % 97);
+
+            auto it = map.find(key);
+
+            if (it == map.end()) {
+
+                MUST(map.set(key, { }));
+
+                it = map.find(key);
+            }
+
+            it->value.append(String::formatted("value number {} with some padding to be long", i));
+        }
+
+        Benchmark::doNotOptimize(map.size());
+    }
+}
+
+int main(int argc, char** argv) {
+
+    auto count = Benchmark::countArgument(argc, argv, 10'000'000);
+
+    Benchmark::report("kmalloc, allocate and free 48 B", count, Benchmark::fastestOf(3, [&] { allocateAndFreeAtOnce<Kmalloc>(count); }), "pairs"sv);
+
+    Benchmark::report("malloc, allocate and free 48 B", count, Benchmark::fastestOf(3, [&] { allocateAndFreeAtOnce<Malloc>(count); }), "pairs"sv);
+
+    Benchmark::report("kmalloc, 1000 x 48 B then free", count, Benchmark::fastestOf(3, [&] { allocateBatchesThenFree<Kmalloc>(count); }), "pairs"sv);
+
+    Benchmark::report("malloc, 1000 x 48 B then free", count, Benchmark::fastestOf(3, [&] { allocateBatchesThenFree<Malloc>(count); }), "pairs"sv);
+
+    Benchmark::report("kmalloc, random churn, 1-256 B", count, Benchmark::fastestOf(3, [&] { churn<Kmalloc>(count); }), "pairs"sv);
+
+    Benchmark::report("malloc, random churn, 1-256 B", count, Benchmark::fastestOf(3, [&] { churn<Malloc>(count); }), "pairs"sv);
+
+    auto map_count = max(static_cast<size_t>(1), count / 100'000);
+
+    auto elapsed = Benchmark::fastestOf(3, [&] { buildMaps(map_count); });
+
+    outln("{:<40} {:>12} {:>10.3} ms per map", "HashMap<String, Vector<String>> build", map_count, elapsed * 1e3 / static_cast<double>(map_count));
+
+    return 0;
+}
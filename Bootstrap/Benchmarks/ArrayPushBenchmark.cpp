@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Builtins/Array.h"
+
+// Pushes per second into an Array growing from empty, for 10^6 elements up to the count given on the command line
+// (10^8 by default), against the same pushes into an array sized up front.
+
+template<typename T>
+static void pushInto(size_t count, bool reserve) {
+
+    Array<T> array;
+
+    if (reserve) {
+
+        MUST(array.ensureCapacity(count));
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+
+        MUST(array.push(static_cast<T>(i)));
+    }
+
+    Benchmark::doNotOptimize(array.size());
+}
+
+int main(int argc, char** argv) {
+
+    auto maximum = Benchmark::countArgument(argc, argv, 100'000'000);
+
+    for (size_t count = 1'000'000; count <= maximum; count *= 10) {
+
+        auto repetitions = count >= 100'000'000 ? 1 : 3;
+
+        Benchmark::report("Array<UInt32>::push", count, Benchmark::fastestOf(repetitions, [&] { pushInto<UInt32>(count, false); }), "pushes"sv);
+
+        Benchmark::report("Array<UInt32>::push, reserved", count, Benchmark::fastestOf(repetitions, [&] { pushInto<UInt32>(count, true); }), "pushes"sv);
+
+        Benchmark::report("Array<UInt64>::push", count, Benchmark::fastestOf(repetitions, [&] { pushInto<UInt64>(count, false); }), "pushes"sv);
+    }
+
+    return 0;
+}
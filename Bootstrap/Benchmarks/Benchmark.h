@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Runtime/Format.h"
+#include "Runtime/StringView.h"
+#include "Runtime/Types.h"
+#include <stdlib.h>
+#include <time.h>
+
+// Just enough of a harness for the programs in this directory: a clock, a way to keep the compiler from throwing
+// the measured work away, and a table row printer. Every benchmark is a plain executable that prints its results;
+// none of them run under ctest.
+
+namespace Benchmark {
+
+    inline double now() {
+
+        timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    // Runs `callback` once and returns how long it took, in seconds.
+
+    template<typename Callback>
+    double measure(Callback callback) {
+
+        auto start = now();
+
+        callback();
+
+        return now() - start;
+    }
+
+    // Runs `callback` `repetitions` times and returns the fastest run, in seconds.
+
+    template<typename Callback>
+    double fastestOf(size_t repetitions, Callback callback) {
+
+        double fastest = 0;
+
+        for (size_t i = 0; i < repetitions; ++i) {
+
+            auto elapsed = measure(callback);
+
+            if (i == 0 || elapsed < fastest) {
+
+                fastest = elapsed;
+            }
+        }
+
+        return fastest;
+    }
+
+    template<typename T>
+    void doNotOptimize(T const& value) {
+
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // The first command line argument as a count, or `fallback` without one. Lets a run be cut short on a small
+    // machine.
+
+    inline size_t countArgument(int argc, char** argv, size_t fallback) {
+
+        if (argc < 2) {
+
+            return fallback;
+        }
+
+        return static_cast<size_t>(strtoull(argv[1], nullptr, 10));
+    }
+
+    inline void report(StringView name, size_t count, double seconds, StringView unit) {
+
+        outln("{:<40} {:>12} {:>10.3} ms {:>10.2} M{}/s", name, count, seconds * 1e3, static_cast<double>(count) / seconds / 1e6, unit);
+    }
+
+    // Deterministic pseudo-random numbers, so that runs before and after a change see the same input.
+
+    class Random {
+
+    public:
+
+        explicit Random(UInt64 seed = 0x9e3779b97f4a7c15)
+            : m_state(seed) { }
+
+        UInt64 next() {
+
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 7;
+            m_state ^= m_state << 17;
+
+            return m_state;
+        }
+
+    private:
+
+        UInt64 m_state;
+    };
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Runtime/StringUtils.h"
+#include "Runtime/StringView.h"
+#include "Runtime/kmalloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// StringView::to_double() against strtod() on the same random literals, once printed with every significant digit
+// and once with three decimals. Throughput is in bytes of text parsed.
+
+static constexpr size_t literalLength = 32;
+
+static void run(char const* printf_format, StringView parser_name, StringView strtod_name, size_t count) {
+
+    auto* text = static_cast<char*>(kmalloc(count * literalLength));
+
+    auto* views = static_cast<StringView*>(kmalloc(count * sizeof(StringView)));
+
+    VERIFY(text && views);
+
+    Benchmark::Random random;
+
+    size_t bytes = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        auto value = static_cast<double>(random.next() >> 11) / static_cast<double>(1ull << 30);
+
+        auto* literal = text + i * literalLength;
+
+        auto length = static_cast<size_t>(snprintf(literal, literalLength, printf_format, value));
+
+        new (&views[i]) StringView(literal, length);
+
+        bytes += length;
+    }
+
+    auto elapsed = Benchmark::fastestOf(3, [&] {
+
+        double sum = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+
+            sum += views[i].to_double().value();
+        }
+
+        Benchmark::doNotOptimize(sum);
+    });
+
+    Benchmark::report(parser_name, bytes, elapsed, "B"sv);
+
+    elapsed = Benchmark::fastestOf(3, [&] {
+
+        double sum = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+
+            sum += strtod(text + i * literalLength, nullptr);
+        }
+
+        Benchmark::doNotOptimize(sum);
+    });
+
+    Benchmark::report(strtod_name, bytes, elapsed, "B"sv);
+
+    kfree_sized(views, count * sizeof(StringView));
+
+    kfree_sized(text, count * literalLength);
+}
+
+int main(int argc, char** argv) {
+
+    auto count = Benchmark::countArgument(argc, argv, 1'000'000);
+
+    run("%.17g", "to_double, %.17g literals"sv, "strtod, %.17g literals"sv, count);
+
+    run("%.3f", "to_double, %.3f literals"sv, "strtod, %.3f literals"sv, count);
+
+    return 0;
+}
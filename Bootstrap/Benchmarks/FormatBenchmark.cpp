@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Runtime/StringBuilder.h"
+#include <stdio.h>
+
+// vformat() throughput on log-line shaped format strings: mostly literal text with a few integer and string
+// arguments, some of them padded. snprintf() with the equivalent format is printed alongside for scale.
+
+static constexpr size_t lineCount = 1'000'000;
+
+int main(int argc, char** argv) {
+
+    auto count = Benchmark::countArgument(argc, argv, lineCount);
+
+    StringBuilder builder;
+
+    auto elapsed = Benchmark::fastestOf(3, [&] {
+
+        for (size_t i = 0; i < count; ++i) {
+
+            builder.clear();
+
+            builder.appendff("[{}] worker {} finished request {} for {} in {} ms", "info"sv, i % 16, i, "/api/v1/items"sv, i % 1000);
+
+            Benchmark::doNotOptimize(builder.length());
+        }
+    });
+
+    Benchmark::report("appendff, plain log line", count, elapsed, "lines"sv);
+
+    elapsed = Benchmark::fastestOf(3, [&] {
+
+        for (size_t i = 0; i < count; ++i) {
+
+            builder.clear();
+
+            builder.appendff("{:>8} | {:<12} | {:08x} | {:>10}", i, "status"sv, i * 2654435761u, i % 100000);
+
+            Benchmark::doNotOptimize(builder.length());
+        }
+    });
+
+    Benchmark::report("appendff, padded columns", count, elapsed, "lines"sv);
+
+    char buffer[256];
+
+    elapsed = Benchmark::fastestOf(3, [&] {
+
+        for (size_t i = 0; i < count; ++i) {
+
+            auto length = snprintf(buffer, sizeof(buffer), "[%s] worker %zu finished request %zu for %s in %zu ms", "info", i % 16, i, "/api/v1/items", i % 1000);
+
+            Benchmark::doNotOptimize(length);
+        }
+    });
+
+    Benchmark::report("snprintf, plain log line", count, elapsed, "lines"sv);
+
+    elapsed = Benchmark::fastestOf(3, [&] {
+
+        for (size_t i = 0; i < count; ++i) {
+
+            auto length = snprintf(buffer, sizeof(buffer), "%8zu | %-12s | %08zx | %10zu", i, "status", i * 2654435761u, i % 100000);
+
+            Benchmark::doNotOptimize(length);
+        }
+    });
+
+    Benchmark::report("snprintf, padded columns", count, elapsed, "lines"sv);
+
+    return 0;
+}
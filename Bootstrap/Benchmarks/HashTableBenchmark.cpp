@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Runtime/HashMap.h"
+#include "Runtime/kmalloc.h"
+
+// Insert, hit, miss, erase and reinsert costs of HashMap<UInt64, UInt64> (a HashTable underneath) with random
+// keys, from 10^3 entries up to the count given on the command line (10^7 by default; 10^8 needs several GiB).
+// Small tables are rebuilt and measured repeatedly so that every row covers a comparable number of operations.
+
+static constexpr size_t operationsPerRow = 10'000'000;
+
+struct Timings {
+
+    double insert { 0 };
+    double hit { 0 };
+    double miss { 0 };
+    double erase { 0 };
+    double reinsert { 0 };
+};
+
+static void measureOnce(UInt64 const* keys, UInt64 const* missing_keys, size_t count, Timings& timings) {
+
+    HashMap<UInt64, UInt64> map;
+
+    timings.insert += Benchmark::measure([&] {
+
+        for (size_t i = 0; i < count; ++i) {
+
+            MUST(map.set(keys[i], i));
+        }
+    });
+
+    timings.hit += Benchmark::measure([&] {
+
+        size_t found = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+
+            found += map.contains(keys[i]);
+        }
+
+        Benchmark::doNotOptimize(found);
+    });
+
+    timings.miss += Benchmark::measure([&] {
+
+        size_t found = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+
+            found += map.contains(missing_keys[i]);
+        }
+
+        Benchmark::doNotOptimize(found);
+    });
+
+    // Erase every other key, then put them back: the reinsertions land in a table that has seen deletions.
+
+    timings.erase += Benchmark::measure([&] {
+
+        for (size_t i = 0; i < count; i += 2) {
+
+            map.remove(keys[i]);
+        }
+    });
+
+    timings.reinsert += Benchmark::measure([&] {
+
+        for (size_t i = 0; i < count; i += 2) {
+
+            MUST(map.set(keys[i], i));
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+
+    auto maximum = Benchmark::countArgument(argc, argv, 10'000'000);
+
+    auto* keys = static_cast<UInt64*>(kmalloc(maximum * sizeof(UInt64)));
+
+    auto* missing_keys = static_cast<UInt64*>(kmalloc(maximum * sizeof(UInt64)));
+
+    VERIFY(keys && missing_keys);
+
+    Benchmark::Random random;
+
+    for (size_t i = 0; i < maximum; ++i) {
+
+        keys[i] = random.next();
+
+        missing_keys[i] = random.next();
+    }
+
+    outln("{:>12} {:>10} {:>10} {:>10} {:>10} {:>10}   (ns per operation)", "entries", "insert", "hit", "miss", "erase", "reinsert");
+
+    for (size_t count = 1000; count <= maximum; count *= 10) {
+
+        auto rounds = max(static_cast<size_t>(1), operationsPerRow / count);
+
+        Timings timings;
+
+        for (size_t round = 0; round < rounds; ++round) {
+
+            measureOnce(keys, missing_keys, count, timings);
+        }
+
+        auto operations = static_cast<double>(count * rounds);
+
+        auto half_operations = static_cast<double>(((count + 1) / 2) * rounds);
+
+        outln("{:>12} {:>10.1} {:>10.1} {:>10.1} {:>10.1} {:>10.1}", count, timings.insert * 1e9 / operations, timings.hit * 1e9 / operations, timings.miss * 1e9 / operations, timings.erase * 1e9 / half_operations, timings.reinsert * 1e9 / half_operations);
+    }
+
+    kfree_sized(missing_keys, maximum * sizeof(UInt64));
+
+    kfree_sized(keys, maximum * sizeof(UInt64));
+
+    return 0;
+}
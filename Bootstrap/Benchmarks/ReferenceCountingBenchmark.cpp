@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Benchmark.h"
+#include "Runtime/AtomicReferenceCounted.h"
+#include "Runtime/ReferenceCounted.h"
+#include "Runtime/ReferencePointer.h"
+#include "Runtime/String.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// Reference/dereference pairs through ReferencePointer copies: ReferenceCounted on one thread against
+// AtomicReferenceCounted on one thread and on several threads sharing the same object, so that they contend for
+// its count. String copies are included since StringImpl is atomically counted.
+
+class PlainObject : public ReferenceCounted<PlainObject> {
+
+public:
+
+    int value { 0 };
+};
+
+class AtomicObject : public AtomicReferenceCounted<AtomicObject> {
+
+public:
+
+    int value { 0 };
+};
+
+static constexpr size_t maximumThreadCount = 8;
+
+template<typename T>
+static void copyReferences(T const& original, size_t count) {
+
+    for (size_t i = 0; i < count; ++i) {
+
+        T copy = original;
+
+        Benchmark::doNotOptimize(copy);
+    }
+}
+
+template<typename T>
+struct ThreadArguments {
+
+    T const* original;
+
+    size_t count;
+};
+
+template<typename T>
+static void* threadEntry(void* argument) {
+
+    auto* arguments = static_cast<ThreadArguments<T>*>(argument);
+
+    copyReferences(*arguments->original, arguments->count);
+
+    return nullptr;
+}
+
+// Copies `original` `count` times on each of `thread_count` threads at once.
+
+template<typename T>
+static double copyOnThreads(T const& original, size_t count, size_t thread_count) {
+
+    pthread_t threads[maximumThreadCount];
+
+    ThreadArguments<T> arguments { &original, count };
+
+    return Benchmark::measure([&] {
+
+        for (size_t i = 0; i < thread_count; ++i) {
+
+            if (pthread_create(&threads[i], nullptr, threadEntry<T>, &arguments) != 0) {
+
+                abort();
+            }
+        }
+
+        for (size_t i = 0; i < thread_count; ++i) {
+
+            pthread_join(threads[i], nullptr);
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+
+    auto count = Benchmark::countArgument(argc, argv, 10'000'000);
+
+    auto plain = adoptReference(*new PlainObject);
+
+    auto atomic = adoptReference(*new AtomicObject);
+
+    auto string = String::repeated('x', 64);
+
+    Benchmark::report("ReferenceCounted", count, Benchmark::fastestOf(3, [&] { copyReferences(plain, count); }), "pairs"sv);
+
+    Benchmark::report("AtomicReferenceCounted", count, Benchmark::fastestOf(3, [&] { copyReferences(atomic, count); }), "pairs"sv);
+
+    Benchmark::report("String", count, Benchmark::fastestOf(3, [&] { copyReferences(string, count); }), "pairs"sv);
+
+    for (size_t thread_count = 1; thread_count <= maximumThreadCount; thread_count *= 2) {
+
+        auto elapsed = copyOnThreads(atomic, count, thread_count);
+
+        outln("{:<40} {:>12} {:>10.3} ms {:>10.2} Mpairs/s", String::formatted("AtomicReferenceCounted, shared by {}", thread_count), count * thread_count, elapsed * 1e3, static_cast<double>(count * thread_count) / elapsed / 1e6);
+    }
+
+    VERIFY(atomic->ref_count() == 1 && string.impl()->ref_count() == 1);
+
+    return 0;
+}
@@ -2,22 +2,73 @@
 
 #include "../Runtime/Checked.h"
 #include "../Runtime/Error.h"
+#include "../Runtime/Optional.h"
+#include "../Runtime/NonNullReferencePointer.h"
 #include "../Runtime/ReferenceCounted.h"
+#include "../Runtime/ReferencePointer.h"
+#include "../Runtime/Span.h"
+#include "../Runtime/TypedTransfer.h"
+#include "../Runtime/Vector.h"
+#include "../Runtime/kmalloc.h"
 #include <initializer_list>
-#include <stdlib.h>
 
 namespace NeuInternal {
 
+    // The header and the first inlineCapacity() elements share one allocation, the way StringImpl keeps its
+    // characters, so a short array costs a single kmalloc() and its elements sit next to the size they are checked
+    // against. Growing past the inline region moves the elements out to a buffer of their own; shrinking back into
+    // it moves them home again.
+
     template<typename T>
     class ArrayStorage : public ReferenceCounted<ArrayStorage<T>> {
 
     public:
 
-        ArrayStorage() { }
+        // Makes room for at least `inline_capacity` elements, and for as many more as fit in the slack of the
+        // allocation anyway.
+
+        static ErrorOr<NonNullReferencePointer<ArrayStorage>> create(size_t inline_capacity) {
+
+            if (Checked<size_t>::multiplicationWouldOverflow(inline_capacity, sizeof(T)) || Checked<size_t>::additionWouldOverflow(inline_capacity * sizeof(T), inlineOffset())) {
+
+                return Error::fromErrorCode(EOVERFLOW);
+            }
+
+            inline_capacity = (kmalloc_good_size(allocationSize(inline_capacity)) - inlineOffset()) / sizeof(T);
+
+            auto* slot = kmalloc(allocationSize(inline_capacity), AllocationSite::ArrayStorage);
+
+            if (!slot) {
+
+                return Error::fromErrorCode(ENOMEM);
+            }
+
+            return adoptReference(*new (slot) ArrayStorage(inline_capacity));
+        }
+
+        void operator delete(void* ptr) {
+
+            kfree_sized(ptr, allocationSize(static_cast<ArrayStorage*>(ptr)->m_inline_capacity), AllocationSite::ArrayStorage);
+        }
 
         bool isEmpty() const { return m_size == 0; }
         size_t size() const { return m_size; }
         size_t capacity() const { return m_capacity; }
+        size_t inlineCapacity() const { return m_inline_capacity; }
+        bool isInline() const { return m_elements == inlineElements(); }
+
+        ~ArrayStorage() {
+
+            for (size_t i = 0; i < m_size; ++i) {
+
+                m_elements[i].~T();
+            }
+
+            if (!isInline()) {
+
+                kfree_sized(m_elements, m_capacity * sizeof(T), AllocationSite::ArrayStorage);
+            }
+        }
 
         ErrorOr<void> ensureCapacity(size_t capacity) {
 
@@ -26,31 +77,29 @@ namespace NeuInternal {
                 return {};
             }
 
-            if (Checked<size_t>::multiplicationWouldOverflow(capacity, sizeof(T))) {
+            return reallocate(capacity);
+        }
 
-                return Error::fromErrorCode(EOVERFLOW);
-            }
+        // Grows geometrically so that repeated pushes are amortized O(1).
 
-            auto* new_elements = static_cast<T*>(malloc(capacity * sizeof(T)));
-            
-            if (!new_elements) {
+        ErrorOr<void> growCapacity(size_t neededCapacity) {
 
-                return Error::fromErrorCode(ENOMEM);
+            if (m_capacity >= neededCapacity) {
+
+                return { };
             }
-            
-            for (size_t i = 0; i < m_size; ++i) {
-                
-                new (&new_elements[i]) T(move(m_elements[i]));
-                
-                m_elements[i].~T();
+
+            return ensureCapacity(max(neededCapacity, paddedCapacity(m_capacity)));
+        }
+
+        ErrorOr<void> shrinkToFit() {
+
+            if (isInline() || m_capacity == m_size) {
+
+                return { };
             }
 
-            free(m_elements);
-            
-            m_elements = new_elements;
-            m_capacity = capacity;
-            
-            return { };
+            return reallocate(m_size);
         }
 
         ErrorOr<void> add_capacity(size_t capacity)
@@ -86,7 +135,7 @@ namespace NeuInternal {
 
         ErrorOr<void> resize(size_t size) {
 
-            TRY(ensureCapacity(size));
+            TRY(growCapacity(size));
             
             if (size > m_size) {
                 for (size_t i = m_size; i < size; ++i) {
@@ -120,7 +169,7 @@ namespace NeuInternal {
 
         ErrorOr<void> push(T value) {
 
-            TRY(ensureCapacity(m_size + 1));
+            TRY(growCapacity(m_size + 1));
             
             new (&m_elements[m_size]) T(move(value));
             
@@ -131,7 +180,12 @@ namespace NeuInternal {
 
         ErrorOr<void> push_values(T const* values, size_t count) {
 
-            TRY(add_capacity(count));
+            if (Checked<size_t>::additionWouldOverflow(m_size, count)) {
+
+                return Error::fromErrorCode(EOVERFLOW);
+            }
+
+            TRY(growCapacity(m_size + count));
             
             for (size_t i = 0; i < count; ++i) {
                 
@@ -145,13 +199,152 @@ namespace NeuInternal {
 
         T* unsafeData() { return m_elements; }
 
+        T* begin() { return m_elements; }
+        T* end() { return m_elements + m_size; }
+        T const* begin() const { return m_elements; }
+        T const* end() const { return m_elements + m_size; }
+
+        // Hands the out-of-line buffer over together with the elements in it (see KmallocBuffer in kmalloc.h),
+        // leaving the storage empty. Elements in the inline region can't be handed over; then nothing happens.
+
+        Optional<KmallocBuffer<T>> releaseBuffer() {
+
+            if (isInline()) {
+
+                return { };
+            }
+
+            KmallocBuffer<T> buffer { m_elements, m_size, m_capacity, AllocationSite::ArrayStorage };
+
+            m_elements = inlineElements();
+            m_size = 0;
+            m_capacity = m_inline_capacity;
+
+            return buffer;
+        }
+
+        // Takes over a buffer released by another container, with its elements. The storage must be empty.
+
+        void adoptBuffer(KmallocBuffer<T> buffer) {
+
+            VERIFY(m_size == 0);
+
+            if (!buffer.elements) {
+
+                return;
+            }
+
+            if (!isInline()) {
+
+                kfree_sized(m_elements, m_capacity * sizeof(T), AllocationSite::ArrayStorage);
+            }
+
+            kmallocTransferBuffer(buffer, AllocationSite::ArrayStorage);
+
+            m_elements = buffer.elements;
+            m_size = buffer.size;
+            m_capacity = buffer.capacity;
+        }
+
     private:
 
+        static size_t paddedCapacity(size_t capacity) {
+
+            if (Checked<size_t>::additionWouldOverflow(capacity, capacity / 2)) {
+
+                return capacity;
+            }
+
+            return max(static_cast<size_t>(4), capacity + (capacity / 2));
+        }
+
+        explicit ArrayStorage(size_t inline_capacity)
+            : m_capacity(inline_capacity),
+              m_elements(inlineElements()),
+              m_inline_capacity(inline_capacity) { }
+
+        static constexpr size_t inlineOffset() { return align_up_to(sizeof(ArrayStorage), alignof(T)); }
+
+        static constexpr size_t allocationSize(size_t inline_capacity) { return inlineOffset() + inline_capacity * sizeof(T); }
+
+        T* inlineElements() { return reinterpret_cast<T*>(reinterpret_cast<UInt8*>(this) + inlineOffset()); }
+
+        T const* inlineElements() const { return reinterpret_cast<T const*>(reinterpret_cast<UInt8 const*>(this) + inlineOffset()); }
+
+        ErrorOr<void> reallocate(size_t capacity) {
+
+            if (Checked<size_t>::multiplicationWouldOverflow(capacity, sizeof(T))) {
+
+                return Error::fromErrorCode(EOVERFLOW);
+            }
+
+            auto was_inline = isInline();
+
+            T* new_elements;
+
+            if (capacity <= m_inline_capacity) {
+
+                if (was_inline) {
+
+                    return { };
+                }
+
+                new_elements = inlineElements();
+
+                capacity = m_inline_capacity;
+            }
+            else if constexpr (Traits<T>::isTriviallyRelocatable()) {
+
+                // Elements that relocate with memcpy can be moved by the allocator
+                // itself, which lets it grow the block in place (or via mremap for large blocks).
+
+                if (!was_inline) {
+
+                    new_elements = static_cast<T*>(krealloc(m_elements, capacity * sizeof(T), AllocationSite::ArrayStorage));
+
+                    if (!new_elements) {
+
+                        return Error::fromErrorCode(ENOMEM);
+                    }
+
+                    m_elements = new_elements;
+                    m_capacity = capacity;
+
+                    return { };
+                }
+
+                new_elements = static_cast<T*>(kmalloc(capacity * sizeof(T), AllocationSite::ArrayStorage));
+            }
+            else {
+
+                new_elements = static_cast<T*>(kmalloc(capacity * sizeof(T), AllocationSite::ArrayStorage));
+            }
+
+            if (!new_elements) {
+
+                return Error::fromErrorCode(ENOMEM);
+            }
+
+            TypedTransfer<T>::relocate(new_elements, m_elements, m_size);
+
+            if (!was_inline) {
+
+                kfree_sized(m_elements, m_capacity * sizeof(T), AllocationSite::ArrayStorage);
+            }
+
+            m_elements = new_elements;
+            m_capacity = capacity;
+
+            return { };
+        }
+
         size_t m_size { 0 };
         
         size_t m_capacity { 0 };
         
         T* m_elements { nullptr };
+
+        size_t m_inline_capacity { 0 };
     };
 
     template<typename T>
@@ -166,6 +359,10 @@ namespace NeuInternal {
         ArraySlice& operator=(ArraySlice&&) = default;
         ~ArraySlice() = default;
 
+        // A view of up to `size` elements of `storage`, starting at `offset`. Nothing is copied: the slice shares
+        // the storage, and sees whatever is in that range at the time it is read. If the array shrinks, the slice
+        // shrinks with it.
+
         ArraySlice(NonNullReferencePointer<ArrayStorage<T>> storage, size_t offset, size_t size)
             : m_storage(move(storage)), 
               m_offset(offset), 
@@ -173,7 +370,7 @@ namespace NeuInternal {
 
             VERIFY(m_storage);
             
-            VERIFY(m_offset < m_storage->size());
+            VERIFY(m_offset <= m_storage->size());
         }
 
         bool isEmpty() const { return size() == 0; }
@@ -191,15 +388,64 @@ namespace NeuInternal {
 
             size_t available_in_storage = m_storage->size() - m_offset;
             
-            return max(m_size, available_in_storage);
+            return min(m_size, available_in_storage);
+        }
+
+        T const& at(size_t index) const {
+
+            VERIFY(index < size());
+
+            return m_storage->at(m_offset + index);
+        }
+
+        T& at(size_t index) {
+
+            VERIFY(index < size());
+
+            return m_storage->at(m_offset + index);
         }
 
-        T const& at(size_t index) const { return m_storage->at(m_offset + index); }
-        T& at(size_t index) { return m_storage->at(m_offset + index); }
         T const& operator[](size_t index) const { return at(index); }
         T& operator[](size_t index) { return at(index); }
 
+        T* begin() { return data(); }
+        T* end() { return data() + size(); }
+        T const* begin() const { return data(); }
+        T const* end() const { return data() + size(); }
+
+        // Another view into the same storage, `offset` elements into this one and no longer than it.
+
+        ArraySlice subslice(size_t offset, size_t size) const {
+
+            VERIFY(offset <= this->size());
+
+            if (!m_storage) {
+
+                return { };
+            }
+
+            return { *const_cast<ArrayStorage<T>*>(m_storage.pointer()), m_offset + offset, min(size, this->size() - offset) };
+        }
+
+        ArraySlice subslice(size_t offset) const { return subslice(offset, size() - offset); }
+
+        Span<T> span() { return { data(), size() }; }
+        Span<T const> span() const { return { data(), size() }; }
+
+        operator Span<T const>() const { return span(); }
+
     private:
+
+        T* data() const {
+
+            if (!m_storage) {
+
+                return nullptr;
+            }
+
+            return const_cast<ArrayStorage<T>*>(m_storage.pointer())->unsafeData() + min(m_offset, m_storage->size());
+        }
+
         ReferencePointer<ArrayStorage<T>> m_storage;
         size_t m_offset { 0 };
         size_t m_size { 0 };
@@ -218,9 +464,7 @@ namespace NeuInternal {
             if (m_index >= m_storage->size()) {
                 return {};
             }
-            auto current = m_storage->at(m_index);
-            ++m_index;
-            return current;
+            return m_storage->at(m_index++);
         }
 
     private:
@@ -266,7 +510,7 @@ namespace NeuInternal {
 
         ErrorOr<void> push_values(T const* values, size_t count) {
 
-            auto* storage = TRY(ensureStorage());
+            auto* storage = TRY(ensureStorage(count));
             
             TRY(storage->push_values(values, count));
             
@@ -297,7 +541,7 @@ namespace NeuInternal {
 
         ErrorOr<void> ensureCapacity(size_t capacity) {
 
-            auto* storage = TRY(ensureStorage());
+            auto* storage = TRY(ensureStorage(capacity));
             
             TRY(storage->ensureCapacity(capacity));
             
@@ -306,16 +550,28 @@ namespace NeuInternal {
 
         ErrorOr<void> add_capacity(size_t capacity) {
 
-            auto* storage = TRY(ensureStorage());
+            auto* storage = TRY(ensureStorage(capacity));
             
             TRY(storage->add_capacity(capacity));
             
             return {};
         }
 
+        ErrorOr<void> shrinkToFit() {
+
+            if (!m_storage) {
+
+                return { };
+            }
+
+            TRY(m_storage->shrinkToFit());
+
+            return { };
+        }
+
         ErrorOr<void> addSize(size_t size) {
 
-            auto* storage = TRY(ensureStorage());
+            auto* storage = TRY(ensureStorage(size));
             
             TRY(storage->addSize(size));
             
@@ -336,7 +592,7 @@ namespace NeuInternal {
 
             if (size != this->size()) {
 
-                auto* storage = TRY(ensureStorage());
+                auto* storage = TRY(ensureStorage(size));
                 
                 TRY(storage->resize(size));
             }
@@ -376,10 +632,74 @@ namespace NeuInternal {
 
             MUST(ensureCapacity(vector.size()));
 
-            for (auto value : vector) {
+            MUST(push_values(vector.data(), vector.size()));
+        }
+
+        // Takes over the vector's heap buffer as it is, elements and all. Only elements a vector keeps inline
+        // are moved over one by one.
+
+        Array(Vector<T>&& vector) {
+
+            if (auto buffer = vector.releaseBuffer(); buffer.hasValue()) {
+
+                m_storage = MUST(ArrayStorage<T>::create(0));
+
+                m_storage->adoptBuffer(buffer.releaseValue());
+
+                return;
+            }
+
+            MUST(ensureCapacity(vector.size()));
+
+            for (auto& value : vector) {
 
                 MUST(push(move(value)));
             }
+
+            vector.clear();
+        }
+
+        // The elements as a Vector. An array that is the only reference to its storage gives the vector its
+        // buffer, or moves its elements when they are kept inline; otherwise they are copied.
+
+        ErrorOr<Vector<T>> toVector() && {
+
+            if (!m_storage || m_storage->ref_count() != 1) {
+
+                return toVector();
+            }
+
+            auto storage = move(m_storage);
+
+            if (auto buffer = storage->releaseBuffer(); buffer.hasValue()) {
+
+                return Vector<T> { buffer.releaseValue() };
+            }
+
+            Vector<T> vector;
+
+            TRY(vector.tryEnsureCapacity(storage->size()));
+
+            for (auto& value : *storage) {
+
+                vector.uncheckedAppend(move(value));
+            }
+
+            return vector;
+        }
+
+        ErrorOr<Vector<T>> toVector() const& {
+
+            Vector<T> vector;
+
+            TRY(vector.tryEnsureCapacity(size()));
+
+            for (auto const& value : *this) {
+
+                vector.uncheckedAppend(value);
+            }
+
+            return vector;
         }
 
         T* unsafeData() {
@@ -392,13 +712,37 @@ namespace NeuInternal {
             return m_storage->unsafeData();
         }
 
+        Span<T> span() { return { unsafeData(), size() }; }
+
+        Span<T const> span() const { return { m_storage ? m_storage->begin() : nullptr, size() }; }
+
+        // Range-for walks the elements in place, without the copies and reference counting of iterator(). Like
+        // any pointer into the array, these are invalidated by anything that grows it.
+
+        T* begin() { return m_storage ? m_storage->begin() : nullptr; }
+        T* end() { return m_storage ? m_storage->end() : nullptr; }
+        T const* begin() const { return m_storage ? m_storage->begin() : nullptr; }
+        T const* end() const { return m_storage ? m_storage->end() : nullptr; }
+
     private:
 
-        ErrorOr<ArrayStorage<T>*> ensureStorage() {
+        // Room for a few elements unless the caller knows how many it will need: a small array that is sized once
+        // up front then never allocates again.
+
+        static constexpr size_t defaultInlineCapacity = 4;
+
+        // A first request for more than this goes straight to a buffer of its own. An inline region that large
+        // would be dead memory for the rest of the array's life as soon as it grew past it.
+
+        static constexpr size_t maxInlineBytes = 256;
+
+        static constexpr size_t maxInlineCapacity = max(defaultInlineCapacity, maxInlineBytes / sizeof(T));
+
+        ErrorOr<ArrayStorage<T>*> ensureStorage(size_t capacity = defaultInlineCapacity) {
 
             if (!m_storage) {
                 
-                m_storage = TRY(adoptNonNullReferenceOrErrorNoMemory(new (nothrow) ArrayStorage<T>));
+                m_storage = TRY(ArrayStorage<T>::create(capacity <= maxInlineCapacity ? capacity : 0));
             }
 
             return m_storage.pointer();
@@ -409,4 +753,11 @@ namespace NeuInternal {
 
 }
 
+template<typename T>
+struct Traits<NeuInternal::Array<T>> : public GenericTraits<NeuInternal::Array<T>> {
+
+    static constexpr bool isTriviallyRelocatable() { return true; }
+};
+
 using NeuInternal::Array;
+using NeuInternal::ArraySlice;
@@ -15,13 +15,13 @@ namespace NeuInternal {
 
 template<typename K, typename V>
 struct DictionaryStorage : public ReferenceCounted<DictionaryStorage<K, V>> {
-    HashMap<K, V> map;
+    SwissHashMap<K, V> map;
 };
 
 template<typename K, typename V>
 class DictionaryIterator {
     using Storage = DictionaryStorage<K, V>;
-    using Iterator = typename HashMap<K, V>::IteratorType;
+    using Iterator = typename SwissHashMap<K, V>::IteratorType;
 
 public:
     DictionaryIterator(NonNullReferencePointer<Storage> storage)
@@ -34,9 +34,9 @@ public:
     {
         if (m_iterator == m_storage->map.end())
             return {};
-        auto res = *m_iterator;
+        Tuple<K, V> entry(m_iterator->key, m_iterator->value);
         ++m_iterator;
-        return Tuple<K, V>(res.key, res.value);
+        return entry;
     }
 
 private:
@@ -49,6 +49,9 @@ class Dictionary {
     using Storage = DictionaryStorage<K, V>;
 
 public:
+    using Iterator = typename SwissHashMap<K, V>::IteratorType;
+    using ConstIterator = typename SwissHashMap<K, V>::ConstIteratorType;
+
     bool isEmpty() const { return m_storage->map.isEmpty(); }
     size_t size() const { return m_storage->map.size(); }
     void clear() { m_storage->map.clear(); }
@@ -66,6 +69,52 @@ public:
     V& operator[](K const& key) { return m_storage->map.get(key).value(); }
     V const& operator[](K const& key) const { return m_storage->map.get(key).value(); }
 
+    // Lookups by any key type that hashes and compares like K (a StringView or char const* for String keys), so
+    // that no K has to be built just to look one up.
+
+    template<Concepts::HashCompatible<K> Key>
+    bool remove(Key const& key) { return m_storage->map.remove(key); }
+
+    template<Concepts::HashCompatible<K> Key>
+    bool contains(Key const& key) const { return m_storage->map.contains(key); }
+
+    template<Concepts::HashCompatible<K> Key>
+    Optional<V> get(Key const& key) const { return get(key, Traits<Key>::hash(key)); }
+
+    template<Concepts::HashCompatible<K> Key>
+    V& operator[](Key const& key)
+    {
+        auto it = m_storage->map.find(key);
+        VERIFY(it != m_storage->map.end());
+        return it->value;
+    }
+
+    template<Concepts::HashCompatible<K> Key>
+    V const& operator[](Key const& key) const
+    {
+        auto it = m_storage->map.find(key);
+        VERIFY(it != m_storage->map.end());
+        return it->value;
+    }
+
+    // The same lookups with the key's hash already known, e.g. computed once by keyHash() and reused across
+    // several dictionaries. `hash` must be what keyHash(key) returns.
+
+    template<Concepts::HashCompatible<K> Key>
+    static UInt64 keyHash(Key const& key) { return Traits<Key>::hash(key); }
+
+    template<Concepts::HashCompatible<K> Key>
+    bool contains(Key const& key, UInt64 hash) const { return findWithHash(key, hash) != m_storage->map.end(); }
+
+    template<Concepts::HashCompatible<K> Key>
+    Optional<V> get(Key const& key, UInt64 hash) const
+    {
+        auto it = findWithHash(key, hash);
+        if (it == m_storage->map.end())
+            return {};
+        return it->value;
+    }
+
     Vector<K> keys() const { return m_storage->map.keys(); }
 
     ErrorOr<void> ensureCapacity(size_t capacity)
@@ -101,15 +150,35 @@ public:
 
     DictionaryIterator<K, V> iterator() const { return DictionaryIterator<K, V> { m_storage }; }
 
+    // Range-for over the entries in place (`for (auto& entry : dictionary)`, then entry.key and entry.value),
+    // without the copies and reference counting of iterator().
+
+    Iterator begin() { return m_storage->map.begin(); }
+    Iterator end() { return m_storage->map.end(); }
+    ConstIterator begin() const { return m_storage->map.begin(); }
+    ConstIterator end() const { return m_storage->map.end(); }
+
 private:
     explicit Dictionary(NonNullReferencePointer<Storage> storage)
         : m_storage(move(storage))
     {
     }
 
+    template<typename Key>
+    auto findWithHash(Key const& key, UInt64 hash) const
+    {
+        return m_storage->map.find(hash, [&](auto& entry) { return Traits<K>::equals(key, entry.key); });
+    }
+
     NonNullReferencePointer<Storage> m_storage;
 };
 
 }
 
+template<typename K, typename V>
+struct Traits<NeuInternal::Dictionary<K, V>> : public GenericTraits<NeuInternal::Dictionary<K, V>> {
+
+    static constexpr bool isTriviallyRelocatable() { return true; }
+};
+
 using NeuInternal::Dictionary;
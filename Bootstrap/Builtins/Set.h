@@ -6,7 +6,9 @@
 
 #pragma once
 
-#include <AK/HashTable.h>
+#include "../Runtime/HashTable.h"
+#include "../Runtime/NonNullReferencePointer.h"
+#include "../Runtime/ReferenceCounted.h"
 #include <initializer_list>
 
 namespace NeuInternal {
@@ -32,9 +34,9 @@ public:
     {
         if (m_iterator == m_storage->table.end())
             return {};
-        auto res = *m_iterator;
+        Optional<T> value = *m_iterator;
         ++m_iterator;
-        return res;
+        return value;
     }
 
 private:
@@ -48,9 +50,32 @@ private:
     using Storage = SetStorage<T>;
 
 public:
+    using Iterator = typename HashTable<T>::Iterator;
+    using ConstIterator = typename HashTable<T>::ConstIterator;
+
     bool remove(T const& value) { return m_storage->table.remove(value); }
     bool contains(T const& value) const { return m_storage->table.contains(value); }
 
+    // Lookups by any type that hashes and compares like T (a StringView or char const* for a Set<String>), so that
+    // no T has to be built just to look one up.
+
+    template<Concepts::HashCompatible<T> Key>
+    bool remove(Key const& value) { return m_storage->table.remove(value); }
+
+    template<Concepts::HashCompatible<T> Key>
+    bool contains(Key const& value) const { return m_storage->table.contains(value); }
+
+    // The same lookup with the value's hash already known; `hash` must be what valueHash(value) returns.
+
+    template<Concepts::HashCompatible<T> Key>
+    static UInt64 valueHash(Key const& value) { return Traits<Key>::hash(value); }
+
+    template<Concepts::HashCompatible<T> Key>
+    bool contains(Key const& value, UInt64 hash) const
+    {
+        return m_storage->table.find(hash, [&](auto& other) { return Traits<T>::equals(value, other); }) != m_storage->table.end();
+    }
+
     ErrorOr<HashSetResult> add(T const& value) { return m_storage->table.set(value); }
     ErrorOr<HashSetResult> add(T&& value) { return m_storage->table.set(move(value)); }
     ErrorOr<void> ensureCapacity(size_t capacity) { return m_storage->table.tryEnsureCapacity(capacity); }
@@ -86,6 +111,13 @@ public:
 
     SetIterator<T> iterator() const { return SetIterator<T> { m_storage }; }
 
+    // Range-for over the values in place, without the copies and reference counting of iterator().
+
+    Iterator begin() { return m_storage->table.begin(); }
+    Iterator end() { return m_storage->table.end(); }
+    ConstIterator begin() const { return m_storage->table.begin(); }
+    ConstIterator end() const { return m_storage->table.end(); }
+
 private:
     explicit Set(NonNullReferencePointer<Storage> storage)
         : m_storage(move(storage))
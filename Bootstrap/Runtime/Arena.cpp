@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Arena.h"
+#include "Checked.h"
+#include "NumericLimits.h"
+#include "SpinLock.h"
+#include "kmalloc.h"
+
+#ifndef KERNEL
+
+constinit thread_local ArenaScope* t_currentArenaScope = nullptr;
+
+Atomic<ArenaGranuleLeaf*> g_arenaGranuleMap[arenaGranuleLeafCount];
+
+// Only taken to add a leaf; the bits themselves are set and cleared atomically, and no two chunks share a granule.
+
+static SpinLock s_arenaGranuleMapLock;
+
+template<typename Callback>
+static void forEachGranule(void* chunk, size_t size, Callback callback) {
+
+    auto first = reinterpret_cast<uintptr_t>(chunk) >> arenaGranuleShift;
+
+    for (auto granule = first; granule < first + size / arenaGranuleSize; ++granule) {
+
+        VERIFY(granule / arenaGranulesPerLeaf < arenaGranuleLeafCount);
+
+        callback(g_arenaGranuleMap[granule / arenaGranulesPerLeaf], granule % arenaGranulesPerLeaf);
+    }
+}
+
+void registerArenaChunk(void* chunk, size_t size) {
+
+    forEachGranule(chunk, size, [](auto& slot, size_t granule) {
+
+        auto* leaf = slot.load(MemoryOrder::memory_order_acquire);
+
+        if (!leaf) {
+
+            SpinLocker locker { s_arenaGranuleMapLock };
+
+            leaf = slot.load(MemoryOrder::memory_order_acquire);
+
+            if (!leaf) {
+
+                // Not through kmalloc(): the leaf outlives every arena and scope.
+
+                leaf = static_cast<ArenaGranuleLeaf*>(calloc(1, sizeof(ArenaGranuleLeaf)));
+
+                VERIFY(leaf);
+
+                slot.store(leaf, MemoryOrder::memory_order_release);
+            }
+        }
+
+        leaf->bits[granule / 64].fetchOr(static_cast<UInt64>(1) << (granule % 64), MemoryOrder::memory_order_relaxed);
+    });
+}
+
+void unregisterArenaChunk(void* chunk, size_t size) {
+
+    forEachGranule(chunk, size, [](auto& slot, size_t granule) {
+
+        auto* leaf = slot.load(MemoryOrder::memory_order_relaxed);
+
+        leaf->bits[granule / 64].fetchAnd(~(static_cast<UInt64>(1) << (granule % 64)), MemoryOrder::memory_order_relaxed);
+    });
+}
+
+#endif
+
+Arena::~Arena() {
+
+    for (size_t i = 0; i < m_chunk_count; ++i) {
+
+        unregisterArenaChunk(m_chunks[i].data, m_chunks[i].size);
+
+        free(m_chunks[i].data);
+    }
+}
+
+void* Arena::allocateInNextChunk(size_t size) {
+
+    // Chunks kept from before a reset come first; one that is too small for this allocation is skipped until the
+    // next reset.
+
+    while (m_current_chunk + 1 < m_chunk_count) {
+
+        ++m_current_chunk;
+
+        m_offset = 0;
+
+        if (size <= m_chunks[m_current_chunk].size) {
+
+            return allocate(size);
+        }
+    }
+
+    if (m_chunk_count == maxChunks) {
+
+        return nullptr;
+    }
+
+    if (size > NumericLimits<size_t>::max() - arenaGranuleSize) {
+
+        return nullptr;
+    }
+
+    // Whole granules, so that the granule map can tell this chunk's memory apart from everything else's.
+
+    auto chunk_size = align_up_to(max(m_next_chunk_size, size), arenaGranuleSize);
+
+    Checked<size_t> next_chunk_size = chunk_size;
+
+    next_chunk_size *= 2;
+
+    // Chunks come from the C heap itself: going through kmalloc() would allocate them from whatever arena is bound.
+
+    auto* data = static_cast<UInt8*>(aligned_alloc(arenaGranuleSize, chunk_size));
+
+    if (!data) {
+
+        return nullptr;
+    }
+
+    registerArenaChunk(data, chunk_size);
+
+    m_chunks[m_chunk_count++] = { data, chunk_size };
+
+    m_next_chunk_size = next_chunk_size.hasOverflow() ? chunk_size : next_chunk_size.value();
+
+    m_current_chunk = m_chunk_count - 1;
+
+    m_offset = 0;
+
+    return allocate(size);
+}
+
+void* Arena::reallocate(void* pointer, size_t size) {
+
+    if (!pointer) {
+
+        return allocate(size);
+    }
+
+    if (pointer == m_last_allocation && m_current_chunk < m_chunk_count) {
+
+        auto& current_chunk = m_chunks[m_current_chunk];
+
+        auto offset = static_cast<size_t>(static_cast<UInt8*>(pointer) - current_chunk.data);
+
+        if (size <= current_chunk.size - offset) {
+
+            m_offset = min(offset + align_up_to(size, alignment), current_chunk.size);
+
+            return pointer;
+        }
+    }
+
+    // The old size isn't recorded anywhere, but it can't reach past the end of the used part of its chunk.
+
+    size_t old_size_bound = 0;
+
+    for (size_t i = 0; i < m_chunk_count; ++i) {
+
+        auto& chunk = m_chunks[i];
+
+        if (chunk.contains(pointer)) {
+
+            auto end = i == m_current_chunk ? chunk.data + m_offset : chunk.data + chunk.size;
+
+            old_size_bound = static_cast<size_t>(end - static_cast<UInt8*>(pointer));
+
+            break;
+        }
+    }
+
+    auto* new_pointer = allocate(size);
+
+    if (new_pointer) {
+
+        __builtin_memmove(new_pointer, pointer, min(size, old_size_bound));
+    }
+
+    return new_pointer;
+}
+
+size_t Arena::bytesUsed() const {
+
+    size_t used = m_offset;
+
+    for (size_t i = 0; i < m_current_chunk && i < m_chunk_count; ++i) {
+
+        used += m_chunks[i].size;
+    }
+
+    return used;
+}
+
+size_t Arena::bytesReserved() const {
+
+    size_t reserved = 0;
+
+    for (size_t i = 0; i < m_chunk_count; ++i) {
+
+        reserved += m_chunks[i].size;
+    }
+
+    return reserved;
+}
+
+#ifndef KERNEL
+
+ArenaScope::ArenaScope(Arena* arena)
+    : m_arena(arena),
+      m_previous(t_currentArenaScope) {
+
+    if (m_arena) {
+
+        m_mark = m_arena->mark();
+    }
+
+    t_currentArenaScope = this;
+}
+
+ArenaScope::~ArenaScope() {
+
+    VERIFY(t_currentArenaScope == this);
+
+    t_currentArenaScope = m_previous;
+
+    if (m_arena) {
+
+        m_arena->resetTo(m_mark);
+    }
+}
+
+ArenaScope* ArenaScope::current() { return t_currentArenaScope; }
+
+void* kmallocInArenaScope(size_t size) {
+
+    if (auto* arena = t_currentArenaScope->arena()) {
+
+        return arena->allocate(size);
+    }
+
+    return kmallocOnHeap(size);
+}
+
+void* kcallocInArenaScope(size_t count, size_t size) {
+
+    auto* arena = t_currentArenaScope->arena();
+
+    if (!arena) {
+
+        return kcallocOnHeap(count, size);
+    }
+
+    Checked<size_t> total = count;
+
+    total *= size;
+
+    if (total.hasOverflow()) {
+
+        return nullptr;
+    }
+
+    auto* pointer = arena->allocate(total.value());
+
+    if (pointer) {
+
+        __builtin_memset(pointer, 0, total.value());
+    }
+
+    return pointer;
+}
+
+// A bound on the size of the arena allocation at `pointer` that doesn't need its arena: it can't reach past the run
+// of arena granules it starts in. There is no need to look further than `size`.
+
+static size_t arenaBytesFrom(void* pointer, size_t size) {
+
+    auto address = reinterpret_cast<uintptr_t>(pointer);
+
+    auto end = align_up_to(address + 1, arenaGranuleSize);
+
+    while (end - address < size && isArenaMemory(reinterpret_cast<void*>(end))) {
+
+        end += arenaGranuleSize;
+    }
+
+    return end - address;
+}
+
+void* kreallocInArenaScope(void* pointer, size_t size) {
+
+    if (!pointer) {
+
+        return kmallocInArenaScope(size);
+    }
+
+    for (auto* scope = t_currentArenaScope; scope; scope = scope->previous()) {
+
+        if (auto* arena = scope->arena(); arena && arena->contains(pointer)) {
+
+            return arena->reallocate(pointer, size);
+        }
+    }
+
+    if (isArenaMemory(pointer)) {
+
+        return kreallocOutOfArena(pointer, size);
+    }
+
+    // Heap memory stays on the heap.
+
+    return kreallocOnHeap(pointer, size);
+}
+
+void* kreallocOutOfArena(void* pointer, size_t size) {
+
+    // The arena may belong to another thread, so it isn't touched: the allocation is copied out, and what it leaves
+    // behind is reclaimed whenever its arena resets.
+
+    auto* new_pointer = t_currentArenaScope ? kmallocInArenaScope(size) : kmallocOnHeap(size);
+
+    if (new_pointer) {
+
+        __builtin_memcpy(new_pointer, pointer, min(size, arenaBytesFrom(pointer, size)));
+    }
+
+    return new_pointer;
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Assertions.h"
+#include "Noncopyable.h"
+#include "Platform.h"
+#include "StdLibExtras.h"
+#include "Types.h"
+
+// A bump allocator: allocating is a pointer increment, freeing a single allocation does nothing, and everything
+// allocated after a mark() is released at once, in O(1), by resetTo() that mark. Memory comes in chunks that
+// double in size (in whole 64 KiB granules), and stays with the arena across resets to be reused; only destroying
+// the arena returns it.
+//
+// Containers don't take an allocator parameter. Instead an ArenaScope binds an arena to the current thread, and
+// while it is alive kmalloc() and friends (and so StringImpl, Vector, HashTable, Array storage...) allocate from
+// that arena. An Arena is not thread-safe.
+
+class Arena {
+
+    MAKE_NONCOPYABLE(Arena);
+    MAKE_NONMOVABLE(Arena);
+
+public:
+
+    static constexpr size_t defaultFirstChunkSize = 64 * KiB;
+
+    static constexpr size_t alignment = 16;
+
+    explicit Arena(size_t firstChunkSize = defaultFirstChunkSize)
+        : m_next_chunk_size(firstChunkSize) {
+
+        VERIFY(firstChunkSize > 0);
+    }
+
+    ~Arena();
+
+    // Returns null if no memory could be had. All allocations are aligned to Arena::alignment.
+
+    [[nodiscard]] ALWAYS_INLINE void* allocate(size_t size) {
+
+        if (m_current_chunk < m_chunk_count) {
+
+            auto& chunk = m_chunks[m_current_chunk];
+
+            if (size <= chunk.size - m_offset) {
+
+                auto* pointer = chunk.data + m_offset;
+
+                m_offset += align_up_to(size, alignment);
+
+                if (m_offset > chunk.size) {
+
+                    m_offset = chunk.size;
+                }
+
+                m_last_allocation = pointer;
+
+                return pointer;
+            }
+        }
+
+        return allocateInNextChunk(size);
+    }
+
+    // Like krealloc(): the contents are kept up to the smaller of the two sizes. Grows in place when `pointer` was
+    // the last allocation and its chunk has room.
+
+    [[nodiscard]] void* reallocate(void* pointer, size_t size);
+
+    [[nodiscard]] bool contains(void const* pointer) const {
+
+        for (size_t i = 0; i < m_chunk_count; ++i) {
+
+            if (m_chunks[i].contains(pointer)) {
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    struct Mark {
+
+        size_t chunk;
+
+        size_t offset;
+    };
+
+    [[nodiscard]] Mark mark() const { return { m_current_chunk, m_offset }; }
+
+    // Releases everything allocated since `mark` was taken.
+
+    void resetTo(Mark mark) {
+
+        VERIFY(mark.chunk < m_current_chunk || (mark.chunk == m_current_chunk && mark.offset <= m_offset));
+
+        m_current_chunk = mark.chunk;
+
+        m_offset = mark.offset;
+
+        m_last_allocation = nullptr;
+    }
+
+    void reset() { resetTo({ 0, 0 }); }
+
+    // Bytes handed out since the last reset, including alignment padding.
+
+    [[nodiscard]] size_t bytesUsed() const;
+
+    // Bytes held in chunks, whether in use or not.
+
+    [[nodiscard]] size_t bytesReserved() const;
+
+private:
+
+    struct Chunk {
+
+        UInt8* data;
+
+        size_t size;
+
+        bool contains(void const* pointer) const {
+
+            auto address = reinterpret_cast<uintptr_t>(pointer);
+
+            auto start = reinterpret_cast<uintptr_t>(data);
+
+            return address >= start && address - start < size;
+        }
+    };
+
+    // Doubling chunk sizes make this many chunks more than any address space can hold.
+
+    static constexpr size_t maxChunks = 64;
+
+    void* allocateInNextChunk(size_t size);
+
+    Chunk m_chunks[maxChunks];
+
+    size_t m_chunk_count { 0 };
+
+    size_t m_current_chunk { 0 };
+
+    size_t m_offset { 0 };
+
+    size_t m_next_chunk_size;
+
+    void* m_last_allocation { nullptr };
+};
+
+// Binds an arena to the current thread for as long as it is alive. On destruction, everything allocated in the
+// arena since then is released and the previous binding comes back. Whatever the scope allocated must be destroyed
+// before the scope ends or never touched again, since its memory gets handed out anew. Releasing the memory itself
+// is safe anywhere, though: kfree_sized() recognizes arena memory by its address and does nothing with it, on any
+// thread and after the scope is over, and krealloc() outside of the scope copies it out. Scopes nest. A scope over
+// no arena at all (nullptr) allocates from the heap again, for data that must outlive the scopes around it. Growing
+// a container inside a nested scope over the same arena moves it into memory the nested scope will release, so
+// containers that outlive a scope should not grow inside it.
+
+class ArenaScope {
+
+    MAKE_NONCOPYABLE(ArenaScope);
+    MAKE_NONMOVABLE(ArenaScope);
+
+public:
+
+    explicit ArenaScope(Arena* arena);
+
+    explicit ArenaScope(Arena& arena)
+        : ArenaScope(&arena) { }
+
+    ~ArenaScope();
+
+    // Null for a scope that allocates from the heap.
+
+    Arena* arena() { return m_arena; }
+
+    ArenaScope* previous() { return m_previous; }
+
+    static ArenaScope* current();
+
+private:
+
+    Arena* m_arena;
+
+    Arena::Mark m_mark { 0, 0 };
+
+    ArenaScope* m_previous;
+};
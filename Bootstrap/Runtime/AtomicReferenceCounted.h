@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Assertions.h"
+#include "Atomic.h"
+#include "Debug.h"
+#include "Noncopyable.h"
+#include "NumericLimits.h"
+#include "Platform.h"
+#include "StdLibExtras.h"
+
+// A drop-in replacement for ReferenceCounted<T> whose count may be changed from several threads at once, for
+// objects that are immutable (or otherwise synchronized) once shared. A type opts in by deriving from
+// AtomicReferenceCounted<T> instead of ReferenceCounted<T>; ReferencePointer and NonNullReferencePointer work
+// with either.
+
+class AtomicReferenceCountedBase {
+
+    MAKE_NONCOPYABLE(AtomicReferenceCountedBase);
+    MAKE_NONMOVABLE(AtomicReferenceCountedBase);
+
+public:
+
+    using RefCountType = unsigned int;
+
+    // Taking another reference only needs atomicity: whoever hands the object over already holds a reference,
+    // so no ordering is required here.
+
+    ALWAYS_INLINE void ref() const {
+
+        [[maybe_unused]] auto old_ref_count = m_refCount.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+
+        if constexpr (REFERENCE_COUNT_DEBUG) {
+
+            VERIFY(old_ref_count > 0);
+
+            VERIFY(old_ref_count < NumericLimits<RefCountType>::max());
+        }
+    }
+
+    [[nodiscard]] bool try_ref() const {
+
+        auto expected = m_refCount.load(MemoryOrder::memory_order_relaxed);
+
+        for (;;) {
+
+            if (expected == 0) {
+
+                return false;
+            }
+
+            VERIFY(expected < NumericLimits<RefCountType>::max());
+
+            if (m_refCount.compareExchangeStrong(expected, expected + 1, MemoryOrder::memory_order_acquire)) {
+
+                return true;
+            }
+        }
+    }
+
+    [[nodiscard]] RefCountType ref_count() const { return m_refCount.load(MemoryOrder::memory_order_relaxed); }
+
+protected:
+
+    AtomicReferenceCountedBase() = default;
+
+    ~AtomicReferenceCountedBase() {
+
+        if constexpr (REFERENCE_COUNT_DEBUG) {
+
+            VERIFY(!m_refCount.load(MemoryOrder::memory_order_relaxed));
+        }
+    }
+
+    // Release publishes this thread's writes to whichever thread drops the last reference; acquire makes that
+    // thread see all of them before it destroys the object.
+
+    ALWAYS_INLINE RefCountType deref_base(RefCountType count = 1) const {
+
+        auto old_ref_count = m_refCount.fetchSub(count, MemoryOrder::memory_order_acq_rel);
+
+        if constexpr (REFERENCE_COUNT_DEBUG) {
+
+            VERIFY(old_ref_count >= count);
+        }
+
+        return old_ref_count - count;
+    }
+
+    Atomic<RefCountType> mutable m_refCount { 1 };
+};
+
+template<typename T>
+class AtomicReferenceCounted : public AtomicReferenceCountedBase {
+
+public:
+
+    bool dereference(RefCountType count = 1) const {
+
+        auto* that = const_cast<T*>(static_cast<T const*>(this));
+
+        auto new_ref_count = deref_base(count);
+
+        if (new_ref_count == 0) {
+
+            if constexpr (requires { that->will_be_destroyed(); }) {
+
+                that->will_be_destroyed();
+            }
+
+            delete static_cast<const T*>(this);
+
+            return true;
+        }
+
+        return false;
+    }
+};
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Assertions.h"
+#include "NonNullReferencePointer.h"
+#include "Platform.h"
+#include "ReferencePointer.h"
+
+// A non-null reference to a reference counted object that does not own it: making, copying and destroying one
+// never touches the count. Whoever creates it must keep a real reference alive for as long as the borrow is used;
+// call ownedReference() to turn it back into one.
+
+template<typename T>
+class BorrowedReference {
+
+public:
+
+    using ElementType = T;
+
+    ALWAYS_INLINE BorrowedReference(T& object)
+        : m_pointer(&object) { }
+
+    ALWAYS_INLINE BorrowedReference(NonNullReferencePointer<T> const& owner)
+        : m_pointer(const_cast<T*>(owner.pointer())) { }
+
+    template<typename U>
+    ALWAYS_INLINE BorrowedReference(NonNullReferencePointer<U> const& owner) requires(IsConvertible<U*, T*>)
+        : m_pointer(const_cast<T*>(static_cast<T const*>(owner.pointer()))) { }
+
+    ALWAYS_INLINE BorrowedReference(ReferencePointer<T> const& owner)
+        : m_pointer(const_cast<T*>(owner.pointer())) {
+
+        VERIFY(m_pointer);
+    }
+
+    template<typename U>
+    ALWAYS_INLINE BorrowedReference(BorrowedReference<U> other) requires(IsConvertible<U*, T*>)
+        : m_pointer(other.pointer()) { }
+
+    // A temporary owner would be gone before the borrow is used.
+
+    BorrowedReference(NonNullReferencePointer<T>&&) = delete;
+    BorrowedReference(ReferencePointer<T>&&) = delete;
+
+    ALWAYS_INLINE RETURNS_NONNULL T* pointer() const { return m_pointer; }
+
+    ALWAYS_INLINE RETURNS_NONNULL T* operator->() const { return m_pointer; }
+
+    ALWAYS_INLINE T& operator*() const { return *m_pointer; }
+
+    ALWAYS_INLINE operator T&() const { return *m_pointer; }
+
+    [[nodiscard]] NonNullReferencePointer<T> ownedReference() const { return NonNullReferencePointer<T>(*m_pointer); }
+
+    bool operator==(BorrowedReference const& other) const { return m_pointer == other.m_pointer; }
+
+private:
+
+    T* m_pointer;
+};
+
+template<typename T>
+struct Traits<BorrowedReference<T>> : public GenericTraits<BorrowedReference<T>> {
+
+    using PeekType = T*;
+    using ConstPeekType = const T*;
+    static unsigned hash(BorrowedReference<T> const& p) { return pointerHash(p.pointer()); }
+    static bool equals(BorrowedReference<T> const& a, BorrowedReference<T> const& b) { return a.pointer() == b.pointer(); }
+};
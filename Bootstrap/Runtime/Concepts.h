@@ -46,7 +46,7 @@ namespace Concepts {
     concept SpecializationOf = IsSpecializationOf<T, S>;
 
     template<typename T>
-    concept AnyString = Detail::IsConstructible<StringView, T>;
+    concept AnyString = Detail::IsConstructible<StringView, Detail::Decay<T> const&>;
 
     template<typename T, typename U>
     concept HashCompatible = IsHashCompatible<Detail::Decay<T>, Detail::Decay<U>>;
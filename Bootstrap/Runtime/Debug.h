@@ -350,6 +350,16 @@
 #define REACHABLE_DEBUG 0
 #endif
 
+// Reference count verification runs on every copy of a ReferencePointer, so it follows assertions by default and
+// can be turned off on its own.
+#ifndef REFERENCE_COUNT_DEBUG
+#    ifdef NDEBUG
+#        define REFERENCE_COUNT_DEBUG 0
+#    else
+#        define REFERENCE_COUNT_DEBUG 1
+#    endif
+#endif
+
 #ifndef REGEX_DEBUG
 #define REGEX_DEBUG 0
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Forward.h"
+#include "Noncopyable.h"
+#include "NonNullReferencePointer.h"
+#include "NumericLimits.h"
+#include "Platform.h"
+#include "ReferencePointer.h"
+#include "Types.h"
+
+// Collects references that a loop is done with and drops them later, all at once: when the buffer fills up, on
+// flush() and on destruction. Releasing the same object several times in a row costs a single dereference, so a
+// loop that keeps handing temporary copies of one pointer in here pays for one decrement per batch instead of one
+// per iteration. Opt-in; objects handed over stay alive until the buffer is flushed.
+
+template<typename T, size_t Capacity>
+class DeferredDereferenceBuffer {
+
+    MAKE_NONCOPYABLE(DeferredDereferenceBuffer);
+    MAKE_NONMOVABLE(DeferredDereferenceBuffer);
+
+    static_assert(Capacity > 0);
+
+public:
+
+    DeferredDereferenceBuffer() = default;
+
+    ~DeferredDereferenceBuffer() { flush(); }
+
+    void defer(NonNullReferencePointer<T>&& pointer) {
+
+        deferReference(&pointer.leak_ref());
+    }
+
+    void defer(ReferencePointer<T>&& pointer) {
+
+        if (auto* object = pointer.leak_ref()) {
+
+            deferReference(object);
+        }
+    }
+
+    void flush() {
+
+        // Take the entries out first: a destructor that runs from here may defer into this buffer again.
+
+        while (m_size > 0) {
+
+            auto entry = m_entries[--m_size];
+
+            entry.object->dereference(entry.count);
+        }
+    }
+
+    size_t pendingObjects() const { return m_size; }
+
+private:
+
+    using RefCountType = typename T::RefCountType;
+
+    struct Entry {
+
+        T* object;
+        RefCountType count;
+    };
+
+    ALWAYS_INLINE void deferReference(T* object) {
+
+        if (m_size > 0 && m_entries[m_size - 1].object == object && m_entries[m_size - 1].count < NumericLimits<RefCountType>::max()) {
+
+            ++m_entries[m_size - 1].count;
+
+            return;
+        }
+
+        if (m_size == Capacity) {
+
+            flush();
+        }
+
+        m_entries[m_size++] = { object, 1 };
+    }
+
+    Entry m_entries[Capacity];
+    size_t m_size { 0 };
+};
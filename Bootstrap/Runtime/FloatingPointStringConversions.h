@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Error.h"
+#include "Forward.h"
+#include "Types.h"
+
+#ifndef KERNEL
+
+// value == significand * 10^exponent
+struct FloatingPointDecimal {
+
+    UInt64 significand { 0 };
+    Int32 exponent { 0 };
+};
+
+// The decimal with the fewest significant digits that reads back as exactly `value`, picking the one closest
+// to `value` when several qualify (Schubfach). `value` must be finite and greater than zero.
+FloatingPointDecimal convertToShortestDecimal(double value);
+FloatingPointDecimal convertToShortestDecimal(float value);
+
+static constexpr size_t maxShortestDecimalLength = 32;
+
+// Lays `decimal` out like ECMAScript's Number::toString: plain notation for 1e-7 <= value < 1e21, otherwise
+// scientific notation ("1.5e+300"). Writes at most maxShortestDecimalLength characters and returns the count.
+size_t writeShortestDecimal(FloatingPointDecimal decimal, char* buffer);
+
+// Appends the exact value of a finite, non-negative `value`, rounded half-to-even to `precision` digits after
+// the radix point. Nothing but the digits and the radix point is written.
+ErrorOr<void> appendFixedPointDigits(Vector<char, 128>& output, double value, size_t precision, UInt8 base = 10, bool upperCase = false);
+ErrorOr<void> appendFixedPointDigits(Vector<char, 128>& output, long double value, size_t precision, UInt8 base = 10, bool upperCase = false);
+
+// Appends a finite, non-negative `value` with max_digits10 significant digits, trailing zeros dropped, which
+// always reads back unchanged. There are no shortest-form tables for long double.
+ErrorOr<void> appendRoundTripDigits(Vector<char, 128>& output, long double value);
+
+enum class FloatingPointError {
+
+    None,
+    NoOrInvalidInput,
+    OutOfRange,
+    RoundedDownToZero,
+};
+
+template<typename T>
+struct FloatingPointParseResults {
+
+    char const* endPointer { nullptr };
+    FloatingPointError error { FloatingPointError::None };
+    T value { };
+
+    bool parsedValue() const { return error != FloatingPointError::NoOrInvalidInput; }
+};
+
+// Parses the longest prefix of [start, end) that is a decimal floating-point literal ([+-]digits[.digits][e[+-]digits])
+// or inf, infinity or nan, rounded to nearest with ties to even. Unlike strtod this ignores the locale, needs no NUL
+// terminator and never allocates. Values past the largest finite one come back as infinity with OutOfRange.
+template<typename T>
+FloatingPointParseResults<T> parseFirstFloatingPoint(char const* start, char const* end);
+
+#endif
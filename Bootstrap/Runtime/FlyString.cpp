@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Arena.h"
+#include "FlyString.h"
+#include "HashTable.h"
+#include "SpinLock.h"
+#include "String.h"
+#include "StringView.h"
+#include "kmalloc.h"
+
+struct FlyStringImplTraits : public GenericTraits<StringImpl const*> {
+
+    static unsigned hash(StringImpl const* impl) { return impl->hash(); }
+
+    static bool equals(StringImpl const* a, StringImpl const* b) { return *a == *b; }
+};
+
+// Never destroyed: FlyStrings in static storage may still be dropped after it would have been.
+
+static HashTable<StringImpl const*, FlyStringImplTraits>& flyImpls() {
+
+    static auto* table = new HashTable<StringImpl const*, FlyStringImplTraits>;
+
+    return *table;
+}
+
+// Every access to the table happens under this lock. The critical sections are a probe and at most one insertion
+// or removal, so a spin lock is enough.
+
+static SpinLock s_flyImplsLock;
+
+// Returns the interned StringImpl for `view`. If there is none yet, `candidate` (which must have the same
+// characters) becomes it when given, otherwise a new one is made.
+
+NonNullReferencePointer<StringImpl> FlyString::internImpl(StringView view, StringImpl const* candidate) {
+
+    auto hash = view.hash();
+
+    // Interned strings can be picked up by any thread, so they (and the table) never live in an arena. Where the
+    // candidate lives is what counts: it may come from another thread's scope, or from one that has ended.
+
+    auto can_adopt_candidate = candidate && !isArenaMemory(candidate);
+
+    ArenaScope heap_scope { nullptr };
+
+    SpinLocker locker { s_flyImplsLock };
+
+    auto& table = flyImpls();
+
+    auto it = table.find(hash, [&](StringImpl const* impl) { return impl->view() == view; });
+
+    if (it != table.end()) {
+
+        // The last reference may just have gone away on another thread, which will look for the entry once we
+        // let go of the lock. Replace it; didDestroyImpl() leaves entries for other StringImpls alone.
+
+        if ((*it)->try_ref()) {
+
+            return adoptReference(const_cast<StringImpl&>(**it));
+        }
+
+        table.remove(it);
+    }
+
+    NonNullReferencePointer<StringImpl> impl = can_adopt_candidate
+        ? NonNullReferencePointer<StringImpl>(const_cast<StringImpl&>(*candidate))
+        : StringImpl::create(view.charactersWithoutNullTermination(), view.length()).releaseNonNull();
+
+    VERIFY(impl->hash() == hash);
+
+    impl->setFly(true);
+
+    table.set(impl.pointer());
+
+    return impl;
+}
+
+FlyString::FlyString(String const& string) {
+
+    if (string.isNull()) {
+
+        return;
+    }
+
+    if (auto const* impl = string.impl(); impl && impl->isFly()) {
+
+        m_impl = const_cast<StringImpl*>(impl);
+
+        return;
+    }
+
+    if (string.isEmpty()) {
+
+        m_impl = StringImpl::theEmptyStringImpl();
+
+        return;
+    }
+
+    m_impl = internImpl(string.view(), string.impl());
+}
+
+FlyString::FlyString(StringView view) {
+
+    if (view.isNull()) {
+
+        return;
+    }
+
+    if (view.isEmpty()) {
+
+        m_impl = StringImpl::theEmptyStringImpl();
+
+        return;
+    }
+
+    m_impl = internImpl(view, nullptr);
+}
+
+size_t FlyString::internedCount() {
+
+    SpinLocker locker { s_flyImplsLock };
+
+    return flyImpls().size();
+}
+
+void FlyString::didDestroyImpl(StringImpl const& impl) {
+
+    ArenaScope heap_scope { nullptr };
+
+    SpinLocker locker { s_flyImplsLock };
+
+    auto& table = flyImpls();
+
+    auto it = table.find(impl.existing_hash(), [&](StringImpl const* other) { return other == &impl; });
+
+    if (it != table.end()) {
+
+        table.remove(it);
+    }
+}
+
+FlyString String::intern() const { return FlyString(*this); }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Format.h"
+#include "Forward.h"
+#include "ReferencePointer.h"
+#include "String.h"
+#include "StringImpl.h"
+#include "StringView.h"
+#include "Traits.h"
+
+// An interned string: every FlyString with the same characters shares one StringImpl, looked up in a global
+// table when the FlyString is made. Comparing two FlyStrings is a pointer compare and their hash was computed
+// when the characters were first interned. The table does not keep its strings alive; an entry goes away with
+// the last FlyString (or String) that references it. FlyStrings may be made and dropped on any thread.
+
+class FlyString {
+
+public:
+
+    FlyString() = default;
+
+    FlyString(FlyString const& other)
+        : m_impl(other.m_impl) { }
+
+    FlyString(FlyString&& other)
+        : m_impl(move(other.m_impl)) { }
+
+    FlyString(String const&);
+
+    FlyString(StringView);
+
+    FlyString(char const* string)
+        : FlyString(StringView(string)) { }
+
+    FlyString& operator=(FlyString const& other) {
+
+        m_impl = other.m_impl;
+
+        return *this;
+    }
+
+    FlyString& operator=(FlyString&& other) {
+
+        m_impl = move(other.m_impl);
+
+        return *this;
+    }
+
+    [[nodiscard]] bool isNull() const { return !m_impl; }
+    [[nodiscard]] bool isEmpty() const { return !m_impl || !m_impl->length(); }
+    [[nodiscard]] size_t length() const { return m_impl ? m_impl->length() : 0; }
+
+    // Includes NUL-terminator, if non-nullptr.
+
+    [[nodiscard]] char const* characters() const { return m_impl ? m_impl->characters() : nullptr; }
+
+    [[nodiscard]] StringView view() const { return { characters(), length() }; }
+
+    [[nodiscard]] StringImpl const* impl() const { return m_impl.pointer(); }
+
+    [[nodiscard]] UInt32 hash() const { return m_impl ? m_impl->existing_hash() : 0; }
+
+    bool operator==(FlyString const& other) const { return m_impl == other.m_impl; }
+    bool operator!=(FlyString const& other) const { return m_impl != other.m_impl; }
+
+    bool operator==(String const& other) const { return view() == other.view(); }
+    bool operator!=(String const& other) const { return !(*this == other); }
+
+    bool operator==(StringView other) const { return view() == other; }
+    bool operator!=(StringView other) const { return !(*this == other); }
+
+    bool operator==(char const* other) const { return view() == other; }
+    bool operator!=(char const* other) const { return !(*this == other); }
+
+    // Number of distinct strings currently interned.
+
+    static size_t internedCount();
+
+private:
+
+    friend class StringImpl;
+
+    static NonNullReferencePointer<StringImpl> internImpl(StringView, StringImpl const* candidate);
+
+    static void didDestroyImpl(StringImpl const&);
+
+    ReferencePointer<StringImpl> m_impl;
+};
+
+template<>
+struct Traits<FlyString> : public GenericTraits<FlyString> {
+
+    static unsigned hash(FlyString const& s) { return s.hash(); }
+
+    static constexpr bool isTriviallyRelocatable() { return true; }
+};
+
+template<>
+struct Formatter<FlyString> : Formatter<StringView> {
+
+    ErrorOr<void> format(FormatBuilder& builder, FlyString const& value) {
+
+        return Formatter<StringView>::format(builder, value.view());
+    }
+};
@@ -5,9 +5,11 @@
  */
 
 #include "CharacterTypes.h"
+#include "FloatingPointStringConversions.h"
 #include "Format.h"
 #include "GenericLexer.h"
 #include "StringBuilder.h"
+#include "Vector.h"
 #include "kstdio.h"
 
 #if defined(__serenity__) && !defined(KERNEL)
@@ -43,44 +45,163 @@ namespace {
 
     static constexpr size_t use_next_index = NumericLimits<size_t>::max();
 
-    // The worst case is that we have the largest 64-bit value formatted as binary number, this would take
-    // 65 bytes. Choosing a larger power of two won't hurt and is a bit of mitigation against out-of-bounds accesses.
-    static constexpr size_t convertUnsignedToString(UInt64 value, LinearArray<UInt8, 128>& buffer, UInt8 base, bool upperCase) {
+    static constexpr size_t countDigits(UInt64 value, UInt8 base) {
 
         VERIFY(base >= 2 && base <= 16);
 
+        if (base == 10) {
+
+            size_t digits = 1;
+
+            while (value >= 10000) {
+
+                value /= 10000;
+
+                digits += 4;
+            }
+
+            if (value >= 1000) {
+
+                return digits + 3;
+            }
+
+            if (value >= 100) {
+
+                return digits + 2;
+            }
+
+            if (value >= 10) {
+
+                return digits + 1;
+            }
+
+            return digits;
+        }
+
+        if (is_power_of_two(base)) {
+
+            size_t const bits_per_digit = __builtin_ctz(base);
+            size_t const bits = 64 - __builtin_clzll(value | 1);
+
+            return (bits + bits_per_digit - 1) / bits_per_digit;
+        }
+
+        size_t digits = 1;
+
+        while (value >= base) {
+
+            value /= base;
+
+            ++digits;
+        }
+
+        return digits;
+    }
+
+    // Writes exactly `digits` digits of `value` into `buffer`, back to front.
+    static void writeDigits(UInt64 value, UInt8 base, bool upperCase, char* buffer, size_t digits) {
+
         constexpr char const* lowercase_lookup = "0123456789abcdef";
         constexpr char const* uppercase_lookup = "0123456789ABCDEF";
 
-        if (value == 0) {
+        constexpr char const* decimal_pairs =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
 
-            buffer[0] = '0';
-            
-            return 1;
-        }
+        auto const* lookup = upperCase ? uppercase_lookup : lowercase_lookup;
 
-        size_t used = 0;
-        
-        while (value > 0) {
+        char* out = buffer + digits;
+
+        if (base == 10) {
+
+            while (value >= 100) {
+
+                auto const pair = (value % 100) * 2;
 
-            if (upperCase) {
+                value /= 100;
 
-                buffer[used++] = uppercase_lookup[value % base];
+                *--out = decimal_pairs[pair + 1];
+                *--out = decimal_pairs[pair];
+            }
+
+            if (value >= 10) {
+
+                *--out = decimal_pairs[value * 2 + 1];
+                *--out = decimal_pairs[value * 2];
             }
             else {
 
-                buffer[used++] = lowercase_lookup[value % base];
+                *--out = lookup[value];
             }
+        }
+        else if (is_power_of_two(base)) {
 
-            value /= base;
+            size_t const shift = __builtin_ctz(base);
+            UInt64 const mask = base - 1;
+
+            while (out != buffer) {
+
+                *--out = lookup[value & mask];
+
+                value >>= shift;
+            }
         }
+        else {
 
-        for (size_t i = 0; i < used / 2; ++i) {
+            while (out != buffer) {
 
-            swap(buffer[i], buffer[used - i - 1]);
+                *--out = lookup[value % base];
+
+                value /= base;
+            }
         }
 
-        return used;
+        VERIFY(out == buffer);
+    }
+
+    // Finds the next '{' or '}' a machine word at a time, since literal runs
+    // between replacement fields are usually much longer than a few bytes.
+    static size_t findNextBrace(char const* characters, size_t length) {
+
+        constexpr FlatPointer ones = explode_byte(0x01);
+        constexpr FlatPointer highs = explode_byte(0x80);
+        constexpr FlatPointer open_braces = explode_byte('{');
+        constexpr FlatPointer close_braces = explode_byte('}');
+
+        size_t i = 0;
+
+        for (; i + sizeof(FlatPointer) <= length; i += sizeof(FlatPointer)) {
+
+            FlatPointer word;
+
+            __builtin_memcpy(&word, characters + i, sizeof(word));
+
+            auto const open = word ^ open_braces;
+            auto const close = word ^ close_braces;
+
+            if ((((open - ones) & ~open) | ((close - ones) & ~close)) & highs) {
+
+                break;
+            }
+        }
+
+        for (; i < length; ++i) {
+
+            if (characters[i] == '{' || characters[i] == '}') {
+
+                return i;
+            }
+        }
+
+        return length;
     }
 
     ErrorOr<void> vformat_impl(TypeErasedFormatParams& params, FormatBuilder& builder, FormatParser& parser) {
@@ -124,6 +245,8 @@ StringView FormatParser::consumeLiteral() {
 
     while (!isEof()) {
 
+        ignore(findNextBrace(m_input.charactersWithoutNullTermination() + tell(), tell_remaining()));
+
         if (consumeSpecific("{{")) {
 
             continue;
@@ -138,8 +261,6 @@ StringView FormatParser::consumeLiteral() {
 
             return m_input.substringView(begin, tell() - begin);
         }
-
-        consume();
     }
 
     return m_input.substringView(begin);
@@ -223,20 +344,29 @@ bool FormatParser::consumeReplacementField(size_t& index)
 
 ErrorOr<void> FormatBuilder::putPadding(char fill, size_t amount)
 {
-    for (size_t i = 0; i < amount; ++i)
-        TRY(m_builder.tryAppend(fill));
+    TRY(m_builder.tryAppendRepeated(fill, amount));
     return {};
 }
 
 ErrorOr<void> FormatBuilder::putLiteral(StringView value) {
 
-    for (size_t i = 0; i < value.length(); ++i) {
+    size_t i = 0;
 
-        TRY(m_builder.tryAppend(value[i]));
-        
-        if (value[i] == '{' || value[i] == '}') {
+    while (i < value.length()) {
+
+        auto const run = findNextBrace(value.charactersWithoutNullTermination() + i, value.length() - i);
+
+        TRY(m_builder.tryAppend(value.substringView(i, run)));
+
+        i += run;
 
-            ++i;
+        // An escaped brace ("{{" or "}}") is emitted once.
+
+        if (i < value.length()) {
+
+            TRY(m_builder.tryAppend(value[i]));
+
+            i += 2;
         }
     }
 
@@ -299,9 +429,7 @@ ErrorOr<void> FormatBuilder::putU64(
         align = Align::Right;
     }
 
-    LinearArray<UInt8, 128> buffer;
-
-    auto const used_by_digits = convertUnsignedToString(value, buffer, base, upperCase);
+    auto const used_by_digits = countDigits(value, base);
 
     size_t used_by_prefix = 0;
     if (align == Align::Right && zero_pad) {
@@ -352,8 +480,8 @@ ErrorOr<void> FormatBuilder::putU64(
     };
 
     auto const put_digits = [&]() -> ErrorOr<void> {
-        for (size_t i = 0; i < used_by_digits; ++i)
-            TRY(m_builder.tryAppend(buffer[i]));
+        auto bytes = TRY(m_builder.tryGetBytesForWriting(used_by_digits));
+        writeDigits(value, base, upperCase, reinterpret_cast<char*>(bytes.data()), used_by_digits);
         return {};
     };
 
@@ -399,142 +527,138 @@ ErrorOr<void> FormatBuilder::putI64(
     SignMode sign_mode)
 {
     auto const is_negative = value < 0;
-    value = is_negative ? -value : value;
+    // Negated as unsigned, since the magnitude of the smallest Int64 does not fit in an Int64.
+    auto const magnitude = is_negative ? 0 - static_cast<UInt64>(value) : static_cast<UInt64>(value);
 
-    TRY(putU64(static_cast<UInt64>(value), base, prefix, upperCase, zero_pad, align, min_width, fill, sign_mode, is_negative));
+    TRY(putU64(magnitude, base, prefix, upperCase, zero_pad, align, min_width, fill, sign_mode, is_negative));
     return {};
 }
 
 #ifndef KERNEL
-ErrorOr<void> FormatBuilder::putF64(
-    double value,
-    UInt8 base,
-    bool upperCase,
-    bool zero_pad,
-    Align align,
-    size_t min_width,
-    size_t precision,
-    char fill,
-    SignMode sign_mode)
-{
-    StringBuilder string_builder;
-    FormatBuilder format_builder { string_builder };
 
-    if (__builtin_isnan(value) || __builtin_isinf(value)) {
-        if (value < 0.0)
-            TRY(string_builder.tryAppend('-'));
-        else if (sign_mode == SignMode::Always)
-            TRY(string_builder.tryAppend('+'));
-        else if (sign_mode == SignMode::Reserved)
-            TRY(string_builder.tryAppend(' '));
+namespace {
 
-        if (__builtin_isnan(value))
-            TRY(string_builder.tryAppend(upperCase ? "NAN"sv : "nan"sv));
-        else
-            TRY(string_builder.tryAppend(upperCase ? "INF"sv : "inf"sv));
-        TRY(putString(string_builder.stringView(), align, min_width, NumericLimits<size_t>::max(), fill));
-        return {};
-    }
+    template<typename T>
+    static ErrorOr<void> putFloatingPoint(
+        FormatBuilder& builder,
+        T value,
+        UInt8 base,
+        bool upperCase,
+        bool zero_pad,
+        FormatBuilder::Align align,
+        size_t min_width,
+        Optional<size_t> precision,
+        char fill,
+        FormatBuilder::SignMode sign_mode) {
+
+        // Sign and digits are laid out here first so that padding can be applied to the whole field.
+        Vector<char, 128> text;
+
+        if (value < 0) {
+
+            TRY(text.tryAppend('-'));
+        }
+        else if (sign_mode == FormatBuilder::SignMode::Always) {
 
-    bool is_negative = value < 0.0;
-    if (is_negative)
-        value = -value;
+            TRY(text.tryAppend('+'));
+        }
+        else if (sign_mode == FormatBuilder::SignMode::Reserved) {
 
-    TRY(format_builder.putU64(static_cast<UInt64>(value), base, false, upperCase, false, Align::Right, 0, ' ', sign_mode, is_negative));
+            TRY(text.tryAppend(' '));
+        }
 
-    if (precision > 0) {
-        // FIXME: This is a terrible approximation but doing it properly would be a lot of work. If someone is up for that, a good
-        // place to start would be the following video from CppCon 2019:
-        // https://youtu.be/4P_kbF0EbZM (Stephan T. Lavavej “Floating-Point <charconv>: Making Your Code 10x Faster With C++17's Final Boss”)
-        value -= static_cast<Int64>(value);
+        if (__builtin_isnan(value) || __builtin_isinf(value)) {
 
-        double epsilon = 0.5;
-        for (size_t i = 0; i < precision; ++i)
-            epsilon /= 10.0;
+            auto const name = __builtin_isnan(value) ? (upperCase ? "NAN"sv : "nan"sv) : (upperCase ? "INF"sv : "inf"sv);
 
-        size_t visible_precision = 0;
-        for (; visible_precision < precision; ++visible_precision) {
-            if (value - static_cast<Int64>(value) < epsilon)
-                break;
-            value *= 10.0;
-            epsilon *= 10.0;
+            TRY(text.tryAppend(name.charactersWithoutNullTermination(), name.length()));
         }
+        else {
 
-        if (zero_pad || visible_precision > 0)
-            TRY(string_builder.tryAppend('.'));
+            if (value < 0) {
 
-        if (visible_precision > 0)
-            TRY(format_builder.putU64(static_cast<UInt64>(value), base, false, upperCase, true, Align::Right, visible_precision));
+                value = -value;
+            }
 
-        if (zero_pad && (precision - visible_precision) > 0)
-            TRY(format_builder.putU64(0, base, false, false, true, Align::Right, precision - visible_precision));
-    }
+            if (!precision.hasValue() && base == 10) {
 
-    TRY(putString(string_builder.stringView(), align, min_width, NumericLimits<size_t>::max(), fill));
-    return {};
-}
+                if constexpr (IsSame<T, long double>) {
 
-ErrorOr<void> FormatBuilder::putF80(
-    long double value,
-    UInt8 base,
-    bool upperCase,
-    Align align,
-    size_t min_width,
-    size_t precision,
-    char fill,
-    SignMode sign_mode)
-{
-    StringBuilder string_builder;
-    FormatBuilder format_builder { string_builder };
+                    TRY(appendRoundTripDigits(text, value));
+                }
+                else {
 
-    if (__builtin_isnan(value) || __builtin_isinf(value)) {
-        if (value < 0.0l)
-            TRY(string_builder.tryAppend('-'));
-        else if (sign_mode == SignMode::Always)
-            TRY(string_builder.tryAppend('+'));
-        else if (sign_mode == SignMode::Reserved)
-            TRY(string_builder.tryAppend(' '));
+                    char buffer[maxShortestDecimalLength];
 
-        if (__builtin_isnan(value))
-            TRY(string_builder.tryAppend(upperCase ? "NAN"sv : "nan"sv));
-        else
-            TRY(string_builder.tryAppend(upperCase ? "INF"sv : "inf"sv));
-        TRY(putString(string_builder.stringView(), align, min_width, NumericLimits<size_t>::max(), fill));
-        return {};
-    }
+                    auto const length = value == 0 ? writeShortestDecimal({ }, buffer) : writeShortestDecimal(convertToShortestDecimal(value), buffer);
 
-    bool is_negative = value < 0.0l;
-    if (is_negative)
-        value = -value;
+                    TRY(text.tryAppend(buffer, length));
+                }
+            }
+            else {
 
-    TRY(format_builder.putU64(static_cast<UInt64>(value), base, false, upperCase, false, Align::Right, 0, ' ', sign_mode, is_negative));
+                auto const start = text.size();
 
-    if (precision > 0) {
-        // FIXME: This is a terrible approximation but doing it properly would be a lot of work. If someone is up for that, a good
-        // place to start would be the following video from CppCon 2019:
-        // https://youtu.be/4P_kbF0EbZM (Stephan T. Lavavej “Floating-Point <charconv>: Making Your Code 10x Faster With C++17's Final Boss”)
-        value -= static_cast<Int64>(value);
+                TRY(appendFixedPointDigits(text, value, precision.valueOr(6), base, upperCase));
 
-        long double epsilon = 0.5l;
-        for (size_t i = 0; i < precision; ++i)
-            epsilon /= 10.0l;
+                if (!zero_pad && text.span().slice(start).contains_slow('.')) {
 
-        size_t visible_precision = 0;
-        for (; visible_precision < precision; ++visible_precision) {
-            if (value - static_cast<Int64>(value) < epsilon)
-                break;
-            value *= 10.0l;
-            epsilon *= 10.0l;
-        }
+                    while (text.last() == '0') {
+
+                        text.takeLast();
+                    }
+
+                    if (text.last() == '.') {
 
-        if (visible_precision > 0) {
-            string_builder.append('.');
-            TRY(format_builder.putU64(static_cast<UInt64>(value), base, false, upperCase, true, Align::Right, visible_precision));
+                        text.takeLast();
+                    }
+                }
+            }
         }
+
+        return builder.putString(StringView { text.data(), text.size() }, align, min_width, NumericLimits<size_t>::max(), fill);
     }
+}
 
-    TRY(putString(string_builder.stringView(), align, min_width, NumericLimits<size_t>::max(), fill));
-    return { };
+ErrorOr<void> FormatBuilder::putF64(
+    double value,
+    UInt8 base,
+    bool upperCase,
+    bool zero_pad,
+    Align align,
+    size_t min_width,
+    Optional<size_t> precision,
+    char fill,
+    SignMode sign_mode)
+{
+    return putFloatingPoint(*this, value, base, upperCase, zero_pad, align, min_width, precision, fill, sign_mode);
+}
+
+ErrorOr<void> FormatBuilder::putF32(
+    float value,
+    UInt8 base,
+    bool upperCase,
+    bool zero_pad,
+    Align align,
+    size_t min_width,
+    Optional<size_t> precision,
+    char fill,
+    SignMode sign_mode)
+{
+    return putFloatingPoint(*this, value, base, upperCase, zero_pad, align, min_width, precision, fill, sign_mode);
+}
+
+ErrorOr<void> FormatBuilder::putF80(
+    long double value,
+    UInt8 base,
+    bool upperCase,
+    Align align,
+    size_t min_width,
+    Optional<size_t> precision,
+    char fill,
+    SignMode sign_mode)
+{
+    return putFloatingPoint(*this, value, base, upperCase, false, align, min_width, precision, fill, sign_mode);
 }
 
 #endif
@@ -947,9 +1071,13 @@ ErrorOr<void> Formatter<long double>::format(FormatBuilder& builder, long double
     }
 
     m_width = m_width.valueOr(0);
-    m_precision = m_precision.valueOr(6);
 
-    return builder.putF80(value, base, upperCase, m_align, m_width.value(), m_precision.value(), m_fill, m_sign_mode);
+    if (m_mode != Mode::Default) {
+
+        m_precision = m_precision.valueOr(6);
+    }
+
+    return builder.putF80(value, base, upperCase, m_align, m_width.value(), m_precision, m_fill, m_sign_mode);
 }
 
 ErrorOr<void> Formatter<double>::format(FormatBuilder& builder, double value) {
@@ -978,16 +1106,48 @@ ErrorOr<void> Formatter<double>::format(FormatBuilder& builder, double value) {
     }
 
     m_width = m_width.valueOr(0);
-    m_precision = m_precision.valueOr(6);
 
-    return builder.putF64(value, base, upperCase, m_zero_pad, m_align, m_width.value(), m_precision.value(), m_fill, m_sign_mode);
+    if (m_mode != Mode::Default) {
+
+        m_precision = m_precision.valueOr(6);
+    }
+
+    return builder.putF64(value, base, upperCase, m_zero_pad, m_align, m_width.value(), m_precision, m_fill, m_sign_mode);
 }
 
 ErrorOr<void> Formatter<float>::format(FormatBuilder& builder, float value) {
 
-    Formatter<double> formatter { *this };
+    UInt8 base = 10;
+    bool upperCase = false;
+
+    if (m_mode == Mode::Default || m_mode == Mode::Float) {
+        
+        base = 10;
+        upperCase = false;
+    } 
+    else if (m_mode == Mode::Hexfloat) {
+        
+        base = 16;
+        upperCase = false;
+    } 
+    else if (m_mode == Mode::HexfloatUppercase) {
+        
+        base = 16;
+        upperCase = true;
+    } 
+    else {
+
+        VERIFY_NOT_REACHED();
+    }
+
+    m_width = m_width.valueOr(0);
+
+    if (m_mode != Mode::Default) {
+
+        m_precision = m_precision.valueOr(6);
+    }
 
-    return formatter.format(builder, value);
+    return builder.putF32(value, base, upperCase, m_zero_pad, m_align, m_width.value(), m_precision, m_fill, m_sign_mode);
 }
 
 #endif
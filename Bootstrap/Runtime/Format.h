@@ -249,13 +249,16 @@ public:
 
 #ifndef KERNEL
 
+    // Without a precision, decimal output is the shortest text that reads back as the same value. With one,
+    // it is the exact value rounded to that many digits, trailing zeros dropped unless zero_pad is set.
+
     ErrorOr<void> putF80(
         long double value,
         UInt8 base = 10,
         bool upperCase = false,
         Align align = Align::Right,
         size_t min_width = 0,
-        size_t precision = 6,
+        Optional<size_t> precision = { },
         char fill = ' ',
         SignMode sign_mode = SignMode::OnlyIfNeeded);
 
@@ -266,10 +269,21 @@ public:
         bool zero_pad = false,
         Align align = Align::Right,
         size_t min_width = 0,
-        size_t precision = 6,
+        Optional<size_t> precision = { },
         char fill = ' ',
         SignMode sign_mode = SignMode::OnlyIfNeeded);
-        
+
+    ErrorOr<void> putF32(
+        float value,
+        UInt8 base = 10,
+        bool upperCase = false,
+        bool zero_pad = false,
+        Align align = Align::Right,
+        size_t min_width = 0,
+        Optional<size_t> precision = { },
+        char fill = ' ',
+        SignMode sign_mode = SignMode::OnlyIfNeeded);
+
 #endif
 
     ErrorOr<void> putHexDump(
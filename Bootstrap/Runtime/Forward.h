@@ -10,6 +10,7 @@
 
 class Bitmap;
 class Error;
+class FlyString;
 class GenericLexer;
 class String;
 class StringBuilder;
@@ -46,18 +47,30 @@ class HashTable;
 template<typename T, typename TraitsForT = Traits<T>>
 using OrderedHashTable = HashTable<T, TraitsForT, true>;
 
-template<typename K, typename V, typename KeyTraits = Traits<K>, bool IsOrdered = false>
+template<typename T, typename TraitsForT = Traits<T>>
+class SwissHashTable;
+
+template<typename K, typename V, typename KeyTraits = Traits<K>, bool IsOrdered = false, bool UsesSwissTable = false>
 class HashMap;
 
 template<typename K, typename V, typename KeyTraits = Traits<K>>
 using OrderedHashMap = HashMap<K, V, KeyTraits, true>;
 
+template<typename K, typename V, typename KeyTraits = Traits<K>>
+using SwissHashMap = HashMap<K, V, KeyTraits, false, true>;
+
 template<typename>
 class Function;
 
 template<typename Out, typename... In>
 class Function<Out(In...)>;
 
+template<typename T>
+class BorrowedReference;
+
+template<typename T, size_t Capacity = 32>
+class DeferredDereferenceBuffer;
+
 template<typename T>
 class NonNullReferencePointer;
 
@@ -83,3 +96,9 @@ requires(!IsRValueReference<T>) class Vector;
 
 template<typename T, typename ErrorType = Error>
 class [[nodiscard]] ErrorOr;
+
+namespace NeuInternal {
+
+    template<typename T>
+    class Array;
+}
@@ -29,7 +29,7 @@
 #include "Assertions.h"
 #include "Atomic.h"
 #include "BitCast.h"
-#include "NonCopyable.h"
+#include "Noncopyable.h"
 #include "ScopeGuard.h"
 #include "StdLibExtras.h"
 #include "Types.h"
@@ -6,6 +6,7 @@
 
 #include "Assertions.h"
 #include "CharacterTypes.h"
+#include "FloatingPointStringConversions.h"
 #include "GenericLexer.h"
 #include "StringBuilder.h"
 
@@ -172,3 +173,33 @@ StringView GenericLexer::consumeQuotedString(char escape_char) {
 
     return m_input.substringView(start, length);
 }
+
+#ifndef KERNEL
+
+template<typename T>
+static Optional<T> consumeFloatingPoint(StringView input, size_t& index) {
+
+    auto const* start = input.charactersWithoutNullTermination() + index;
+    auto const result = parseFirstFloatingPoint<T>(start, input.charactersWithoutNullTermination() + input.length());
+
+    if (!result.parsedValue()) {
+
+        return { };
+    }
+
+    index += result.endPointer - start;
+
+    return result.value;
+}
+
+Optional<double> GenericLexer::consumeDouble() {
+
+    return consumeFloatingPoint<double>(m_input, m_index);
+}
+
+Optional<float> GenericLexer::consumeFloat() {
+
+    return consumeFloatingPoint<float>(m_input, m_index);
+}
+
+#endif
@@ -131,6 +131,14 @@ public:
     StringView consumeUntil(StringView);
     StringView consumeQuotedString(char escape_char = 0);
 
+#ifndef KERNEL
+
+    // Consumes the longest floating-point literal at the current position; on failure nothing is consumed.
+    Optional<double> consumeDouble();
+    Optional<float> consumeFloat();
+
+#endif
+
     constexpr void ignore(size_t count = 1) {
 
         count = min(count, m_input.length() - m_index);
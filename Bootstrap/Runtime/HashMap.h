@@ -8,12 +8,17 @@
 
 #include "HashTable.h"
 #include "Optional.h"
+#include "SwissHashTable.h"
 #include "Vector.h"
 #include <initializer_list>
 
-template<typename K, typename V, typename KeyTraits, bool IsOrdered>
+// UsesSwissTable picks SwissHashTable as the backing store (see SwissHashMap), which cannot keep insertion order.
+
+template<typename K, typename V, typename KeyTraits, bool IsOrdered, bool UsesSwissTable>
 class HashMap {
 
+    static_assert(!(IsOrdered && UsesSwissTable));
+
 private:
 
     struct Entry {
@@ -24,7 +29,7 @@ private:
 
     struct EntryTraits {
 
-        static unsigned hash(Entry const& entry) { return KeyTraits::hash(entry.key); }
+        static auto hash(Entry const& entry) { return KeyTraits::hash(entry.key); }
         static bool equals(Entry const& a, Entry const& b) { return KeyTraits::equals(a.key, b.key); }
     };
 
@@ -99,7 +104,7 @@ public:
         });
     }
 
-    using HashTableType = HashTable<Entry, EntryTraits, IsOrdered>;
+    using HashTableType = Conditional<UsesSwissTable, SwissHashTable<Entry, EntryTraits>, HashTable<Entry, EntryTraits, IsOrdered>>;
     using IteratorType = typename HashTableType::Iterator;
     using ConstIteratorType = typename HashTableType::ConstIterator;
 
@@ -111,7 +116,7 @@ public:
     }
 
     template<typename TUnaryPredicate>
-    [[nodiscard]] IteratorType find(unsigned hash, TUnaryPredicate predicate) {
+    [[nodiscard]] IteratorType find(UInt64 hash, TUnaryPredicate predicate) {
 
         return m_table.find(hash, predicate);
     }
@@ -126,7 +131,7 @@ public:
     }
     
     template<typename TUnaryPredicate>
-    [[nodiscard]] ConstIteratorType find(unsigned hash, TUnaryPredicate predicate) const {
+    [[nodiscard]] ConstIteratorType find(UInt64 hash, TUnaryPredicate predicate) const {
 
         return m_table.find(hash, predicate);
     }
@@ -229,7 +234,7 @@ public:
     }
 
     template<Concepts::HashCompatible<K> Key>
-    requires(IsSame<KeyTraits, Traits<K>>) [[nodiscard]] bool contains(Key const& value) {
+    requires(IsSame<KeyTraits, Traits<K>>) [[nodiscard]] bool contains(Key const& value) const {
 
         return find(value) != end();
     }
@@ -12,6 +12,7 @@
 #include "HashFunctions.h"
 #include "StdLibExtras.h"
 #include "Traits.h"
+#include "TypedTransfer.h"
 #include "Types.h"
 #include "kmalloc.h"
 
@@ -28,30 +29,27 @@ enum class HashSetExistingEntryBehavior {
     Replace
 };
 
-// Upper nibble determines state class:
-// - 0: unused bucket
-// - 1: used bucket
-// - F: end bucket
-// Lower nibble determines state within a class.
+// A used bucket's state also records how far it sits from the bucket its hash points at (its probe length), so
+// Robin Hood probing rarely has to rehash anything. Probe lengths too long for the byte are marked CalculateLength
+// and recomputed from the hash when needed.
 
 enum class BucketState : UInt8 {
     
     Free = 0x00,
-    Used = 0x10,
-    Deleted = 0x01,
-    Rehashed = 0x12,
+    Used = 0x01,
+    CalculateLength = 0xFE,
     End = 0xFF,
 };
 
 // Note that because there's the end state, used and free are not 100% opposites!
 constexpr bool isUsedBucket(BucketState state) {
 
-    return (static_cast<UInt8>(state) & 0xf0) == 0x10;
+    return state != BucketState::Free && state != BucketState::End;
 }
 
 constexpr bool isFreeBucket(BucketState state) {
 
-    return (static_cast<UInt8>(state) & 0xf0) == 0x00;
+    return state == BucketState::Free;
 }
 
 template<typename HashTableType, typename T, typename BucketType>
@@ -84,7 +82,7 @@ private:
 
             ++m_bucket;
 
-            if (m_bucket->state == BucketState::Used) {
+            if (isUsedBucket(m_bucket->state)) {
 
                 return;
             }
@@ -174,7 +172,7 @@ public:
             }
         }
 
-        kfree_sized(m_buckets, size_in_bytes(m_capacity));
+        kfree_sized(m_buckets, size_in_bytes(m_capacity), AllocationSite::HashTableBuckets);
     }
 
     HashTable(HashTable const& other)
@@ -196,11 +194,9 @@ public:
         , m_collection_data(other.m_collection_data)
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
-        , m_deleted_count(other.m_deleted_count)
     {
         other.m_size = 0;
         other.m_capacity = 0;
-        other.m_deleted_count = 0;
         other.m_buckets = nullptr;
         if constexpr (IsOrdered)
             other.m_collection_data = { nullptr, nullptr };
@@ -218,7 +214,6 @@ public:
         swap(a.m_buckets, b.m_buckets);
         swap(a.m_size, b.m_size);
         swap(a.m_capacity, b.m_capacity);
-        swap(a.m_deleted_count, b.m_deleted_count);
 
         if constexpr (IsOrdered)
             swap(a.m_collection_data, b.m_collection_data);
@@ -243,14 +238,23 @@ public:
 
     void ensureCapacity(size_t capacity)
     {
-        VERIFY(capacity >= size());
-        rehash(capacity * 2);
+        MUST(tryEnsureCapacity(capacity));
     }
 
     ErrorOr<void> tryEnsureCapacity(size_t capacity)
     {
         VERIFY(capacity >= size());
-        return tryRehash(capacity * 2);
+
+        // Room for `capacity` values without crossing the load factor, so none of them triggers a rehash.
+
+        auto bucket_count = capacity * 100 / load_factor_in_percent + 1;
+
+        if (bucket_count <= m_capacity) {
+
+            return { };
+        }
+
+        return tryRehash(bucket_count);
     }
 
     [[nodiscard]] bool contains(T const& value) const {
@@ -319,13 +323,17 @@ public:
 
     void clearWithCapacity()
     {
+        if (!m_buckets)
+            return;
+
         if constexpr (!Detail::IsTriviallyDestructible<T>) {
-            for (auto* bucket : *this)
-                bucket->~T();
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (isUsedBucket(m_buckets[i].state))
+                    m_buckets[i].slot()->~T();
+            }
         }
         __builtin_memset(m_buckets, 0, size_in_bytes(capacity()));
         m_size = 0;
-        m_deleted_count = 0;
 
         if constexpr (IsOrdered)
             m_collection_data = { nullptr, nullptr };
@@ -336,36 +344,55 @@ public:
     template<typename U = T>
     ErrorOr<HashSetResult> try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behavior = HashSetExistingEntryBehavior::Replace)
     {
-        auto* bucket = TRY(tryLookupForWriting(value));
-        
-        if (isUsedBucket(bucket->state)) {
+        if (should_grow()) {
+
+            TRY(tryRehash(capacity() * 2));
+        }
+
+        auto hash = TraitsForT::hash(value);
+
+        size_t index = hash & (m_capacity - 1);
+
+        size_t probe_length = 0;
+
+        for (;;) {
+
+            auto& bucket = m_buckets[index];
 
-            if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep) {
+            if (isFreeBucket(bucket.state)) {
 
-                return HashSetResult::KeptExistingEntry;
+                break;
             }
 
-            (*bucket->slot()) = forward<U>(value);
-            
-            return HashSetResult::ReplacedExistingEntry;
-        }
+            if (TraitsForT::equals(*bucket.slot(), value)) {
 
-        new (bucket->slot()) T(forward<U>(value));
-        if (bucket->state == BucketState::Deleted)
-            --m_deleted_count;
-        bucket->state = BucketState::Used;
+                if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep) {
 
-        if constexpr (IsOrdered) {
-            if (!m_collection_data.head) {
-                m_collection_data.head = bucket;
-            } else {
-                bucket->previous = m_collection_data.tail;
-                m_collection_data.tail->next = bucket;
+                    return HashSetResult::KeptExistingEntry;
+                }
+
+                (*bucket.slot()) = forward<U>(value);
+
+                return HashSetResult::ReplacedExistingEntry;
+            }
+
+            // Every value with this hash would have been placed before a bucket that is closer to its own home,
+            // so the value is not in the table and takes this bucket over.
+
+            if (bucketProbeLength(index) < probe_length) {
+
+                break;
             }
-            m_collection_data.tail = bucket;
+
+            index = (index + 1) & (m_capacity - 1);
+
+            ++probe_length;
         }
 
-        ++m_size;
+        auto& bucket = insertAt(index, probe_length);
+
+        new (bucket.slot()) T(forward<U>(value));
+
         return HashSetResult::InsertedNewEntry;
     }
     template<typename U = T>
@@ -374,8 +401,10 @@ public:
         return MUST(try_set(forward<U>(value), existing_entry_behaviour));
     }
 
+    // Hashes may be 32 or 64 bits wide (see stringHash64()); a TraitsForT::hash() returning UInt64 is used as is.
+
     template<typename TUnaryPredicate>
-    [[nodiscard]] Iterator find(unsigned hash, TUnaryPredicate predicate)
+    [[nodiscard]] Iterator find(UInt64 hash, TUnaryPredicate predicate)
     {
         return Iterator(lookup_with_hash(hash, move(predicate)));
     }
@@ -386,7 +415,7 @@ public:
     }
 
     template<typename TUnaryPredicate>
-    [[nodiscard]] ConstIterator find(unsigned hash, TUnaryPredicate predicate) const
+    [[nodiscard]] ConstIterator find(UInt64 hash, TUnaryPredicate predicate) const
     {
         return ConstIterator(lookup_with_hash(hash, move(predicate)));
     }
@@ -400,7 +429,7 @@ public:
     template<Concepts::HashCompatible<T> K>
     requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value)
     {
-        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(value, other); });
     }
 
     template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
@@ -412,7 +441,7 @@ public:
     template<Concepts::HashCompatible<T> K>
     requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value) const
     {
-        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(value, other); });
     }
 
     template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
@@ -452,9 +481,6 @@ public:
 
         delete_bucket(bucket);
         --m_size;
-        ++m_deleted_count;
-
-        rehashInPlaceIfNeeded();
     }
 
     template<typename TUnaryPredicate>
@@ -466,7 +492,9 @@ public:
             
             auto& bucket = m_buckets[i];
             
-            if (isUsedBucket(bucket.state) && predicate(*bucket.slot())) {
+            // Deleting shifts the following bucket back into this one, so look at it again.
+
+            while (isUsedBucket(bucket.state) && predicate(*bucket.slot())) {
 
                 delete_bucket(bucket);
 
@@ -474,33 +502,32 @@ public:
             }
         }
 
-        if (removed_count) {
-
-            m_deleted_count += removed_count;
-            m_size -= removed_count;
-        }
-        
-        rehashInPlaceIfNeeded();
+        m_size -= removed_count;
 
         return removed_count;
     }
 
 private:
-    void insert_during_rehash(T&& value)
+    // Relocates `value` out of the old bucket array: afterwards it must not be destroyed again.
+
+    void insert_during_rehash(T& value)
     {
-        auto& bucket = lookup_for_writing(value);
-        new (bucket.slot()) T(move(value));
-        bucket.state = BucketState::Used;
+        auto hash = TraitsForT::hash(value);
 
-        if constexpr (IsOrdered) {
-            if (!m_collection_data.head) {
-                m_collection_data.head = &bucket;
-            } else {
-                bucket.previous = m_collection_data.tail;
-                m_collection_data.tail->next = &bucket;
-            }
-            m_collection_data.tail = &bucket;
+        size_t index = hash & (m_capacity - 1);
+
+        size_t probe_length = 0;
+
+        while (isUsedBucket(m_buckets[index].state) && bucketProbeLength(index) >= probe_length) {
+
+            index = (index + 1) & (m_capacity - 1);
+
+            ++probe_length;
         }
+
+        auto& bucket = insertAt(index, probe_length);
+
+        TypedTransfer<T>::relocate(bucket.slot(), &value, 1);
     }
 
     [[nodiscard]] static constexpr size_t size_in_bytes(size_t capacity)
@@ -514,21 +541,20 @@ private:
 
     ErrorOr<void> tryRehash(size_t new_capacity) {
 
-        if (new_capacity == m_capacity && new_capacity >= 4) {
-            
-            rehash_in_place();
-            
-            return { };
-        }
+        // Capacities are powers of two so that a hash is turned into a bucket index with a mask, not a division.
 
         new_capacity = max(new_capacity, static_cast<size_t>(4));
-        new_capacity = kmalloc_good_size(new_capacity * sizeof(BucketType)) / sizeof(BucketType);
+
+        if (!is_power_of_two(new_capacity)) {
+
+            new_capacity = static_cast<size_t>(1) << (sizeof(size_t) * 8 - __builtin_clzl(new_capacity));
+        }
 
         auto* old_buckets = m_buckets;
         auto old_capacity = m_capacity;
         Iterator old_iter = begin();
 
-        auto* new_buckets = kcalloc(1, size_in_bytes(new_capacity));
+        auto* new_buckets = kcalloc(1, size_in_bytes(new_capacity), AllocationSite::HashTableBuckets);
         
         if (!new_buckets) {
 
@@ -538,7 +564,6 @@ private:
         m_buckets = (BucketType*)new_buckets;
 
         m_capacity = new_capacity;
-        m_deleted_count = 0;
 
         if constexpr (IsOrdered) {
 
@@ -554,14 +579,16 @@ private:
             return {};
         }
 
+        // Reinserting counts every value again.
+
+        m_size = 0;
+
         for (auto it = move(old_iter); it != end(); ++it) {
             
-            insert_during_rehash(move(*it));
-            
-            it->~T();
+            insert_during_rehash(*it);
         }
 
-        kfree_sized(old_buckets, size_in_bytes(old_capacity));
+        kfree_sized(old_buckets, size_in_bytes(old_capacity), AllocationSite::HashTableBuckets);
 
         return { };
     }
@@ -571,283 +598,164 @@ private:
         MUST(tryRehash(new_capacity));
     }
 
-    void rehash_in_place() {
+    // How far the value in the used bucket at `index` sits from the bucket its hash points at.
 
-        // FIXME: This implementation takes two loops over the entire bucket array, but avoids re-allocation.
-        //        Please benchmark your new implementation before you replace this.
-        //        The reason is that because of collisions, we use the special "rehashed" bucket state to mark already-rehashed used buckets.
-        //        Because we of course want to write into old used buckets, but already rehashed data shall not be touched.
+    [[nodiscard]] size_t bucketProbeLength(size_t index) const {
 
-        // FIXME: Find a way to reduce the cognitive complexity of this function.
+        auto state = m_buckets[index].state;
 
-        for (size_t i = 0; i < m_capacity; ++i) {
-
-            auto& bucket = m_buckets[i];
+        if (state != BucketState::CalculateLength) {
 
-            // FIXME: Bail out when we have handled every filled bucket.
-
-            if (bucket.state == BucketState::Rehashed || bucket.state == BucketState::End || bucket.state == BucketState::Free) {
+            return static_cast<size_t>(state) - static_cast<size_t>(BucketState::Used);
+        }
 
-                continue;
-            }
+        return (index - TraitsForT::hash(*m_buckets[index].slot())) & (m_capacity - 1);
+    }
 
-            if (bucket.state == BucketState::Deleted) {
-                
-                bucket.state = BucketState::Free;
-                
-                continue;
-            }
+    static constexpr BucketState stateForProbeLength(size_t probe_length) {
 
-            auto const new_hash = TraitsForT::hash(*bucket.slot());
+        constexpr size_t max_stored_probe_length = static_cast<size_t>(BucketState::CalculateLength) - static_cast<size_t>(BucketState::Used);
 
-            if (new_hash % m_capacity == i) {
-                bucket.state = BucketState::Rehashed;
-                continue;
-            }
+        if (probe_length >= max_stored_probe_length) {
 
-            auto target_hash = new_hash;
-            auto const to_move_hash = i;
-            BucketType* target_bucket = &m_buckets[target_hash % m_capacity];
-            BucketType* bucket_to_move = &m_buckets[i];
+            return BucketState::CalculateLength;
+        }
 
-            // Try to move the bucket to move into its correct spot.
-            // During the procedure, we might re-hash or actually change the bucket to move.
-            while (!isFreeBucket(bucket_to_move->state)) {
+        return static_cast<BucketState>(static_cast<size_t>(BucketState::Used) + probe_length);
+    }
 
-                // If we're targeting ourselves, there's nothing to do.
-                
-                if (to_move_hash == target_hash % m_capacity) {
+    template<typename TUnaryPredicate>
+    [[nodiscard]] BucketType* lookup_with_hash(UInt64 hash, TUnaryPredicate predicate) const {
 
-                    bucket_to_move->state = BucketState::Rehashed;
-                    
-                    break;
-                }
+        if (isEmpty()) {
 
-                if (isFreeBucket(target_bucket->state)) {
+            return nullptr;
+        }
 
-                    // We can just overwrite the target bucket and bail out.
-                    
-                    new (target_bucket->slot()) T(move(*bucket_to_move->slot()));
-                    
-                    target_bucket->state = BucketState::Rehashed;
-                    
-                    bucket_to_move->state = BucketState::Free;
+        size_t index = hash & (m_capacity - 1);
 
-                    if constexpr (IsOrdered) {
+        for (size_t probe_length = 0;; ++probe_length) {
 
-                        swap(bucket_to_move->previous, target_bucket->previous);
-                        swap(bucket_to_move->next, target_bucket->next);
+            auto& bucket = m_buckets[index];
 
-                        if (target_bucket->previous) {
+            if (isFreeBucket(bucket.state)) {
 
-                            target_bucket->previous->next = target_bucket;
-                        }
-                        else {
+                return nullptr;
+            }
 
-                            m_collection_data.head = target_bucket;
-                        }
+            // A value this far from home would have displaced the one stored here.
 
-                        if (target_bucket->next) {
+            if (bucketProbeLength(index) < probe_length) {
 
-                            target_bucket->next->previous = target_bucket;
-                        }
-                        else {
+                return nullptr;
+            }
 
-                            m_collection_data.tail = target_bucket;
-                        }
-                    }
-                } 
-                else if (target_bucket->state == BucketState::Rehashed) {
-                    // If the target bucket is already re-hashed, we do normal probing.
-                    target_hash = doubleHash(target_hash);
-                    target_bucket = &m_buckets[target_hash % m_capacity];
-                } 
-                else {
+            if (predicate(*bucket.slot())) {
 
-                    VERIFY(target_bucket->state != BucketState::End);
-                    
-                    // The target bucket is a used bucket that hasn't been re-hashed.
-                    // Swap the data into the target; now the target's data resides in the bucket to move again.
-                    // (That's of course what we want, how neat!)
-                    
-                    swap(*bucket_to_move->slot(), *target_bucket->slot());
-                    
-                    bucket_to_move->state = target_bucket->state;
-                    
-                    target_bucket->state = BucketState::Rehashed;
+                return &bucket;
+            }
 
-                    if constexpr (IsOrdered) {
+            index = (index + 1) & (m_capacity - 1);
+        }
+    }
 
-                        // Update state for the target bucket, we'll do the bucket to move later.
-                        
-                        swap(bucket_to_move->previous, target_bucket->previous);
-                        swap(bucket_to_move->next, target_bucket->next);
+    [[nodiscard]] bool should_grow() const { return ((m_size + 1) * 100) >= (m_capacity * load_factor_in_percent); }
 
-                        if (target_bucket->previous) {
+    // Makes the bucket at `index` free for a new value `probe_length` away from home (Robin Hood insertion): the run
+    // of used buckets starting there moves one bucket forward, each one step further from its own home. Returns the
+    // bucket, marked as used and linked in last for ordered tables; the caller constructs the value in it.
 
-                            target_bucket->previous->next = target_bucket;
-                        }
-                        else {
+    BucketType& insertAt(size_t index, size_t probe_length) {
 
-                            m_collection_data.head = target_bucket;
-                        }
+        auto mask = m_capacity - 1;
 
-                        if (target_bucket->next) {
+        size_t free_index = index;
 
-                            target_bucket->next->previous = target_bucket;
-                        }
-                        else {
+        while (isUsedBucket(m_buckets[free_index].state)) {
 
-                            m_collection_data.tail = target_bucket;
-                        }
-                    }
+            free_index = (free_index + 1) & mask;
+        }
 
-                    target_hash = TraitsForT::hash(*bucket_to_move->slot());
-                    target_bucket = &m_buckets[target_hash % m_capacity];
+        while (free_index != index) {
 
-                    // The data is already in the correct location: Adjust the pointers
-                    
-                    if (target_hash % m_capacity == to_move_hash) {
+            auto previous_index = (free_index - 1) & mask;
 
-                        bucket_to_move->state = BucketState::Rehashed;
-                        
-                        if constexpr (IsOrdered) {
+            auto moved_probe_length = bucketProbeLength(previous_index) + 1;
 
-                            // Update state for the bucket to move as it's not actually moved anymore.
-                            
-                            if (bucket_to_move->previous) {
+            moveBucket(m_buckets[previous_index], m_buckets[free_index], stateForProbeLength(moved_probe_length));
 
-                                bucket_to_move->previous->next = bucket_to_move;
-                            }
-                            else {
+            free_index = previous_index;
+        }
 
-                                m_collection_data.head = bucket_to_move;
-                            }
+        auto& bucket = m_buckets[index];
 
-                            if (bucket_to_move->next) {
+        bucket.state = stateForProbeLength(probe_length);
 
-                                bucket_to_move->next->previous = bucket_to_move;
-                            }
-                            else {
+        if constexpr (IsOrdered) {
 
-                                m_collection_data.tail = bucket_to_move;
-                            }
-                        }
+            bucket.previous = nullptr;
+            bucket.next = nullptr;
 
-                        break;
-                    }
-                }
-            }
-            
-            // After this, the bucket_to_move either contains data that rehashes to itself, or it contains nothing as we were able to move the last thing.
-            
-            if (bucket_to_move->state == BucketState::Deleted) {
+            if (!m_collection_data.head) {
 
-                bucket_to_move->state = BucketState::Free;
+                m_collection_data.head = &bucket;
             }
-        }
-
-        for (size_t i = 0; i < m_capacity; ++i) {
+            else {
 
-            if (m_buckets[i].state == BucketState::Rehashed) {
+                bucket.previous = m_collection_data.tail;
 
-                m_buckets[i].state = BucketState::Used;
+                m_collection_data.tail->next = &bucket;
             }
-        }
-
-        m_deleted_count = 0;
-    }
-
-    void rehashInPlaceIfNeeded() {
 
-        // This signals a "thrashed" hash table with many deleted slots.
+            m_collection_data.tail = &bucket;
+        }
 
-        if (m_deleted_count >= m_size && should_grow()) {
+        ++m_size;
 
-            rehash_in_place();
-        }
+        return bucket;
     }
 
-    template<typename TUnaryPredicate>
-    [[nodiscard]] BucketType* lookup_with_hash(unsigned hash, TUnaryPredicate predicate) const {
+    // Moves the value in `from` into the free bucket `to`, leaving `from` free.
 
-        if (isEmpty()) {
+    void moveBucket(BucketType& from, BucketType& to, BucketState state) {
 
-            return nullptr;
-        }
+        TypedTransfer<T>::relocate(to.slot(), from.slot(), 1);
 
-        for (;;) {
+        to.state = state;
 
-            auto& bucket = m_buckets[hash % m_capacity];
+        from.state = BucketState::Free;
 
-            if (isUsedBucket(bucket.state) && predicate(*bucket.slot())) {
+        if constexpr (IsOrdered) {
 
-                return &bucket;
-            }
+            to.previous = from.previous;
+            to.next = from.next;
 
-            if (bucket.state != BucketState::Used && bucket.state != BucketState::Deleted) {
+            if (to.previous) {
 
-                return nullptr;
+                to.previous->next = &to;
             }
+            else {
 
-            hash = doubleHash(hash);
-        }
-    }
-
-    ErrorOr<BucketType*> tryLookupForWriting(T const& value) {
-
-        // FIXME: Maybe overrun the "allowed" load factor to avoid OOM
-        //        If we are allowed to do that, separate that logic from
-        //        the normal lookup_for_writing
-        
-        if (should_grow()) {
-
-            TRY(tryRehash(capacity() * 2));
-        }
-        
-        auto hash = TraitsForT::hash(value);
-        
-        BucketType* first_empty_bucket = nullptr;
-        
-        for (;;) {
-
-            auto& bucket = m_buckets[hash % m_capacity];
-
-            if (isUsedBucket(bucket.state) && TraitsForT::equals(*bucket.slot(), value)) {
-
-                return &bucket;
+                m_collection_data.head = &to;
             }
 
-            if (!isUsedBucket(bucket.state)) {
-
-                if (!first_empty_bucket) {
+            if (to.next) {
 
-                    first_empty_bucket = &bucket;
-                }
-
-                if (bucket.state != BucketState::Deleted) {
-
-                    return const_cast<BucketType*>(first_empty_bucket);
-                }
+                to.next->previous = &to;
             }
+            else {
 
-            hash = doubleHash(hash);
+                m_collection_data.tail = &to;
+            }
         }
     }
 
-    [[nodiscard]] BucketType& lookup_for_writing(T const& value) {
-
-        return *MUST(tryLookupForWriting(value));
-    }
-
-    [[nodiscard]] size_t used_bucket_count() const { return m_size + m_deleted_count; }
-    [[nodiscard]] bool should_grow() const { return ((used_bucket_count() + 1) * 100) >= (m_capacity * load_factor_in_percent); }
+    // Destroys the value and pulls the values after it back by one bucket until one is already home or a bucket is
+    // free (backward shift deletion), so no tombstones are ever left behind.
 
     void delete_bucket(auto& bucket) {
 
         bucket.slot()->~T();
-        
-        bucket.state = BucketState::Deleted;
 
         if constexpr (IsOrdered) {
 
@@ -869,6 +777,33 @@ private:
                 m_collection_data.tail = bucket.previous;
             }
         }
+
+        auto mask = m_capacity - 1;
+
+        size_t index = &bucket - m_buckets;
+
+        for (;;) {
+
+            auto next_index = (index + 1) & mask;
+
+            if (!isUsedBucket(m_buckets[next_index].state)) {
+
+                break;
+            }
+
+            auto next_probe_length = bucketProbeLength(next_index);
+
+            if (next_probe_length == 0) {
+
+                break;
+            }
+
+            moveBucket(m_buckets[next_index], m_buckets[index], stateForProbeLength(next_probe_length - 1));
+
+            index = next_index;
+        }
+
+        m_buckets[index].state = BucketState::Free;
     }
 
     BucketType* m_buckets { nullptr };
@@ -876,5 +811,4 @@ private:
     [[no_unique_address]] CollectionDataType m_collection_data;
     size_t m_size { 0 };
     size_t m_capacity { 0 };
-    size_t m_deleted_count { 0 };
 };
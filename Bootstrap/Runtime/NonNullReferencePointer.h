@@ -262,6 +262,7 @@ struct Traits<NonNullReferencePointer<T>> : public GenericTraits<NonNullReferenc
     using ConstPeekType = const T*;
     static unsigned hash(NonNullReferencePointer<T> const& p) { return pointerHash(p.pointer()); }
     static bool equals(NonNullReferencePointer<T> const& a, NonNullReferencePointer<T> const& b) { return a.pointer() == b.pointer(); }
+    static constexpr bool isTriviallyRelocatable() { return true; }
 };
 
 #endif
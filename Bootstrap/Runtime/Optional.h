@@ -9,6 +9,7 @@
 
 #include "Assertions.h"
 #include "StdLibExtras.h"
+#include "Traits.h"
 #include "Types.h"
 #include "kmalloc.h"
 
@@ -426,3 +427,21 @@ private:
 
     RemoveReference<T>* m_pointer { nullptr };
 };
+
+template<typename T>
+struct Traits<Optional<T>> : public GenericTraits<Optional<T>> {
+
+    // The value sits in the Optional's own bytes, so it relocates exactly when the value does.
+
+    static constexpr bool isTriviallyRelocatable() {
+
+        if constexpr (IsLValueReference<T>) {
+
+            return true;
+        }
+        else {
+
+            return Traits<T>::isTriviallyRelocatable();
+        }
+    }
+};
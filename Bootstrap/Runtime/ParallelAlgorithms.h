@@ -0,0 +1,1074 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Assertions.h"
+#include "Error.h"
+#include "NumericLimits.h"
+#include "Optional.h"
+#include "Sort.h"
+#include "Span.h"
+#include "StdLibExtras.h"
+#include "ThreadPool.h"
+#include "Try.h"
+#include "Types.h"
+#include "Vector.h"
+
+// Bulk algorithms over a Span<T>, or anything with a span() such as Vector<T> and Array<T>, run the way an
+// ExecutionPolicy says:
+//
+//  - sequential(): one thread, elements visited in order, reduce() and inclusiveScan() fold strictly left to right.
+//  - vectorized(): one thread, but the loops are free to be split over SIMD lanes: transform() promises the
+//    compiler there are no dependencies between iterations, and reduce() keeps several independent partial results.
+//    The operation of reduce() and inclusiveScan() must then be associative. Sorting, filtering and partitioning
+//    have nothing to gain from this and run as sequential().
+//  - parallel(): split over the threads of a ThreadPool (the shared one unless given), with the same requirements
+//    as vectorized(). Inputs too small to be worth the hand-off, and pools without workers, run on the calling
+//    thread.
+//
+// Everything that can fail returns ErrorOr: parallel runs need memory for tasks and, in places, for a second copy
+// of the elements.
+
+class ExecutionPolicy {
+
+public:
+
+    enum class Kind : UInt8 {
+
+        Sequential,
+        Vectorized,
+        Parallel,
+    };
+
+    static constexpr ExecutionPolicy sequential() { return ExecutionPolicy(Kind::Sequential, nullptr); }
+
+    static constexpr ExecutionPolicy vectorized() { return ExecutionPolicy(Kind::Vectorized, nullptr); }
+
+    static ExecutionPolicy parallel(ThreadPool& pool = ThreadPool::shared()) { return ExecutionPolicy(Kind::Parallel, &pool); }
+
+    constexpr Kind kind() const { return m_kind; }
+
+    constexpr bool mayReorder() const { return m_kind != Kind::Sequential; }
+
+    // The pool to spread `size` elements over, or null if they are better handled on the calling thread.
+
+    ThreadPool* poolFor(size_t size, size_t minimum_size) const {
+
+        if (m_kind != Kind::Parallel || m_pool->workerCount() == 0 || size < minimum_size) {
+
+            return nullptr;
+        }
+
+        return m_pool;
+    }
+
+private:
+
+    constexpr ExecutionPolicy(Kind kind, ThreadPool* pool)
+        : m_kind(kind),
+          m_pool(pool) { }
+
+    Kind m_kind;
+
+    ThreadPool* m_pool;
+};
+
+#ifdef __clang__
+#    define VECTORIZABLE_LOOP _Pragma("clang loop vectorize(assume_safety)")
+#else
+#    define VECTORIZABLE_LOOP _Pragma("GCC ivdep")
+#endif
+
+namespace Detail {
+
+    // Below this many elements a parallel run stays on the calling thread, and no task gets fewer.
+
+    static constexpr size_t parallelGrain = 4096;
+
+    static constexpr size_t parallelSortThreshold = 64 * KiB;
+
+    static constexpr size_t reduceLanes = 8;
+
+    template<typename Container>
+    concept HasSpan = requires(Container& container) { container.span(); };
+
+    // Fixed chunks, a few per thread, for algorithms whose chunks have to be combined in order afterwards.
+
+    struct Chunks {
+
+        size_t size;
+
+        size_t count;
+
+        size_t begin(size_t chunk) const { return static_cast<size_t>(static_cast<unsigned __int128>(size) * chunk / count); }
+
+        size_t end(size_t chunk) const { return begin(chunk + 1); }
+    };
+
+    inline Chunks chunksFor(ThreadPool& pool, size_t size) {
+
+        auto count = min((pool.workerCount() + 1) * 4, max(size / parallelGrain, static_cast<size_t>(1)));
+
+        return { size, count };
+    }
+
+    template<typename Callback>
+    ErrorOr<void> forEachChunk(ThreadPool& pool, Chunks const& chunks, Callback const& callback) {
+
+        return parallelFor(pool, 0, chunks.count, 1, [&](size_t first, size_t last) -> ErrorOr<void> {
+
+            for (auto chunk = first; chunk < last; ++chunk) {
+
+                TRY(callback(chunk, chunks.begin(chunk), chunks.end(chunk)));
+            }
+
+            return { };
+        });
+    }
+
+    // parallelFor() for the passes that move values between two buffers, where stopping halfway would lose some of
+    // them: the callback cannot fail, and neither can this. A range whose task cannot be allocated runs on the
+    // thread that tried to hand it off.
+
+    template<typename Callback>
+    struct ParallelForAll {
+
+        TaskGroup& group;
+
+        size_t grain;
+
+        Callback const& callback;
+
+        void run(size_t begin, size_t end) const {
+
+            while (end - begin > grain) {
+
+                auto middle = begin + (end - begin) / 2;
+
+                // Three words of captures keep the Function from allocating as well.
+
+                auto spawned = group.spawn([this, middle, end]() -> ErrorOr<void> {
+
+                    run(middle, end);
+
+                    return { };
+                });
+
+                if (spawned.isError()) {
+
+                    break;
+                }
+
+                end = middle;
+            }
+
+            callback(begin, end);
+        }
+    };
+
+    template<typename Callback>
+    void parallelForAll(ThreadPool& pool, size_t begin, size_t end, size_t grain, Callback const& callback) {
+
+        if (end - begin <= grain || pool.workerCount() == 0) {
+
+            callback(begin, end);
+
+            return;
+        }
+
+        TaskGroup group(pool);
+
+        // The tasks point at this, so it has to outlive the join.
+
+        ParallelForAll<Callback> range { group, grain, callback };
+
+        range.run(begin, end);
+
+        auto joined = group.join();
+
+        VERIFY(!joined.isError());
+    }
+
+    template<typename Callback>
+    void forAllChunks(ThreadPool& pool, Chunks const& chunks, Callback const& callback) {
+
+        parallelForAll(pool, 0, chunks.count, 1, [&](size_t first, size_t last) {
+
+            for (auto chunk = first; chunk < last; ++chunk) {
+
+                callback(chunk, chunks.begin(chunk), chunks.end(chunk));
+            }
+        });
+    }
+
+    template<typename T, typename U, typename Function>
+    void transformRange(ExecutionPolicy policy, T* input, U* output, size_t size, Function& function) {
+
+        if (policy.mayReorder()) {
+
+            VECTORIZABLE_LOOP
+            for (size_t i = 0; i < size; ++i) {
+
+                output[i] = function(input[i]);
+            }
+        }
+        else {
+
+            for (size_t i = 0; i < size; ++i) {
+
+                output[i] = function(input[i]);
+            }
+        }
+    }
+
+    template<typename T, typename Operation>
+    T reduceRange(ExecutionPolicy policy, T const* values, size_t size, T initial, Operation& operation) {
+
+        if (!policy.mayReorder() || size < reduceLanes * 2) {
+
+            for (size_t i = 0; i < size; ++i) {
+
+                initial = operation(move(initial), values[i]);
+            }
+
+            return initial;
+        }
+
+        // Independent partial results, one per lane, which the compiler can keep side by side in a vector register.
+        // Every lane folds a contiguous block of its own, and the blocks are folded in order, so the operation only
+        // has to be associative, not commutative.
+
+        auto block_size = size / reduceLanes;
+
+        alignas(T) UInt8 lane_storage[sizeof(T) * reduceLanes];
+
+        auto* lanes = reinterpret_cast<T*>(lane_storage);
+
+        for (size_t lane = 0; lane < reduceLanes; ++lane) {
+
+            new (&lanes[lane]) T(values[lane * block_size]);
+        }
+
+        for (size_t i = 1; i < block_size; ++i) {
+
+            for (size_t lane = 0; lane < reduceLanes; ++lane) {
+
+                lanes[lane] = operation(move(lanes[lane]), values[lane * block_size + i]);
+            }
+        }
+
+        for (size_t lane = 0; lane < reduceLanes; ++lane) {
+
+            initial = operation(move(initial), move(lanes[lane]));
+
+            lanes[lane].~T();
+        }
+
+        for (auto i = reduceLanes * block_size; i < size; ++i) {
+
+            initial = operation(move(initial), values[i]);
+        }
+
+        return initial;
+    }
+
+    template<typename T, typename U, typename Operation>
+    void inclusiveScanRange(T* input, U* output, size_t size, Operation& operation) {
+
+        if (size == 0) {
+
+            return;
+        }
+
+        output[0] = input[0];
+
+        for (size_t i = 1; i < size; ++i) {
+
+            output[i] = operation(output[i - 1], input[i]);
+        }
+    }
+
+    template<typename T, typename LessThan>
+    size_t upperBound(T const* values, size_t size, T const& value, LessThan& less) {
+
+        size_t low = 0;
+
+        size_t high = size;
+
+        while (low < high) {
+
+            auto middle = low + (high - low) / 2;
+
+            if (less(value, values[middle])) {
+
+                high = middle;
+            }
+            else {
+
+                low = middle + 1;
+            }
+        }
+
+        return low;
+    }
+
+    // One independent piece of a merge of two sorted runs: [a_begin, a_end) and [b_begin, b_end) of the source go,
+    // merged, to the destination from `out` on.
+
+    struct MergePiece {
+
+        size_t a_begin;
+        size_t a_end;
+        size_t b_begin;
+        size_t b_end;
+        size_t out;
+    };
+
+    // How many of the first `count` values of the merge of the sorted runs `a` and `b` come from `a`, the rest
+    // coming from `b`. Values of `a` go before equal ones of `b`, which keeps the merge stable.
+
+    template<typename T, typename LessThan>
+    size_t coRank(T const* a, size_t a_size, T const* b, size_t b_size, size_t count, LessThan& less) {
+
+        size_t low = count > b_size ? count - b_size : 0;
+
+        size_t high = min(count, a_size);
+
+        // The answer is the smallest i for which a[i] goes after b[count - i - 1].
+
+        while (low < high) {
+
+            auto i = low + (high - low) / 2;
+
+            if (less(b[count - i - 1], a[i])) {
+
+                high = i;
+            }
+            else {
+
+                low = i + 1;
+            }
+        }
+
+        return low;
+    }
+
+    // Cuts the merge of [a_begin, a_end) and [a_end, b_end) of the source into pieces of `piece_size` output
+    // values (the last one fewer), each found on its own by co-ranking where it starts. `pieces` must have room for
+    // all of them.
+
+    template<typename T, typename LessThan>
+    void splitMerge(T const* source, size_t a_begin, size_t a_end, size_t b_end, size_t piece_size, Vector<MergePiece>& pieces, LessThan& less) {
+
+        auto a_size = a_end - a_begin;
+
+        auto b_size = b_end - a_end;
+
+        size_t a_split = a_begin;
+
+        size_t b_split = a_end;
+
+        for (auto out = a_begin; out < b_end; out += piece_size) {
+
+            auto count = min(out + piece_size, b_end) - a_begin;
+
+            auto next_a_split = a_begin + coRank(source + a_begin, a_size, source + a_end, b_size, count, less);
+
+            auto next_b_split = a_end + (count - (next_a_split - a_begin));
+
+            pieces.uncheckedAppend({ a_split, next_a_split, b_split, next_b_split, out });
+
+            a_split = next_a_split;
+
+            b_split = next_b_split;
+        }
+    }
+
+    // Moves the merged piece into `destination`, constructing the values there if it holds none yet.
+
+    template<typename T, typename LessThan>
+    void mergePiece(T* source, T* destination, MergePiece const& piece, bool construct, LessThan& less) {
+
+        auto put = [&](size_t& out, T& value) {
+
+            if (construct) {
+
+                new (&destination[out++]) T(move(value));
+            }
+            else {
+
+                destination[out++] = move(value);
+            }
+        };
+
+        auto a = piece.a_begin;
+
+        auto b = piece.b_begin;
+
+        auto out = piece.out;
+
+        while (a < piece.a_end && b < piece.b_end) {
+
+            if (less(source[b], source[a])) {
+
+                put(out, source[b++]);
+            }
+            else {
+
+                put(out, source[a++]);
+            }
+        }
+
+        while (a < piece.a_end) {
+
+            put(out, source[a++]);
+        }
+
+        while (b < piece.b_end) {
+
+            put(out, source[b++]);
+        }
+    }
+
+    // Parallel merge sort: chunks sorted on their own, then merged pairwise, pass after pass, each merge cut into
+    // pieces so that the last passes, with only a couple of merges left, still use every thread. Only moves values,
+    // and is stable when the chunks are sorted stably.
+
+    template<bool Stable, typename T, typename LessThan>
+    ErrorOr<void> parallelMergeSort(ThreadPool& pool, ::Span<T> values, LessThan& less) {
+
+        auto size = values.size();
+
+        auto* data = values.data();
+
+        auto chunks = chunksFor(pool, size);
+
+        TRY(forEachChunk(pool, chunks, [&](size_t, size_t begin, size_t end) -> ErrorOr<void> {
+
+            if constexpr (Stable) {
+
+                return stableSort(::Span<T>(data + begin, end - begin), less);
+            }
+            else {
+
+                sort(::Span<T>(data + begin, end - begin), less);
+
+                return { };
+            }
+        }));
+
+        Vector<size_t> runs;
+
+        TRY(runs.tryEnsureCapacity(chunks.count + 1));
+
+        for (size_t chunk = 0; chunk <= chunks.count; ++chunk) {
+
+            runs.uncheckedAppend(chunks.begin(chunk));
+        }
+
+        auto buffer = TRY(UninitializedBuffer<T>::create(size));
+
+        auto piece_size = max(parallelGrain, size / ((pool.workerCount() + 1) * 4));
+
+        auto* source = data;
+
+        auto* destination = buffer.data();
+
+        bool buffer_constructed = false;
+
+        // A pass has at most (chunks.count + 1) / 2 merges, each cut into at most one piece more than its size
+        // over `piece_size`.
+
+        Vector<MergePiece> pieces;
+
+        TRY(pieces.tryEnsureCapacity(size / piece_size + chunks.count + 1));
+
+        Vector<size_t> merged_runs;
+
+        TRY(merged_runs.tryEnsureCapacity(chunks.count + 1));
+
+        // Past this point the values are spread over both buffers, so nothing may fail.
+
+        while (runs.size() > 2) {
+
+            pieces.clearWithCapacity();
+
+            merged_runs.clearWithCapacity();
+
+            for (size_t run = 0; run + 1 < runs.size(); run += 2) {
+
+                merged_runs.uncheckedAppend(runs[run]);
+
+                auto a_end = runs[run + 1];
+
+                auto b_end = run + 2 < runs.size() ? runs[run + 2] : a_end;
+
+                splitMerge(source, runs[run], a_end, b_end, piece_size, pieces, less);
+            }
+
+            merged_runs.uncheckedAppend(size);
+
+            parallelForAll(pool, 0, pieces.size(), 1, [&](size_t first, size_t last) {
+
+                for (auto i = first; i < last; ++i) {
+
+                    mergePiece(source, destination, pieces[i], !buffer_constructed && destination == buffer.data(), less);
+                }
+            });
+
+            buffer_constructed = true;
+
+            swap(source, destination);
+
+            swap(runs, merged_runs);
+        }
+
+        if (!buffer_constructed) {
+
+            return { };
+        }
+
+        auto* buffer_values = buffer.data();
+
+        parallelForAll(pool, 0, size, parallelGrain, [&](size_t begin, size_t end) {
+
+            for (auto i = begin; i < end; ++i) {
+
+                if (source != data) {
+
+                    data[i] = move(buffer_values[i]);
+                }
+
+                buffer_values[i].~T();
+            }
+        });
+
+        return { };
+    }
+
+    // Parallel sample sort: splitters picked from a sorted sample cut the values into buckets of about equal size,
+    // every chunk moves its values to their buckets in a second buffer, and the buckets are sorted independently.
+    // Each value is moved twice, against about log2(chunks) times for the merge sort, but splitters are copies, so
+    // this is only for copyable values.
+
+    template<typename T, typename LessThan>
+    ErrorOr<void> parallelSampleSort(ThreadPool& pool, ::Span<T> values, LessThan& less) {
+
+        static constexpr size_t oversampling = 32;
+
+        auto size = values.size();
+
+        auto* data = values.data();
+
+        auto chunks = chunksFor(pool, size);
+
+        // Bucket numbers are kept in a byte per value.
+
+        auto bucket_count = min(static_cast<size_t>(NumericLimits<UInt8>::max()) + 1, (pool.workerCount() + 1) * 4);
+
+        bucket_count = max(min(bucket_count, size / parallelGrain), static_cast<size_t>(2));
+
+        Vector<T> samples;
+
+        TRY(samples.tryEnsureCapacity(bucket_count * oversampling));
+
+        auto stride = size / (bucket_count * oversampling);
+
+        UInt64 random_state = 0x9e3779b97f4a7c15 ^ size;
+
+        for (size_t i = 0; i < bucket_count * oversampling; ++i) {
+
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;
+
+            samples.uncheckedAppend(data[i * stride + random_state % stride]);
+        }
+
+        sort(samples.span(), less);
+
+        Vector<T> splitters;
+
+        TRY(splitters.tryEnsureCapacity(bucket_count - 1));
+
+        for (size_t bucket = 1; bucket < bucket_count; ++bucket) {
+
+            splitters.uncheckedAppend(samples[bucket * oversampling]);
+        }
+
+        Vector<UInt8> buckets;
+
+        TRY(buckets.try_resize(size));
+
+        Vector<size_t> offsets;
+
+        TRY(offsets.try_resize(chunks.count * bucket_count));
+
+        TRY(forEachChunk(pool, chunks, [&](size_t chunk, size_t begin, size_t end) -> ErrorOr<void> {
+
+            auto* counts = offsets.data() + chunk * bucket_count;
+
+            for (auto i = begin; i < end; ++i) {
+
+                auto bucket = upperBound(splitters.data(), splitters.size(), data[i], less);
+
+                buckets[i] = static_cast<UInt8>(bucket);
+
+                ++counts[bucket];
+            }
+
+            return { };
+        }));
+
+        // Counts become where each chunk's values for each bucket start: buckets in order, chunks in order within.
+
+        Vector<size_t> bucket_begins;
+
+        TRY(bucket_begins.tryEnsureCapacity(bucket_count + 1));
+
+        size_t running = 0;
+
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+
+            bucket_begins.uncheckedAppend(running);
+
+            for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+
+                auto count = offsets[chunk * bucket_count + bucket];
+
+                offsets[chunk * bucket_count + bucket] = running;
+
+                running += count;
+            }
+        }
+
+        bucket_begins.uncheckedAppend(size);
+
+        auto buffer = TRY(UninitializedBuffer<T>::create(size));
+
+        auto* sorted = buffer.data();
+
+        // Past this point the values are spread over both buffers, so nothing may fail.
+
+        forAllChunks(pool, chunks, [&](size_t chunk, size_t begin, size_t end) {
+
+            auto* next = offsets.data() + chunk * bucket_count;
+
+            for (auto i = begin; i < end; ++i) {
+
+                new (&sorted[next[buckets[i]]++]) T(move(data[i]));
+            }
+        });
+
+        parallelForAll(pool, 0, bucket_count, 1, [&](size_t first, size_t last) {
+
+            for (auto bucket = first; bucket < last; ++bucket) {
+
+                sort(::Span<T>(sorted + bucket_begins[bucket], bucket_begins[bucket + 1] - bucket_begins[bucket]), less);
+            }
+        });
+
+        parallelForAll(pool, 0, size, parallelGrain, [&](size_t begin, size_t end) {
+
+            for (auto i = begin; i < end; ++i) {
+
+                data[i] = move(sorted[i]);
+
+                sorted[i].~T();
+            }
+        });
+
+        return { };
+    }
+}
+
+template<typename T, typename LessThan>
+ErrorOr<void> sort(ExecutionPolicy policy, Span<T> values, LessThan less) {
+
+    auto* pool = policy.poolFor(values.size(), Detail::parallelSortThreshold);
+
+    if (!pool) {
+
+        sort(values, less);
+
+        return { };
+    }
+
+    if constexpr (IsCopyConstructible<T>) {
+
+        return Detail::parallelSampleSort(*pool, values, less);
+    }
+    else {
+
+        return Detail::parallelMergeSort<false>(*pool, values, less);
+    }
+}
+
+template<typename T>
+ErrorOr<void> sort(ExecutionPolicy policy, Span<T> values) {
+
+    return sort(policy, values, [](T const& a, T const& b) { return a < b; });
+}
+
+template<typename T, typename LessThan>
+ErrorOr<void> stableSort(ExecutionPolicy policy, Span<T> values, LessThan less) {
+
+    auto* pool = policy.poolFor(values.size(), Detail::parallelSortThreshold);
+
+    if (!pool) {
+
+        return stableSort(values, less);
+    }
+
+    return Detail::parallelMergeSort<true>(*pool, values, less);
+}
+
+template<typename T>
+ErrorOr<void> stableSort(ExecutionPolicy policy, Span<T> values) {
+
+    return stableSort(policy, values, [](T const& a, T const& b) { return a < b; });
+}
+
+// output[i] = function(input[i]). The two may be the same span, but must not overlap otherwise.
+
+template<typename T, typename U, typename Function>
+ErrorOr<void> transform(ExecutionPolicy policy, Span<T> input, Span<U> output, Function function) {
+
+    VERIFY(output.size() == input.size());
+
+    auto size = input.size();
+
+    auto* pool = policy.poolFor(size, Detail::parallelGrain * 2);
+
+    if (!pool) {
+
+        Detail::transformRange(policy, input.data(), output.data(), size, function);
+
+        return { };
+    }
+
+    return parallelFor(*pool, 0, size, Detail::parallelGrain, [&](size_t begin, size_t end) -> ErrorOr<void> {
+
+        Detail::transformRange(policy, input.data() + begin, output.data() + begin, end - begin, function);
+
+        return { };
+    });
+}
+
+// Folds the values into `initial` with operation(accumulated, value).
+
+template<typename T, typename Operation>
+ErrorOr<RemoveConst<T>> reduce(ExecutionPolicy policy, Span<T> values, RemoveConst<T> initial, Operation operation) {
+
+    using ValueType = RemoveConst<T>;
+
+    auto size = values.size();
+
+    auto* pool = policy.poolFor(size, Detail::parallelGrain * 2);
+
+    if (!pool) {
+
+        return Detail::reduceRange<ValueType>(policy, values.data(), size, move(initial), operation);
+    }
+
+    // Each chunk starts from its own first value; the partial results are folded in chunk order, so the outcome
+    // does not depend on which thread finished first.
+
+    auto chunks = Detail::chunksFor(*pool, size);
+
+    Vector<Optional<ValueType>> partials;
+
+    TRY(partials.try_resize(chunks.count));
+
+    TRY(Detail::forEachChunk(*pool, chunks, [&](size_t chunk, size_t begin, size_t end) -> ErrorOr<void> {
+
+        partials[chunk] = Detail::reduceRange<ValueType>(policy, values.data() + begin + 1, end - begin - 1, values[begin], operation);
+
+        return { };
+    }));
+
+    for (auto& partial : partials) {
+
+        initial = operation(move(initial), partial.releaseValue());
+    }
+
+    return initial;
+}
+
+// output[i] = input[0] op input[1] op ... op input[i]. The two may be the same span, but must not overlap otherwise.
+
+template<typename T, typename U, typename Operation>
+ErrorOr<void> inclusiveScan(ExecutionPolicy policy, Span<T> input, Span<U> output, Operation operation) {
+
+    VERIFY(output.size() == input.size());
+
+    auto size = input.size();
+
+    auto* pool = policy.poolFor(size, Detail::parallelGrain * 2);
+
+    if (!pool) {
+
+        Detail::inclusiveScanRange(input.data(), output.data(), size, operation);
+
+        return { };
+    }
+
+    // Scan every chunk on its own, work out what comes before each chunk from the chunks' totals, then fold that
+    // into every chunk but the first.
+
+    auto chunks = Detail::chunksFor(*pool, size);
+
+    TRY(Detail::forEachChunk(*pool, chunks, [&](size_t, size_t begin, size_t end) -> ErrorOr<void> {
+
+        Detail::inclusiveScanRange(input.data() + begin, output.data() + begin, end - begin, operation);
+
+        return { };
+    }));
+
+    Vector<Optional<U>> carries;
+
+    TRY(carries.try_resize(chunks.count));
+
+    for (size_t chunk = 1; chunk < chunks.count; ++chunk) {
+
+        auto const& chunk_total = output[chunks.end(chunk - 1) - 1];
+
+        carries[chunk] = chunk == 1 ? chunk_total : operation(*carries[chunk - 1], chunk_total);
+    }
+
+    return Detail::forEachChunk(*pool, chunks, [&](size_t chunk, size_t begin, size_t end) -> ErrorOr<void> {
+
+        if (chunk == 0) {
+
+            return { };
+        }
+
+        auto const& carry = *carries[chunk];
+
+        auto* values = output.data();
+
+        for (auto i = begin; i < end; ++i) {
+
+            values[i] = operation(carry, values[i]);
+        }
+
+        return { };
+    });
+}
+
+// Copies the values the predicate accepts, in order.
+
+template<typename T, typename Predicate>
+ErrorOr<Vector<RemoveConst<T>>> filter(ExecutionPolicy policy, Span<T> values, Predicate predicate) {
+
+    using ValueType = RemoveConst<T>;
+
+    auto size = values.size();
+
+    auto* pool = policy.poolFor(size, Detail::parallelGrain * 2);
+
+    Vector<ValueType> result;
+
+    if (!pool) {
+
+        for (auto const& value : values) {
+
+            if (predicate(value)) {
+
+                TRY(result.tryAppend(value));
+            }
+        }
+
+        return result;
+    }
+
+    auto chunks = Detail::chunksFor(*pool, size);
+
+    Vector<Vector<ValueType>> accepted;
+
+    TRY(accepted.try_resize(chunks.count));
+
+    TRY(Detail::forEachChunk(*pool, chunks, [&](size_t chunk, size_t begin, size_t end) -> ErrorOr<void> {
+
+        for (auto i = begin; i < end; ++i) {
+
+            if (predicate(values[i])) {
+
+                TRY(accepted[chunk].tryAppend(values[i]));
+            }
+        }
+
+        return { };
+    }));
+
+    size_t total = 0;
+
+    for (auto const& chunk : accepted) {
+
+        total += chunk.size();
+    }
+
+    TRY(result.tryEnsureCapacity(total));
+
+    for (auto& chunk : accepted) {
+
+        TRY(result.try_extend(move(chunk)));
+    }
+
+    return result;
+}
+
+// Moves the values the predicate accepts in front of the others, and returns how many there are. Sequentially the
+// order within each side is not kept; in parallel it is, at the cost of moving every value out and back once.
+
+template<typename T, typename Predicate>
+ErrorOr<size_t> partition(ExecutionPolicy policy, Span<T> values, Predicate predicate) {
+
+    auto size = values.size();
+
+    auto* data = values.data();
+
+    auto* pool = policy.poolFor(size, Detail::parallelGrain * 2);
+
+    if (!pool) {
+
+        size_t first = 0;
+
+        size_t last = size;
+
+        while (true) {
+
+            while (first < last && predicate(data[first])) {
+
+                ++first;
+            }
+
+            while (first < last && !predicate(data[last - 1])) {
+
+                --last;
+            }
+
+            if (first >= last) {
+
+                return first;
+            }
+
+            swap(data[first++], data[--last]);
+        }
+    }
+
+    auto chunks = Detail::chunksFor(*pool, size);
+
+    Vector<UInt8> accepted;
+
+    TRY(accepted.try_resize(size));
+
+    Vector<size_t> offsets;
+
+    TRY(offsets.try_resize(chunks.count * 2));
+
+    TRY(Detail::forEachChunk(*pool, chunks, [&](size_t chunk, size_t begin, size_t end) -> ErrorOr<void> {
+
+        size_t count = 0;
+
+        for (auto i = begin; i < end; ++i) {
+
+            accepted[i] = predicate(data[i]);
+
+            count += accepted[i];
+        }
+
+        offsets[chunk * 2] = count;
+
+        offsets[chunk * 2 + 1] = (end - begin) - count;
+
+        return { };
+    }));
+
+    size_t accepted_total = 0;
+
+    for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+
+        accepted_total += offsets[chunk * 2];
+    }
+
+    size_t next_accepted = 0;
+
+    size_t next_rejected = accepted_total;
+
+    for (size_t chunk = 0; chunk < chunks.count; ++chunk) {
+
+        auto accepted_count = exchange(offsets[chunk * 2], next_accepted);
+
+        auto rejected_count = exchange(offsets[chunk * 2 + 1], next_rejected);
+
+        next_accepted += accepted_count;
+
+        next_rejected += rejected_count;
+    }
+
+    auto buffer = TRY(Detail::UninitializedBuffer<T>::create(size));
+
+    auto* moved = buffer.data();
+
+    // Past this point the values are spread over both buffers, so nothing may fail.
+
+    Detail::forAllChunks(*pool, chunks, [&](size_t chunk, size_t begin, size_t end) {
+
+        auto next_accepted = offsets[chunk * 2];
+
+        auto next_rejected = offsets[chunk * 2 + 1];
+
+        for (auto i = begin; i < end; ++i) {
+
+            new (&moved[accepted[i] ? next_accepted++ : next_rejected++]) T(move(data[i]));
+        }
+    });
+
+    Detail::parallelForAll(*pool, 0, size, Detail::parallelGrain, [&](size_t begin, size_t end) {
+
+        for (auto i = begin; i < end; ++i) {
+
+            data[i] = move(moved[i]);
+
+            moved[i].~T();
+        }
+    });
+
+    return accepted_total;
+}
+
+// The same over containers, through their span(): Vector<T>, Array<T>, ArraySlice<T> and the like.
+
+template<Detail::HasSpan Container>
+ErrorOr<void> sort(ExecutionPolicy policy, Container& container) { return sort(policy, container.span()); }
+
+template<Detail::HasSpan Container, typename LessThan>
+ErrorOr<void> sort(ExecutionPolicy policy, Container& container, LessThan less) { return sort(policy, container.span(), move(less)); }
+
+template<Detail::HasSpan Container>
+ErrorOr<void> stableSort(ExecutionPolicy policy, Container& container) { return stableSort(policy, container.span()); }
+
+template<Detail::HasSpan Container, typename LessThan>
+ErrorOr<void> stableSort(ExecutionPolicy policy, Container& container, LessThan less) { return stableSort(policy, container.span(), move(less)); }
+
+template<Detail::HasSpan Input, Detail::HasSpan Output, typename Function>
+ErrorOr<void> transform(ExecutionPolicy policy, Input& input, Output& output, Function function) { return transform(policy, input.span(), output.span(), move(function)); }
+
+template<Detail::HasSpan Container, typename Operation>
+auto reduce(ExecutionPolicy policy, Container& container, auto initial, Operation operation) { return reduce(policy, container.span(), move(initial), move(operation)); }
+
+template<Detail::HasSpan Input, Detail::HasSpan Output, typename Operation>
+ErrorOr<void> inclusiveScan(ExecutionPolicy policy, Input& input, Output& output, Operation operation) { return inclusiveScan(policy, input.span(), output.span(), move(operation)); }
+
+template<Detail::HasSpan Container, typename Predicate>
+auto filter(ExecutionPolicy policy, Container& container, Predicate predicate) { return filter(policy, container.span(), move(predicate)); }
+
+template<Detail::HasSpan Container, typename Predicate>
+ErrorOr<size_t> partition(ExecutionPolicy policy, Container& container, Predicate predicate) { return partition(policy, container.span(), move(predicate)); }
+
+#undef VECTORIZABLE_LOOP
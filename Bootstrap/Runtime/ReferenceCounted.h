@@ -12,7 +12,8 @@
 
 #    include "Assertions.h"
 #    include "Checked.h"
-#    include "NonCopyable.h"
+#    include "Debug.h"
+#    include "Noncopyable.h"
 #    include "Platform.h"
 #    include "StdLibExtras.h"
 
@@ -27,10 +28,13 @@ public:
 
     ALWAYS_INLINE void ref() const {
 
-        VERIFY(m_refCount > 0);
-        
-        VERIFY(!Checked<RefCountType>::additionWouldOverflow(m_refCount, 1));
-        
+        if constexpr (REFERENCE_COUNT_DEBUG) {
+
+            VERIFY(m_refCount > 0);
+
+            VERIFY(!Checked<RefCountType>::additionWouldOverflow(m_refCount, 1));
+        }
+
         ++m_refCount;
     }
 
@@ -52,13 +56,22 @@ protected:
 
     ReferenceCountedBase() = default;
 
-    ~ReferenceCountedBase() { VERIFY(!m_refCount); }
+    ~ReferenceCountedBase() {
 
-    ALWAYS_INLINE RefCountType deref_base() const {
+        if constexpr (REFERENCE_COUNT_DEBUG) {
 
-        VERIFY(m_refCount);
-        
-        return --m_refCount;
+            VERIFY(!m_refCount);
+        }
+    }
+
+    ALWAYS_INLINE RefCountType deref_base(RefCountType count = 1) const {
+
+        if constexpr (REFERENCE_COUNT_DEBUG) {
+
+            VERIFY(m_refCount >= count);
+        }
+
+        return m_refCount -= count;
     }
 
     RefCountType mutable m_refCount { 1 };
@@ -69,11 +82,14 @@ class ReferenceCounted : public ReferenceCountedBase {
 
 public:
 
-    bool dereference() const {
+    // Drops `count` references at once, which DeferredDereferenceBuffer uses to settle repeated releases of the
+    // same object.
+
+    bool dereference(RefCountType count = 1) const {
 
         auto* that = const_cast<T*>(static_cast<T const*>(this));
 
-        auto new_ref_count = deref_base();
+        auto new_ref_count = deref_base(count);
         
         if (new_ref_count == 0) {
             
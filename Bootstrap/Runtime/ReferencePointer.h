@@ -331,6 +331,8 @@ struct Traits<ReferencePointer<T>> : public GenericTraits<ReferencePointer<T>> {
     static unsigned hash(ReferencePointer<T> const& p) { return pointerHash(p.pointer()); }
     
     static bool equals(ReferencePointer<T> const& a, ReferencePointer<T> const& b) { return a.pointer() == b.pointer(); }
+
+    static constexpr bool isTriviallyRelocatable() { return true; }
 };
 
 template<typename T, typename U>
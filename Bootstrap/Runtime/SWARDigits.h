@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Platform.h"
+#include "Types.h"
+
+// Eight ASCII decimal digits handled at once inside a 64-bit word (SIMD within a register). Words are loaded so
+// that the first character sits in the lowest byte whatever the host byte order.
+
+ALWAYS_INLINE UInt64 loadEightCharacters(char const* characters) {
+
+    UInt64 word;
+
+    __builtin_memcpy(&word, characters, sizeof(word));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+
+    return word;
+}
+
+ALWAYS_INLINE constexpr bool areEightAsciiDigits(UInt64 word) {
+
+    return (((word + 0x4646464646464646) | (word - 0x3030303030303030)) & 0x8080808080808080) == 0;
+}
+
+// The value of eight ASCII digits, first digit in the lowest byte, in three multiplications.
+ALWAYS_INLINE constexpr UInt32 parseEightAsciiDigits(UInt64 word) {
+
+    constexpr UInt64 mask = 0x000000ff000000ff;
+    constexpr UInt64 mul1 = 0x000f424000000064; // 100 + (1000000 << 32)
+    constexpr UInt64 mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+
+    word -= 0x3030303030303030;
+    word = (word * 10) + (word >> 8);
+    word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+
+    return static_cast<UInt32>(word);
+}
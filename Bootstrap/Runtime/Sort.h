@@ -0,0 +1,616 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Assertions.h"
+#include "Checked.h"
+#include "Error.h"
+#include "Noncopyable.h"
+#include "Span.h"
+#include "StdLibExtras.h"
+#include "Types.h"
+#include "kmalloc.h"
+
+// Sequential sorting. sort() is pattern-defeating quicksort (Orson Peters): quicksort with insertion sort for short
+// and nearly sorted ranges, pivots shuffled whenever a partition comes out lopsided, and heapsort as the fallback
+// that keeps the worst case at O(n log n). It is not stable. stableSort() is a merge sort over insertion-sorted runs
+// that needs room for half the elements on the side.
+//
+// The comparison is a strict weak ordering, `a < b` unless one is given.
+
+namespace Detail {
+
+    static constexpr size_t insertionSortThreshold = 24;
+
+    static constexpr size_t nintherThreshold = 128;
+
+    static constexpr size_t partialInsertionSortLimit = 8;
+
+    static constexpr size_t stableSortRunLength = 32;
+
+    // Memory for `capacity` values that the owner constructs and destroys itself; only the memory is released here.
+
+    template<typename T>
+    class UninitializedBuffer {
+
+        MAKE_NONCOPYABLE(UninitializedBuffer);
+
+    public:
+
+        static ErrorOr<UninitializedBuffer> create(size_t capacity) {
+
+            if (Checked<size_t>::multiplicationWouldOverflow(capacity, sizeof(T))) {
+
+                return Error::fromErrorCode(EOVERFLOW);
+            }
+
+            auto* data = static_cast<T*>(kmalloc(max(capacity, static_cast<size_t>(1)) * sizeof(T)));
+
+            if (!data) {
+
+                return Error::fromErrorCode(ENOMEM);
+            }
+
+            return UninitializedBuffer(data, capacity);
+        }
+
+        UninitializedBuffer(UninitializedBuffer&& other)
+            : m_data(exchange(other.m_data, nullptr)),
+              m_capacity(exchange(other.m_capacity, 0)) { }
+
+        ~UninitializedBuffer() {
+
+            if (m_data) {
+
+                kfree_sized(m_data, max(m_capacity, static_cast<size_t>(1)) * sizeof(T));
+            }
+        }
+
+        T* data() { return m_data; }
+
+        size_t capacity() const { return m_capacity; }
+
+    private:
+
+        UninitializedBuffer(T* data, size_t capacity)
+            : m_data(data),
+              m_capacity(capacity) { }
+
+        T* m_data { nullptr };
+
+        size_t m_capacity { 0 };
+    };
+
+    template<typename T, typename LessThan>
+    void insertionSort(T* begin, T* end, LessThan& less) {
+
+        if (begin == end) {
+
+            return;
+        }
+
+        for (auto* current = begin + 1; current != end; ++current) {
+
+            auto* sift = current;
+
+            auto* previous = current - 1;
+
+            if (less(*sift, *previous)) {
+
+                T value = move(*sift);
+
+                do {
+
+                    *sift-- = move(*previous);
+                }
+                while (sift != begin && less(value, *--previous));
+
+                *sift = move(value);
+            }
+        }
+    }
+
+    // For ranges that are not leftmost: the element just before `begin` is no greater than any in the range, so it
+    // stops every sift without a bounds check.
+
+    template<typename T, typename LessThan>
+    void unguardedInsertionSort(T* begin, T* end, LessThan& less) {
+
+        if (begin == end) {
+
+            return;
+        }
+
+        for (auto* current = begin + 1; current != end; ++current) {
+
+            auto* sift = current;
+
+            auto* previous = current - 1;
+
+            if (less(*sift, *previous)) {
+
+                T value = move(*sift);
+
+                do {
+
+                    *sift-- = move(*previous);
+                }
+                while (less(value, *--previous));
+
+                *sift = move(value);
+            }
+        }
+    }
+
+    // Insertion sort that gives up once it has moved more than a few elements. Returns whether the range got sorted.
+
+    template<typename T, typename LessThan>
+    bool partialInsertionSort(T* begin, T* end, LessThan& less) {
+
+        if (begin == end) {
+
+            return true;
+        }
+
+        size_t moved = 0;
+
+        for (auto* current = begin + 1; current != end; ++current) {
+
+            auto* sift = current;
+
+            auto* previous = current - 1;
+
+            if (less(*sift, *previous)) {
+
+                T value = move(*sift);
+
+                do {
+
+                    *sift-- = move(*previous);
+                }
+                while (sift != begin && less(value, *--previous));
+
+                *sift = move(value);
+
+                moved += current - sift;
+            }
+
+            if (moved > partialInsertionSortLimit) {
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<typename T, typename LessThan>
+    void sort2(T* a, T* b, LessThan& less) {
+
+        if (less(*b, *a)) {
+
+            swap(*a, *b);
+        }
+    }
+
+    template<typename T, typename LessThan>
+    void sort3(T* a, T* b, T* c, LessThan& less) {
+
+        sort2(a, b, less);
+        sort2(b, c, less);
+        sort2(a, b, less);
+    }
+
+    template<typename T, typename LessThan>
+    void siftDown(T* heap, size_t size, size_t index, LessThan& less) {
+
+        T value = move(heap[index]);
+
+        while (true) {
+
+            auto child = index * 2 + 1;
+
+            if (child >= size) {
+
+                break;
+            }
+
+            if (child + 1 < size && less(heap[child], heap[child + 1])) {
+
+                ++child;
+            }
+
+            if (!less(value, heap[child])) {
+
+                break;
+            }
+
+            heap[index] = move(heap[child]);
+
+            index = child;
+        }
+
+        heap[index] = move(value);
+    }
+
+    template<typename T, typename LessThan>
+    void heapSort(T* begin, T* end, LessThan& less) {
+
+        size_t size = end - begin;
+
+        for (size_t i = size / 2; i-- > 0;) {
+
+            siftDown(begin, size, i, less);
+        }
+
+        for (size_t i = size; i-- > 1;) {
+
+            swap(begin[0], begin[i]);
+
+            siftDown(begin, i, 0, less);
+        }
+    }
+
+    template<typename T>
+    struct PartitionResult {
+
+        T* pivot;
+
+        bool was_partitioned;
+    };
+
+    // Partitions around the pivot at *begin into [begin, pivot) < pivot <= [pivot + 1, end), and tells whether no
+    // element had to be swapped. Pivot selection leaves an element >= the pivot at the end, which stops the scans.
+
+    template<typename T, typename LessThan>
+    PartitionResult<T> partitionRight(T* begin, T* end, LessThan& less) {
+
+        T pivot = move(*begin);
+
+        auto* first = begin;
+
+        auto* last = end;
+
+        while (less(*++first, pivot)) { }
+
+        if (first - 1 == begin) {
+
+            while (first < last && !less(*--last, pivot)) { }
+        }
+        else {
+
+            while (!less(*--last, pivot)) { }
+        }
+
+        bool was_partitioned = first >= last;
+
+        while (first < last) {
+
+            swap(*first, *last);
+
+            while (less(*++first, pivot)) { }
+
+            while (!less(*--last, pivot)) { }
+        }
+
+        auto* pivot_position = first - 1;
+
+        *begin = move(*pivot_position);
+
+        *pivot_position = move(pivot);
+
+        return { pivot_position, was_partitioned };
+    }
+
+    // Puts everything equal to the pivot at *begin on the left: used when the element before the range equals the
+    // pivot, so that a run of equal elements is dealt with in one pass instead of being partitioned over and over.
+
+    template<typename T, typename LessThan>
+    T* partitionLeft(T* begin, T* end, LessThan& less) {
+
+        T pivot = move(*begin);
+
+        auto* first = begin;
+
+        auto* last = end;
+
+        while (less(pivot, *--last)) { }
+
+        if (last + 1 == end) {
+
+            while (first < last && !less(pivot, *++first)) { }
+        }
+        else {
+
+            while (!less(pivot, *++first)) { }
+        }
+
+        while (first < last) {
+
+            swap(*first, *last);
+
+            while (less(pivot, *--last)) { }
+
+            while (!less(pivot, *++first)) { }
+        }
+
+        auto* pivot_position = last;
+
+        *begin = move(*pivot_position);
+
+        *pivot_position = move(pivot);
+
+        return pivot_position;
+    }
+
+    template<typename T, typename LessThan>
+    void pdqsortLoop(T* begin, T* end, LessThan& less, int bad_allowed, bool leftmost) {
+
+        while (true) {
+
+            size_t size = end - begin;
+
+            if (size < insertionSortThreshold) {
+
+                if (leftmost) {
+
+                    insertionSort(begin, end, less);
+                }
+                else {
+
+                    unguardedInsertionSort(begin, end, less);
+                }
+
+                return;
+            }
+
+            // The pivot goes to *begin: the median of three, or for longer ranges Tukey's ninther.
+
+            auto half = size / 2;
+
+            if (size > nintherThreshold) {
+
+                sort3(begin, begin + half, end - 1, less);
+                sort3(begin + 1, begin + (half - 1), end - 2, less);
+                sort3(begin + 2, begin + (half + 1), end - 3, less);
+                sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+
+                swap(*begin, *(begin + half));
+            }
+            else {
+
+                sort3(begin + half, begin, end - 1, less);
+            }
+
+            if (!leftmost && !less(*(begin - 1), *begin)) {
+
+                begin = partitionLeft(begin, end, less) + 1;
+
+                continue;
+            }
+
+            auto [pivot, was_partitioned] = partitionRight(begin, end, less);
+
+            size_t left_size = pivot - begin;
+
+            size_t right_size = end - (pivot + 1);
+
+            if (left_size < size / 8 || right_size < size / 8) {
+
+                if (--bad_allowed == 0) {
+
+                    heapSort(begin, end, less);
+
+                    return;
+                }
+
+                // Break up whatever pattern produced the bad pivot.
+
+                if (left_size >= insertionSortThreshold) {
+
+                    swap(begin[0], begin[left_size / 4]);
+                    swap(pivot[-1], pivot[-static_cast<ssize_t>(left_size / 4)]);
+
+                    if (left_size > nintherThreshold) {
+
+                        swap(begin[1], begin[left_size / 4 + 1]);
+                        swap(begin[2], begin[left_size / 4 + 2]);
+                        swap(pivot[-2], pivot[-static_cast<ssize_t>(left_size / 4 + 1)]);
+                        swap(pivot[-3], pivot[-static_cast<ssize_t>(left_size / 4 + 2)]);
+                    }
+                }
+
+                if (right_size >= insertionSortThreshold) {
+
+                    swap(pivot[1], pivot[1 + right_size / 4]);
+                    swap(end[-1], end[-static_cast<ssize_t>(right_size / 4)]);
+
+                    if (right_size > nintherThreshold) {
+
+                        swap(pivot[2], pivot[2 + right_size / 4]);
+                        swap(pivot[3], pivot[3 + right_size / 4]);
+                        swap(end[-2], end[-static_cast<ssize_t>(1 + right_size / 4)]);
+                        swap(end[-3], end[-static_cast<ssize_t>(2 + right_size / 4)]);
+                    }
+                }
+            }
+            else if (was_partitioned && partialInsertionSort(begin, pivot, less) && partialInsertionSort(pivot + 1, end, less)) {
+
+                // Nothing had to move, and both sides turned out (nearly) sorted: likely already sorted input.
+
+                return;
+            }
+
+            pdqsortLoop(begin, pivot, less, bad_allowed, leftmost);
+
+            begin = pivot + 1;
+
+            leftmost = false;
+        }
+    }
+
+    // Merges the sorted ranges [begin, middle) and [middle, end), moving the shorter one out to `buffer` first.
+    // On ties the left range goes first.
+
+    template<typename T, typename LessThan>
+    void mergeAdjacent(T* begin, T* middle, T* end, T* buffer, LessThan& less) {
+
+        if (middle == begin || middle == end || !less(*middle, *(middle - 1))) {
+
+            return;
+        }
+
+        size_t left_size = middle - begin;
+
+        size_t right_size = end - middle;
+
+        if (left_size <= right_size) {
+
+            for (size_t i = 0; i < left_size; ++i) {
+
+                new (&buffer[i]) T(move(begin[i]));
+            }
+
+            size_t left = 0;
+
+            auto* right = middle;
+
+            auto* out = begin;
+
+            while (left < left_size && right < end) {
+
+                if (less(*right, buffer[left])) {
+
+                    *out++ = move(*right++);
+                }
+                else {
+
+                    *out++ = move(buffer[left++]);
+                }
+            }
+
+            while (left < left_size) {
+
+                *out++ = move(buffer[left++]);
+            }
+
+            for (size_t i = 0; i < left_size; ++i) {
+
+                buffer[i].~T();
+            }
+        }
+        else {
+
+            for (size_t i = 0; i < right_size; ++i) {
+
+                new (&buffer[i]) T(move(middle[i]));
+            }
+
+            // From the back, taking the right element on ties.
+
+            size_t right = right_size;
+
+            auto* left = middle;
+
+            auto* out = end;
+
+            while (right > 0 && left > begin) {
+
+                if (less(buffer[right - 1], *(left - 1))) {
+
+                    *--out = move(*--left);
+                }
+                else {
+
+                    *--out = move(buffer[--right]);
+                }
+            }
+
+            while (right > 0) {
+
+                *--out = move(buffer[--right]);
+            }
+
+            for (size_t i = 0; i < right_size; ++i) {
+
+                buffer[i].~T();
+            }
+        }
+    }
+
+    template<typename T, typename LessThan>
+    void stableSortWithBuffer(T* begin, T* end, T* buffer, LessThan& less) {
+
+        size_t size = end - begin;
+
+        for (size_t run = 0; run < size; run += stableSortRunLength) {
+
+            insertionSort(begin + run, begin + min(run + stableSortRunLength, size), less);
+        }
+
+        for (size_t width = stableSortRunLength; width < size; width *= 2) {
+
+            for (size_t low = 0; low + width < size; low += width * 2) {
+
+                mergeAdjacent(begin + low, begin + low + width, begin + min(low + width * 2, size), buffer, less);
+            }
+        }
+    }
+}
+
+template<typename T, typename LessThan>
+void sort(Span<T> values, LessThan less) {
+
+    auto size = values.size();
+
+    if (size < 2) {
+
+        return;
+    }
+
+    int bad_allowed = 0;
+
+    for (auto remaining = size; remaining > 1; remaining >>= 1) {
+
+        ++bad_allowed;
+    }
+
+    Detail::pdqsortLoop(values.data(), values.data() + size, less, bad_allowed, true);
+}
+
+template<typename T>
+void sort(Span<T> values) {
+
+    sort(values, [](T const& a, T const& b) { return a < b; });
+}
+
+// Fails only if the merge buffer cannot be allocated, in which case the values are left as they were.
+
+template<typename T, typename LessThan>
+ErrorOr<void> stableSort(Span<T> values, LessThan less) {
+
+    auto size = values.size();
+
+    if (size <= Detail::stableSortRunLength) {
+
+        Detail::insertionSort(values.data(), values.data() + size, less);
+
+        return { };
+    }
+
+    auto buffer = TRY(Detail::UninitializedBuffer<T>::create(size / 2 + 1));
+
+    Detail::stableSortWithBuffer(values.data(), values.data() + size, buffer.data(), less);
+
+    return { };
+}
+
+template<typename T>
+ErrorOr<void> stableSort(Span<T> values) {
+
+    return stableSort(values, [](T const& a, T const& b) { return a < b; });
+}
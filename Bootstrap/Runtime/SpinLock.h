@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Atomic.h"
+#include "Noncopyable.h"
+#include "Platform.h"
+
+// A lock for critical sections that last a handful of instructions, where putting a thread to sleep would cost more
+// than letting it spin. Waiters spin on a plain load so that the cache line is only written when it looks free.
+
+class SpinLock {
+
+    MAKE_NONCOPYABLE(SpinLock);
+    MAKE_NONMOVABLE(SpinLock);
+
+public:
+
+    constexpr SpinLock() = default;
+
+    ALWAYS_INLINE void lock() {
+
+        while (m_locked.exchange(true, MemoryOrder::memory_order_acquire)) {
+
+            while (m_locked.load(MemoryOrder::memory_order_relaxed)) {
+
+#if ARCH(I386) || ARCH(X86_64)
+                __builtin_ia32_pause();
+#endif
+            }
+        }
+    }
+
+    ALWAYS_INLINE void unlock() { m_locked.store(false, MemoryOrder::memory_order_release); }
+
+private:
+
+    Atomic<bool> m_locked { false };
+};
+
+class SpinLocker {
+
+    MAKE_NONCOPYABLE(SpinLocker);
+    MAKE_NONMOVABLE(SpinLocker);
+
+public:
+
+    ALWAYS_INLINE explicit SpinLocker(SpinLock& lock)
+        : m_lock(lock) {
+
+        m_lock.lock();
+    }
+
+    ALWAYS_INLINE ~SpinLocker() { m_lock.unlock(); }
+
+private:
+
+    SpinLock& m_lock;
+};
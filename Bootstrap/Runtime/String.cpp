@@ -4,17 +4,20 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "CharacterTypes.h"
 #include "Format.h"
 #include "Function.h"
 #include "Memory.h"
 #include "StdLibExtras.h"
 #include "String.h"
+#include "StringBuilder.h"
 #include "StringView.h"
 #include "Vector.h"
 
 bool String::operator==(String const& other) const
 {
-    return m_impl == other.impl() || view() == other.view();
+    auto const* impl = this->impl();
+    return (impl && impl == other.impl()) || view() == other.view();
 }
 
 bool String::operator==(StringView other) const
@@ -46,47 +49,60 @@ bool String::copy_characters_to_buffer(char* buffer, size_t buffer_size) const
 
 String String::isolated_copy() const
 {
-    if (!m_impl)
+    if (isNull())
         return {};
-    if (!m_impl->length())
+    if (isEmpty())
         return empty();
+    if (isInline())
+        return *this;
     char* buffer;
     auto impl = StringImpl::createUninitialized(length(), buffer);
-    memcpy(buffer, m_impl->characters(), m_impl->length());
+    memcpy(buffer, characters(), length());
     return String(move(*impl));
 }
 
+size_t String::chompedLength(char const* characters, size_t length)
+{
+    while (length) {
+        char last_ch = characters[length - 1];
+        if (last_ch && last_ch != '\n' && last_ch != '\r')
+            break;
+        --length;
+    }
+    return length;
+}
+
 String String::substring(size_t start, size_t length) const
 {
     if (!length)
         return String::empty();
-    VERIFY(m_impl);
+    VERIFY(!isNull());
     VERIFY(!Checked<size_t>::additionWouldOverflow(start, length));
-    VERIFY(start + length <= m_impl->length());
+    VERIFY(start + length <= this->length());
     return { characters() + start, length };
 }
 
 String String::substring(size_t start) const
 {
-    VERIFY(m_impl);
+    VERIFY(!isNull());
     VERIFY(start <= length());
     return { characters() + start, length() - start };
 }
 
 StringView String::substringView(size_t start, size_t length) const {
 
-    VERIFY(m_impl);
+    VERIFY(!isNull());
     
     VERIFY(!Checked<size_t>::additionWouldOverflow(start, length));
     
-    VERIFY(start + length <= m_impl->length());
+    VERIFY(start + length <= this->length());
     
     return { characters() + start, length };
 }
 
 StringView String::substringView(size_t start) const {
 
-    VERIFY(m_impl);
+    VERIFY(!isNull());
     
     VERIFY(start <= length());
     
@@ -186,6 +202,16 @@ template Optional<UInt32> String::to_uint(TrimWhitespace) const;
 template Optional<unsigned long> String::to_uint(TrimWhitespace) const;
 template Optional<unsigned long long> String::to_uint(TrimWhitespace) const;
 
+Optional<double> String::to_double(TrimWhitespace trim_whitespace) const
+{
+    return StringUtils::convert_to_double(view(), trim_whitespace);
+}
+
+Optional<float> String::to_float(TrimWhitespace trim_whitespace) const
+{
+    return StringUtils::convert_to_float(view(), trim_whitespace);
+}
+
 bool String::startsWith(StringView str, CaseSensitivity case_sensitivity) const {
 
     return StringUtils::startsWith(*this, str, case_sensitivity);
@@ -391,16 +417,22 @@ String escape_html_entities(StringView html)
 
 String String::to_lowercase() const
 {
-    if (!m_impl)
-        return {};
-    return m_impl->to_lowercase();
+    if (auto* impl = this->impl())
+        return impl->to_lowercase();
+    String lowercased = *this;
+    for (size_t i = 0; i < lowercased.length(); ++i)
+        lowercased.m_storage[i] = (char)toAsciiLowercase(lowercased.m_storage[i]);
+    return lowercased;
 }
 
 String String::to_uppercase() const
 {
-    if (!m_impl)
-        return {};
-    return m_impl->to_uppercase();
+    if (auto* impl = this->impl())
+        return impl->to_uppercase();
+    String uppercased = *this;
+    for (size_t i = 0; i < uppercased.length(); ++i)
+        uppercased.m_storage[i] = (char)toAsciiUppercase(uppercased.m_storage[i]);
+    return uppercased;
 }
 
 String String::to_snakecase() const
@@ -451,17 +483,62 @@ Vector<size_t> String::find_all(StringView needle) const
 }
 
 String& String::operator+=(String const& other)
+{
+    return *this += other.view();
+}
+
+String& String::operator+=(char const* other)
+{
+    return *this += StringView(other);
+}
+
+String& String::operator+=(StringView other)
 {
     if (other.isEmpty())
         return *this;
 
-    StringBuilder builder;
-    builder.append(*this);
-    builder.append(other);
-    *this = builder.toString();
+    auto old_length = length();
+    Checked<size_t> new_length = old_length;
+    new_length += other.length();
+    VERIFY(!new_length.hasOverflow());
+
+    if (new_length.value() <= inlineCapacity) {
+        if (isInline()) {
+            __builtin_memcpy(m_storage + old_length, other.charactersWithoutNullTermination(), other.length());
+            m_storage[new_length.value()] = '\0';
+            m_inline_length = static_cast<UInt8>(new_length.value());
+            return *this;
+        }
+        char buffer[inlineCapacity];
+        if (old_length)
+            __builtin_memcpy(buffer, characters(), old_length);
+        __builtin_memcpy(buffer + old_length, other.charactersWithoutNullTermination(), other.length());
+        *this = String(buffer, new_length.value());
+        return *this;
+    }
+
+    if (auto* impl = this->impl(); impl && impl->canAppendInPlace()) {
+        setImpl(StringImpl::appendInPlace(impl, other.charactersWithoutNullTermination(), other.length()));
+        return *this;
+    }
+
+    // Leave room to append more, since whoever is adding to this String is likely to keep doing so.
+    Checked<size_t> capacity = old_length;
+    capacity *= 2;
+    char* buffer;
+    auto impl = StringImpl::createUninitialized(new_length.value(), capacity.hasOverflow() ? new_length.value() : max(capacity.value(), new_length.value()), buffer);
+    __builtin_memcpy(buffer, characters(), old_length);
+    __builtin_memcpy(buffer + old_length, other.charactersWithoutNullTermination(), other.length());
+    *this = String(move(impl));
     return *this;
 }
 
+String operator+(String&& a, String const& b)
+{
+    a += b;
+    return move(a);
+}
+
 String operator+(String const& a, String const& b)
 {
     StringBuilder builder;
@@ -9,6 +9,7 @@
 #include "Format.h"
 #include "Forward.h"
 #include "ReferencePointer.h"
+#include "StringHash.h"
 #include "StringImpl.h"
 #include "StringUtils.h"
 #include "Traits.h"
@@ -17,10 +18,19 @@
 // around as a value type. It's basically the same as passing around a
 // ReferencePointer<StringImpl>, with a bit of syntactic sugar.
 //
-// Note that StringImpl is an immutable object that cannot shrink or grow.
-// Its allocation size is snugly tailored to the specific string it contains.
-// Copying a String is very efficient, since the internal StringImpl is
-// retainable and so copying only requires modifying the ref count.
+// Note that StringImpl is an immutable object that cannot shrink or grow
+// once shared. Its allocation size is snugly tailored to the specific string
+// it contains. Copying a String is very efficient, since the internal
+// StringImpl is retainable and so copying only requires modifying the ref
+// count. The one exception is operator+=: a String that is the only owner of
+// its StringImpl appends to it in place, growing it geometrically, so that
+// building a string with += in a loop takes linear time.
+//
+// Strings of up to String::inlineCapacity characters don't use a StringImpl
+// at all: they are stored (NUL-terminated) inside the String object itself,
+// so making, copying and destroying them never touches the heap. impl() is
+// null for those. As with any inline storage, a StringView into a short
+// String only stays valid while that String object stays where it is.
 //
 // There are three main ways to construct a new String:
 //
@@ -37,39 +47,63 @@ class String {
 
 public:
 
-    ~String() = default;
+    static constexpr size_t inlineCapacity = 22;
+
+    ~String() { dereferenceImpl(); }
+
+    String() { setImpl(nullptr); }
+
+    String(StringView view) { initialize(view.charactersWithoutNullTermination(), view.length(), NoChomp); }
+
+    String(String const& other) {
+
+        copyRepresentation(other);
 
-    String() = default;
+        if (auto* impl = this->impl()) {
 
-    String(StringView view)
-        : m_impl(StringImpl::create(view.charactersWithoutNullTermination(), view.length())) { }
+            impl->ref();
+        }
+    }
+
+    String(String&& other) {
 
-    String(String const& other)
-        : m_impl(const_cast<String&>(other).m_impl) { }
+        copyRepresentation(other);
 
-    String(String&& other)
-        : m_impl(move(other.m_impl)) { }
+        other.setImpl(nullptr);
+    }
 
-    String(char const* cstring, ShouldChomp shouldChomp = NoChomp)
-        : m_impl(StringImpl::create(cstring, shouldChomp)) { }
+    String(char const* cstring, ShouldChomp shouldChomp = NoChomp) {
 
-    String(char const* cstring, size_t length, ShouldChomp shouldChomp = NoChomp)
-        : m_impl(StringImpl::create(cstring, length, shouldChomp)) { }
+        initialize(cstring, cstring ? __builtin_strlen(cstring) : 0, shouldChomp);
+    }
 
-    explicit String(ReadOnlyBytes bytes, ShouldChomp shouldChomp = NoChomp)
-        : m_impl(StringImpl::create(bytes, shouldChomp)) { }
+    String(char const* cstring, size_t length, ShouldChomp shouldChomp = NoChomp) { initialize(cstring, length, shouldChomp); }
 
-    String(StringImpl const& impl)
-        : m_impl(const_cast<StringImpl&>(impl)) { }
+    explicit String(ReadOnlyBytes bytes, ShouldChomp shouldChomp = NoChomp) {
 
-    String(StringImpl const* impl)
-        : m_impl(const_cast<StringImpl*>(impl)) { }
+        initialize(reinterpret_cast<char const*>(bytes.data()), bytes.size(), shouldChomp);
+    }
 
-    String(ReferencePointer<StringImpl>&& impl)
-        : m_impl(move(impl)) { }
+    String(StringImpl const& impl) {
 
-    String(NonNullReferencePointer<StringImpl>&& impl)
-        : m_impl(move(impl)) { }
+        impl.ref();
+
+        setImpl(const_cast<StringImpl*>(&impl));
+    }
+
+    String(StringImpl const* impl) {
+
+        if (impl) {
+
+            impl->ref();
+        }
+
+        setImpl(const_cast<StringImpl*>(impl));
+    }
+
+    String(ReferencePointer<StringImpl>&& impl) { setImpl(impl.leak_ref()); }
+
+    String(NonNullReferencePointer<StringImpl>&& impl) { setImpl(&impl.leak_ref()); }
 
     [[nodiscard]] static String repeated(char, size_t count);
     [[nodiscard]] static String repeated(StringView, size_t count);
@@ -84,6 +118,8 @@ public:
     [[nodiscard]] Optional<T> to_int(TrimWhitespace = TrimWhitespace::Yes) const;
     template<typename T = unsigned>
     [[nodiscard]] Optional<T> to_uint(TrimWhitespace = TrimWhitespace::Yes) const;
+    [[nodiscard]] Optional<double> to_double(TrimWhitespace = TrimWhitespace::Yes) const;
+    [[nodiscard]] Optional<float> to_float(TrimWhitespace = TrimWhitespace::Yes) const;
 
     [[nodiscard]] String to_lowercase() const;
     [[nodiscard]] String to_uppercase() const;
@@ -131,27 +167,52 @@ public:
     [[nodiscard]] StringView substringView(size_t start, size_t length) const;
     [[nodiscard]] StringView substringView(size_t start) const;
 
-    [[nodiscard]] bool isNull() const { return !m_impl; }
+    [[nodiscard]] bool isNull() const { return !isInline() && !impl(); }
     [[nodiscard]] ALWAYS_INLINE bool isEmpty() const { return length() == 0; }
-    [[nodiscard]] ALWAYS_INLINE size_t length() const { return m_impl ? m_impl->length() : 0; }
+
+    [[nodiscard]] ALWAYS_INLINE size_t length() const {
+
+        if (isInline()) {
+
+            return m_inline_length;
+        }
+
+        auto* impl = this->impl();
+
+        return impl ? impl->length() : 0;
+    }
+
     // Includes NUL-terminator, if non-nullptr.
-    [[nodiscard]] ALWAYS_INLINE char const* characters() const { return m_impl ? m_impl->characters() : nullptr; }
+
+    [[nodiscard]] ALWAYS_INLINE char const* characters() const {
+
+        if (isInline()) {
+
+            return m_storage;
+        }
+
+        auto* impl = this->impl();
+
+        return impl ? impl->characters() : nullptr;
+    }
 
     [[nodiscard]] bool copy_characters_to_buffer(char* buffer, size_t buffer_size) const;
 
     [[nodiscard]] ALWAYS_INLINE ReadOnlyBytes bytes() const
     {
-        if (m_impl) {
-            return m_impl->bytes();
+        if (isNull()) {
+            return {};
         }
-        return {};
+        return { characters(), length() };
     }
 
     [[nodiscard]] ALWAYS_INLINE char const& operator[](size_t i) const {
 
         VERIFY(!isNull());
+
+        VERIFY(i < length());
         
-        return (*m_impl)[i];
+        return characters()[i];
     }
 
     using ConstIterator = SimpleIterator<const String, char const>;
@@ -185,45 +246,81 @@ public:
 
     [[nodiscard]] String isolated_copy() const;
 
+    // The interned FlyString with these characters; defined in FlyString.cpp.
+
+    [[nodiscard]] FlyString intern() const;
+
     [[nodiscard]] static String empty()
     {
-        return StringImpl::theEmptyStringImpl();
+        return String("", 0);
     }
 
-    [[nodiscard]] StringImpl* impl() { return m_impl.pointer(); }
-    [[nodiscard]] StringImpl const* impl() const { return m_impl.pointer(); }
+    // Null for null strings and for strings stored inline.
+
+    [[nodiscard]] StringImpl* impl() {
+
+        if (isInline()) {
+
+            return nullptr;
+        }
+
+        StringImpl* impl;
+
+        __builtin_memcpy(&impl, m_storage, sizeof(impl));
+
+        return impl;
+    }
+
+    [[nodiscard]] StringImpl const* impl() const { return const_cast<String&>(*this).impl(); }
 
     String& operator=(String&& other)
     {
-        if (this != &other)
-            m_impl = move(other.m_impl);
+        if (this != &other) {
+            dereferenceImpl();
+            copyRepresentation(other);
+            other.setImpl(nullptr);
+        }
         return *this;
     }
 
     String& operator=(String const& other)
     {
-        if (this != &other)
-            m_impl = const_cast<String&>(other).m_impl;
+        if (this != &other) {
+            String copy(other);
+            *this = move(copy);
+        }
         return *this;
     }
 
     String& operator=(std::nullptr_t)
     {
-        m_impl = nullptr;
+        dereferenceImpl();
+        setImpl(nullptr);
         return *this;
     }
 
     String& operator=(ReadOnlyBytes bytes)
     {
-        m_impl = StringImpl::create(bytes);
+        *this = String(bytes);
         return *this;
     }
 
     [[nodiscard]] UInt32 hash() const
     {
-        if (!m_impl)
+        if (auto* impl = this->impl())
+            return impl->hash();
+        if (isEmpty())
+            return 0;
+        return stringHash(m_storage, m_inline_length, stringHashSeed());
+    }
+
+    [[nodiscard]] UInt32 caseInsensitiveHash() const
+    {
+        if (auto* impl = this->impl())
+            return impl->caseInsensitiveHash();
+        if (isEmpty())
             return 0;
-        return m_impl->hash();
+        return caseInsensitiveStringHash(m_storage, m_inline_length, stringHashSeed());
     }
 
     template<typename BufferType>
@@ -282,21 +379,83 @@ public:
     }
 
     String& operator+=(String const&);
+    String& operator+=(StringView);
+    String& operator+=(char const*);
 
 private:
 
-    ReferencePointer<StringImpl> m_impl;
+    // m_inline_length is the length of an inline string, or heapTag when m_storage holds a (possibly null)
+    // StringImpl* instead.
+
+    static constexpr UInt8 heapTag = 0xff;
+
+    ALWAYS_INLINE bool isInline() const { return m_inline_length != heapTag; }
+
+    ALWAYS_INLINE void setImpl(StringImpl* impl) {
+
+        __builtin_memcpy(m_storage, &impl, sizeof(impl));
+
+        m_inline_length = heapTag;
+    }
+
+    ALWAYS_INLINE void copyRepresentation(String const& other) {
+
+        __builtin_memcpy(m_storage, other.m_storage, sizeof(m_storage));
+
+        m_inline_length = other.m_inline_length;
+    }
+
+    ALWAYS_INLINE void dereferenceImpl() {
+
+        if (auto* impl = this->impl()) {
+
+            impl->dereference();
+        }
+    }
+
+    ALWAYS_INLINE void initialize(char const* characters, size_t length, ShouldChomp shouldChomp) {
+
+        if (shouldChomp == Chomp && characters) {
+
+            length = chompedLength(characters, length);
+        }
+
+        if (characters && length <= inlineCapacity) {
+
+            __builtin_memcpy(m_storage, characters, length);
+
+            m_storage[length] = '\0';
+
+            m_inline_length = static_cast<UInt8>(length);
+
+            return;
+        }
+
+        setImpl(StringImpl::create(characters, length).leak_ref());
+    }
+
+    static size_t chompedLength(char const* characters, size_t length);
+
+    alignas(StringImpl*) char m_storage[inlineCapacity + 1];
+
+    UInt8 m_inline_length;
 };
 
+static_assert(sizeof(String) == String::inlineCapacity + 2);
+
 template<>
 struct Traits<String> : public GenericTraits<String> {
 
-    static unsigned hash(String const& s) { return s.impl() ? s.impl()->hash() : 0; }
+    static unsigned hash(String const& s) { return s.hash(); }
+
+    // Inline characters or a pointer to a shared StringImpl, neither of which refers back to the String itself.
+
+    static constexpr bool isTriviallyRelocatable() { return true; }
 };
 
 struct CaseInsensitiveStringTraits : public Traits<String> {
 
-    static unsigned hash(String const& s) { return s.impl() ? s.impl()->caseInsensitiveHash() : 0; }
+    static unsigned hash(String const& s) { return s.caseInsensitiveHash(); }
     
     static bool equals(String const& a, String const& b) { return a.equalsIgnoringCase(b); }
 };
@@ -307,6 +466,7 @@ bool operator>(char const*, String const&);
 bool operator<=(char const*, String const&);
 
 String operator+(String const&, String const&);
+String operator+(String&&, String const&);
 
 String escape_html_entities(StringView html);
 
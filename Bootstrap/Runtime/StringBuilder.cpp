@@ -10,29 +10,126 @@
 #include "StringView.h"
 #include "UnicodeUtils.h"
 
-inline ErrorOr<void> StringBuilder::will_append(size_t size)
+ErrorOr<void> StringBuilder::will_append(size_t size)
 {
-    TRY(m_buffer.add_capacity(size));
+    Checked<size_t> needed = m_length;
+    needed += size;
+    if (needed.hasOverflow())
+        return Error::fromErrorCode(EOVERFLOW);
+
+    if (needed.value() <= m_capacity)
+        return {};
+
+    Checked<size_t> doubled = m_capacity;
+    doubled *= 2;
+
+    TRY(growTo(doubled.hasOverflow() ? needed.value() : max(doubled.value(), needed.value())));
+    return {};
+}
+
+ErrorOr<void> StringBuilder::growTo(size_t capacity)
+{
+    VERIFY(capacity > m_capacity);
+
+    // The outline buffer is a StringImpl with room for `capacity` characters and a NUL-terminator.
+    Checked<size_t> slot_size = capacity;
+    slot_size += allocationSizeForStringImpl(0);
+    if (slot_size.hasOverflow())
+        return Error::fromErrorCode(EOVERFLOW);
+
+    void* slot = nullptr;
+
+    if (m_outline_slot) {
+        slot = krealloc(m_outline_slot, slot_size.value(), AllocationSite::StringImpl);
+        if (!slot)
+            return Error::fromErrorCode(ENOMEM);
+    } else {
+        slot = kmalloc(slot_size.value(), AllocationSite::StringImpl);
+        if (!slot)
+            return Error::fromErrorCode(ENOMEM);
+        new (slot) StringImpl(StringImpl::ConstructWithInlineBuffer, 0);
+        __builtin_memcpy(static_cast<StringImpl*>(slot)->m_inline_buffer, m_inline_buffer, m_length);
+    }
+
+    m_outline_slot = slot;
+    m_data = static_cast<StringImpl*>(slot)->m_inline_buffer;
+    m_capacity = capacity;
     return {};
 }
 
+void StringBuilder::resetToInlineBuffer()
+{
+    m_outline_slot = nullptr;
+    m_data = m_inline_buffer;
+    m_length = 0;
+    m_capacity = inlineCapacity;
+}
+
 StringBuilder::StringBuilder()
 {
 }
 
-ErrorOr<void> StringBuilder::tryAppend(StringView string)
+StringBuilder::StringBuilder(size_t initialCapacity)
 {
-    if (string.isEmpty())
+    reserve(initialCapacity);
+}
+
+StringBuilder::StringBuilder(StringBuilder&& other)
+{
+    *this = move(other);
+}
+
+StringBuilder& StringBuilder::operator=(StringBuilder&& other)
+{
+    if (this == &other)
+        return *this;
+
+    if (m_outline_slot)
+        kfree_sized(m_outline_slot, allocationSizeForStringImpl(m_capacity), AllocationSite::StringImpl);
+
+    if (other.m_outline_slot) {
+        m_outline_slot = other.m_outline_slot;
+        m_data = other.m_data;
+        m_capacity = other.m_capacity;
+    } else {
+        m_outline_slot = nullptr;
+        m_data = m_inline_buffer;
+        m_capacity = inlineCapacity;
+        __builtin_memcpy(m_inline_buffer, other.m_inline_buffer, other.m_length);
+    }
+
+    m_length = other.m_length;
+
+    other.resetToInlineBuffer();
+    return *this;
+}
+
+StringBuilder::~StringBuilder()
+{
+    if (m_outline_slot)
+        kfree_sized(m_outline_slot, allocationSizeForStringImpl(m_capacity), AllocationSite::StringImpl);
+}
+
+ErrorOr<void> StringBuilder::tryReserve(size_t capacity)
+{
+    if (capacity <= m_capacity)
         return {};
-    TRY(will_append(string.length()));
-    TRY(m_buffer.push_values((UInt8 const*)string.charactersWithoutNullTermination(), string.length()));
+    TRY(growTo(capacity));
     return {};
 }
 
-ErrorOr<void> StringBuilder::tryAppend(char ch)
+void StringBuilder::reserve(size_t capacity)
+{
+    MUST(tryReserve(capacity));
+}
+
+ErrorOr<void> StringBuilder::tryAppend(StringView string)
 {
-    TRY(will_append(1));
-    TRY(m_buffer.push(ch));
+    if (string.isEmpty())
+        return {};
+    TRY(will_append(string.length()));
+    __builtin_memcpy(m_data + m_length, string.charactersWithoutNullTermination(), string.length());
+    m_length += string.length();
     return {};
 }
 
@@ -46,6 +143,29 @@ ErrorOr<void> StringBuilder::tryAppend(char const* characters, size_t length)
     return tryAppend(StringView { characters, length });
 }
 
+ErrorOr<void> StringBuilder::tryAppendRepeated(char ch, size_t count)
+{
+    if (count == 0)
+        return {};
+    TRY(will_append(count));
+    __builtin_memset(m_data + m_length, ch, count);
+    m_length += count;
+    return {};
+}
+
+void StringBuilder::appendRepeated(char ch, size_t count)
+{
+    MUST(tryAppendRepeated(ch, count));
+}
+
+ErrorOr<Bytes> StringBuilder::tryGetBytesForWriting(size_t count)
+{
+    TRY(will_append(count));
+    auto* bytes = reinterpret_cast<UInt8*>(m_data + m_length);
+    m_length += count;
+    return Bytes { bytes, count };
+}
+
 void StringBuilder::append(char const* characters, size_t length)
 {
     MUST(tryAppend(characters, length));
@@ -60,22 +180,51 @@ String StringBuilder::toString() const
 {
     if (isEmpty())
         return String::empty();
-    return String((char const*)data(), length());
+    return String(data(), length());
 }
 
-String StringBuilder::build() const
+String StringBuilder::build()
 {
-    return toString();
+    if (isEmpty())
+        return String::empty();
+
+    // Short strings still live in the inline buffer; copying them is cheaper than allocating twice.
+    if (!m_outline_slot) {
+        auto string = toString();
+        clear();
+        return string;
+    }
+
+    // The built String is usually kept as it is, so slack of more than a quarter of its length is given back.
+    // Large blocks usually shrink in place; should shrinking fail, the StringImpl keeps the whole buffer, which it
+    // frees by its capacity. Strings still being appended to get their slack from String::operator+= instead.
+    auto* slot = m_outline_slot;
+    auto capacity = m_capacity;
+    if (capacity - m_length > m_length / 4) {
+        if (auto* shrunk = krealloc(slot, allocationSizeForStringImpl(m_length), AllocationSite::StringImpl)) {
+            slot = shrunk;
+            capacity = m_length;
+        }
+    }
+
+    auto* impl = static_cast<StringImpl*>(slot);
+    impl->m_length = m_length;
+    impl->m_capacity = capacity;
+    impl->m_inline_buffer[m_length] = '\0';
+
+    resetToInlineBuffer();
+
+    return String(adoptReference(*impl));
 }
 
 StringView StringBuilder::stringView() const
 {
-    return StringView { data(), m_buffer.size() };
+    return StringView { data(), length() };
 }
 
 void StringBuilder::clear()
 {
-    static_cast<void>(m_buffer.resize(0));
+    m_length = 0;
 }
 
 ErrorOr<void> StringBuilder::tryAppendCodePoint(UInt32 code_point)
@@ -10,21 +10,45 @@
 #include "Forward.h"
 #include "String.h"
 #include "StringView.h"
-#include "../Builtins/Array.h"
 #include <stdarg.h>
 
+// StringBuilder keeps short strings in an inline buffer and grows
+// geometrically once it spills to the heap. The heap buffer is laid out as a
+// StringImpl, so build() can hand it over to a String without copying.
+
 class StringBuilder {
 
+    MAKE_NONCOPYABLE(StringBuilder);
+
 public:
 
     using OutputType = String;
 
+    static constexpr size_t inlineCapacity = 256;
+
     explicit StringBuilder();
-    ~StringBuilder() = default;
+    explicit StringBuilder(size_t initialCapacity);
+    StringBuilder(StringBuilder&&);
+    StringBuilder& operator=(StringBuilder&&);
+    ~StringBuilder();
+
+    ErrorOr<void> tryReserve(size_t capacity);
+    void reserve(size_t capacity);
 
     ErrorOr<void> tryAppend(StringView);
     ErrorOr<void> tryAppendCodePoint(UInt32);
-    ErrorOr<void> tryAppend(char);
+
+    ALWAYS_INLINE ErrorOr<void> tryAppend(char ch) {
+
+        if (m_length == m_capacity) {
+
+            TRY(will_append(1));
+        }
+
+        m_data[m_length++] = ch;
+
+        return { };
+    }
     template<typename... Parameters>
     
     ErrorOr<void> tryAppendFormat(CheckedFormatString<Parameters...>&& fmtstr, Parameters const&... parameters) {
@@ -34,12 +58,18 @@ public:
     }
 
     ErrorOr<void> tryAppend(char const*, size_t);
+    ErrorOr<void> tryAppendRepeated(char, size_t count);
     ErrorOr<void> tryAppendEscapedForJSON(StringView);
 
+    // Grows the builder by `count` bytes and returns them for the caller to fill in.
+
+    ErrorOr<Bytes> tryGetBytesForWriting(size_t count);
+
     void append(StringView);
     void append(char);
     void appendCodePoint(UInt32);
     void append(char const*, size_t);
+    void appendRepeated(char, size_t count);
 
     void appendAsLowercase(char);
     void appendEscapedForJSON(StringView);
@@ -53,7 +83,10 @@ public:
 
 #ifndef KERNEL
 
-    [[nodiscard]] String build() const;
+    // Hands the buffer over to the returned String without copying it and
+    // leaves the builder empty.
+
+    [[nodiscard]] String build();
     
     [[nodiscard]] String toString() const;
 
@@ -63,8 +96,9 @@ public:
 
     void clear();
 
-    [[nodiscard]] size_t length() const { return m_buffer.size(); }
-    [[nodiscard]] bool isEmpty() const { return m_buffer.isEmpty(); }
+    [[nodiscard]] size_t length() const { return m_length; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+    [[nodiscard]] bool isEmpty() const { return m_length == 0; }
 
     template<class SeparatorType, class CollectionType>
     void join(SeparatorType const& separator, CollectionType const& collection, StringView fmtstr = "{}"sv) {
@@ -89,10 +123,24 @@ public:
 private:
 
     ErrorOr<void> will_append(size_t);
-    UInt8* data() { return m_buffer.unsafeData(); }
-    UInt8 const* data() const { return const_cast<StringBuilder*>(this)->m_buffer.unsafeData(); }
+    ErrorOr<void> growTo(size_t capacity);
+    void resetToInlineBuffer();
+
+    char* data() { return m_data; }
+    char const* data() const { return m_data; }
+
+    // Either points into m_inline_buffer or at the characters of the StringImpl
+    // under construction in m_outline_slot.
+
+    char* m_data { m_inline_buffer };
+
+    void* m_outline_slot { nullptr };
+
+    size_t m_length { 0 };
+
+    size_t m_capacity { inlineCapacity };
 
-    Array<UInt8> m_buffer;
+    char m_inline_buffer[inlineCapacity];
 };
 
 template<typename T>
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef KERNEL
+
+#    include "StringHash.h"
+#    include <time.h>
+#    include <unistd.h>
+
+#    ifdef OS_MACOS
+#        include <sys/random.h>
+#    endif
+
+UInt64 generateStringHashSeed() {
+
+    UInt64 seed = 0;
+
+    if (getentropy(&seed, sizeof(seed)) == 0) {
+
+        return seed;
+    }
+
+    // No entropy source: the clock and where the process got loaded are still not known in advance.
+
+    timespec now { };
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    auto address = reinterpret_cast<UInt64>(&seed) ^ reinterpret_cast<UInt64>(&generateStringHashSeed);
+
+    return stringHash64(reinterpret_cast<char const*>(&now), sizeof(now), address ^ static_cast<UInt64>(getpid()));
+}
+
+#endif
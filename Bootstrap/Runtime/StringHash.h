@@ -6,39 +6,206 @@
 
 #pragma once
 
+#include "StdLibExtras.h"
 #include "Types.h"
 
-constexpr UInt32 stringHash(char const* characters, size_t length, UInt32 seed = 0)
-{
-    UInt32 hash = seed;
-    for (size_t i = 0; i < length; ++i) {
-        hash += (UInt32)characters[i];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
+// String hashing after rapidhash (itself a descendant of wyhash): eight bytes at a time, folded with 64x64->128-bit
+// multiplications, so that long keys cost a few cycles per word instead of several per byte. Everything is constexpr
+// so literals can be hashed at compile time; the seed makes the result unpredictable to anyone who does not know it.
+
+namespace Detail {
+
+    static constexpr UInt64 stringHashSecret[3] = { 0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3 };
+
+    constexpr void stringHashMultiply(UInt64& a, UInt64& b) {
+
+        auto product = static_cast<unsigned __int128>(a) * b;
+
+        a = static_cast<UInt64>(product);
+        b = static_cast<UInt64>(product >> 64);
     }
-    hash += hash << 3;
-    hash ^= hash >> 11;
-    hash += hash << 15;
-    return hash;
-}
 
-constexpr UInt32 caseInsensitiveStringHash(char const* characters, size_t length, UInt32 seed = 0)
-{
-    // AK/CharacterTypes.h cannot be included from here.
-    auto to_lowercase = [](char ch) -> UInt32 {
-        if (ch >= 'A' && ch <= 'Z')
-            return static_cast<UInt32>(ch) + 0x20;
-        return static_cast<UInt32>(ch);
-    };
-
-    UInt32 hash = seed;
-    for (size_t i = 0; i < length; ++i) {
-        hash += to_lowercase(characters[i]);
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
+    constexpr UInt64 stringHashMix(UInt64 a, UInt64 b) {
+
+        stringHashMultiply(a, b);
+
+        return a ^ b;
+    }
+
+    // ASCII lowercasing of eight bytes at once: only bytes in 'A'..'Z' get 0x20 added.
+
+    constexpr UInt64 toLowercaseEightBytes(UInt64 word) {
+
+        constexpr UInt64 lsbs = 0x0101010101010101;
+        constexpr UInt64 msbs = 0x8080808080808080;
+
+        auto low_seven_bits = word & ~msbs;
+
+        auto at_least_a = low_seven_bits + lsbs * (0x80 - 'A');
+
+        auto above_z = low_seven_bits + lsbs * (0x80 - 'Z' - 1);
+
+        auto is_upper = at_least_a & ~above_z & ~word & msbs;
+
+        return word | (is_upper >> 2);
+    }
+
+    template<bool CaseInsensitive>
+    constexpr UInt64 readStringHashWord(char const* characters, size_t count) {
+
+        UInt64 word = 0;
+
+        if (isConstantEvaluated()) {
+
+            for (size_t i = 0; i < count; ++i) {
+
+                word |= static_cast<UInt64>(static_cast<UInt8>(characters[i])) << (i * 8);
+            }
+        }
+        else {
+
+            __builtin_memcpy(&word, characters, count);
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            word = __builtin_bswap64(word) >> ((8 - count) * 8);
+#endif
+        }
+
+        if constexpr (CaseInsensitive) {
+
+            word = toLowercaseEightBytes(word);
+        }
+
+        return word;
+    }
+
+    template<bool CaseInsensitive>
+    constexpr UInt64 read64(char const* characters) { return readStringHashWord<CaseInsensitive>(characters, 8); }
+
+    template<bool CaseInsensitive>
+    constexpr UInt64 read32(char const* characters) { return readStringHashWord<CaseInsensitive>(characters, 4); }
+
+    template<bool CaseInsensitive>
+    constexpr UInt64 stringHash64(char const* characters, size_t length, UInt64 seed) {
+
+        auto const* secret = stringHashSecret;
+
+        seed ^= stringHashMix(seed ^ secret[0], secret[1]) ^ length;
+
+        UInt64 a = 0;
+        UInt64 b = 0;
+
+        if (length <= 16) {
+
+            if (length >= 4) {
+
+                auto const* last = characters + length - 4;
+
+                a = (read32<CaseInsensitive>(characters) << 32) | read32<CaseInsensitive>(last);
+
+                auto delta = (length & 24) >> (length >> 3);
+
+                b = (read32<CaseInsensitive>(characters + delta) << 32) | read32<CaseInsensitive>(last - delta);
+            }
+            else if (length > 0) {
+
+                // First, middle and last byte; for fewer than three bytes some of them coincide.
+
+                a = readStringHashWord<CaseInsensitive>(characters, 1) << 56
+                    | readStringHashWord<CaseInsensitive>(characters + (length >> 1), 1) << 32
+                    | readStringHashWord<CaseInsensitive>(characters + length - 1, 1);
+            }
+        }
+        else {
+
+            auto remaining = length;
+
+            if (remaining > 48) {
+
+                auto see1 = seed;
+                auto see2 = seed;
+
+                do {
+
+                    seed = stringHashMix(read64<CaseInsensitive>(characters) ^ secret[0], read64<CaseInsensitive>(characters + 8) ^ seed);
+                    see1 = stringHashMix(read64<CaseInsensitive>(characters + 16) ^ secret[1], read64<CaseInsensitive>(characters + 24) ^ see1);
+                    see2 = stringHashMix(read64<CaseInsensitive>(characters + 32) ^ secret[2], read64<CaseInsensitive>(characters + 40) ^ see2);
+
+                    characters += 48;
+                    remaining -= 48;
+                }
+                while (remaining >= 48);
+
+                seed ^= see1 ^ see2;
+            }
+
+            if (remaining > 16) {
+
+                seed = stringHashMix(read64<CaseInsensitive>(characters) ^ secret[2], read64<CaseInsensitive>(characters + 8) ^ seed ^ secret[1]);
+
+                if (remaining > 32) {
+
+                    seed = stringHashMix(read64<CaseInsensitive>(characters + 16) ^ secret[2], read64<CaseInsensitive>(characters + 24) ^ seed);
+                }
+            }
+
+            // The last 16 bytes, which may overlap what was already mixed in.
+
+            a = read64<CaseInsensitive>(characters + remaining - 16);
+            b = read64<CaseInsensitive>(characters + remaining - 8);
+        }
+
+        a ^= secret[1];
+        b ^= seed;
+
+        stringHashMultiply(a, b);
+
+        return stringHashMix(a ^ secret[0] ^ length, b ^ secret[1]);
     }
-    hash += hash << 3;
-    hash ^= hash >> 11;
-    hash += hash << 15;
-    return hash;
+
+    constexpr UInt32 foldStringHash(UInt64 hash) {
+
+        return static_cast<UInt32>(hash) ^ static_cast<UInt32>(hash >> 32);
+    }
+}
+
+constexpr UInt64 stringHash64(char const* characters, size_t length, UInt64 seed = 0) {
+
+    return Detail::stringHash64<false>(characters, length, seed);
+}
+
+constexpr UInt64 caseInsensitiveStringHash64(char const* characters, size_t length, UInt64 seed = 0) {
+
+    return Detail::stringHash64<true>(characters, length, seed);
+}
+
+constexpr UInt32 stringHash(char const* characters, size_t length, UInt64 seed = 0) {
+
+    return Detail::foldStringHash(stringHash64(characters, length, seed));
+}
+
+constexpr UInt32 caseInsensitiveStringHash(char const* characters, size_t length, UInt64 seed = 0) {
+
+    return Detail::foldStringHash(caseInsensitiveStringHash64(characters, length, seed));
 }
+
+#ifndef KERNEL
+
+UInt64 generateStringHashSeed();
+
+// The seed every runtime string hash (String, StringView, char const* keys) is computed with: random per process,
+// so that colliding keys cannot be prepared in advance. Hashes computed at compile time use a seed of their own and
+// cannot be compared with these.
+
+inline UInt64 stringHashSeed() {
+
+    static UInt64 const seed = generateStringHashSeed();
+
+    return seed;
+}
+
+#else
+
+inline UInt64 stringHashSeed() { return 0; }
+
+#endif
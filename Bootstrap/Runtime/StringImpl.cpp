@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "Arena.h"
 #include "CharacterTypes.h"
+#include "FlyString.h"
 #include "HashTable.h"
 #include "Memory.h"
 #include "StdLibExtras.h"
@@ -18,7 +20,11 @@ StringImpl& StringImpl::theEmptyStringImpl() {
 
     if (!s_theEmptyStringImpl) {
 
-        void* slot = kmalloc(sizeof(StringImpl) + sizeof(char));
+        // Lives forever, so never in an arena.
+
+        ArenaScope heap_scope { nullptr };
+
+        void* slot = kmalloc(sizeof(StringImpl) + sizeof(char), AllocationSite::StringImpl);
         
         s_theEmptyStringImpl = new (slot) StringImpl(ConstructTheEmptyStringImpl);
     }
@@ -27,19 +33,37 @@ StringImpl& StringImpl::theEmptyStringImpl() {
 }
 
 StringImpl::StringImpl(ConstructWithInlineBufferTag, size_t length)
-    : m_length(length) { }
+    : m_length(length),
+      m_capacity(length) { }
 
 StringImpl::~StringImpl() { }
 
+void StringImpl::will_be_destroyed() const {
+
+    if (isFly()) {
+
+        FlyString::didDestroyImpl(*this);
+    }
+}
+
 NonNullReferencePointer<StringImpl> StringImpl::createUninitialized(size_t length, char*& buffer) {
 
+    return createUninitialized(length, length, buffer);
+}
+
+NonNullReferencePointer<StringImpl> StringImpl::createUninitialized(size_t length, size_t capacity, char*& buffer) {
+
     VERIFY(length);
+
+    VERIFY(capacity >= length);
     
-    void* slot = kmalloc(allocationSizeForStringImpl(length));
+    void* slot = kmalloc(allocationSizeForStringImpl(capacity), AllocationSite::StringImpl);
     
     VERIFY(slot);
     
     auto new_stringimpl = adoptReference(*new (slot) StringImpl(ConstructWithInlineBuffer, length));
+
+    new_stringimpl->m_capacity = capacity;
     
     buffer = const_cast<char*>(new_stringimpl->characters());
     
@@ -178,16 +202,68 @@ NonNullReferencePointer<StringImpl> StringImpl::to_uppercase() const {
     return const_cast<StringImpl&>(*this);
 }
 
+StringImpl* StringImpl::appendInPlace(StringImpl* impl, char const* characters, size_t length) {
+
+    VERIFY(impl->canAppendInPlace());
+
+    Checked<size_t> new_length = impl->m_length;
+
+    new_length += length;
+
+    VERIFY(!new_length.hasOverflow());
+
+    if (new_length.value() > impl->m_capacity) {
+
+        auto const* old_buffer = impl->m_inline_buffer;
+
+        auto appends_itself = characters >= old_buffer && characters < old_buffer + impl->m_length;
+
+        auto offset = characters - old_buffer;
+
+        Checked<size_t> doubled = impl->m_capacity;
+
+        doubled *= 2;
+
+        auto capacity = doubled.hasOverflow() ? new_length.value() : max(doubled.value(), new_length.value());
+
+        impl = static_cast<StringImpl*>(krealloc(impl, allocationSizeForStringImpl(capacity), AllocationSite::StringImpl));
+
+        VERIFY(impl);
+
+        impl->m_capacity = capacity;
+
+        if (appends_itself) {
+
+            characters = impl->m_inline_buffer + offset;
+        }
+    }
+
+    __builtin_memcpy(impl->m_inline_buffer + impl->m_length, characters, length);
+
+    impl->m_length = new_length.value();
+
+    impl->m_inline_buffer[impl->m_length] = '\0';
+
+    impl->m_hash.store(0, MemoryOrder::memory_order_relaxed);
+
+    return impl;
+}
+
 unsigned StringImpl::caseInsensitiveHash() const {
 
-    return caseInsensitiveStringHash(characters(), length());
+    if (!length()) {
+
+        return 0;
+    }
+
+    return caseInsensitiveStringHash(characters(), length(), stringHashSeed());
 }
 
-void StringImpl::compute_hash() const
+unsigned StringImpl::compute_hash() const
 {
     if (!length())
-        m_hash = 0;
-    else
-        m_hash = stringHash(characters(), m_length);
-    m_has_hash = true;
+        return 0;
+    auto hash = stringHash(characters(), m_length, stringHashSeed());
+    m_hash.store(hash, MemoryOrder::memory_order_relaxed);
+    return hash;
 }
\ No newline at end of file
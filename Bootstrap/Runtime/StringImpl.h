@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include "ReferenceCounted.h"
+#include "AtomicReferenceCounted.h"
 #include "ReferencePointer.h"
 #include "Span.h"
 #include "Types.h"
@@ -19,10 +19,15 @@ enum ShouldChomp {
 
 size_t allocationSizeForStringImpl(size_t length);
 
-class StringImpl : public ReferenceCounted<StringImpl> {
+// Immutable once shared, so the count is atomic and Strings may be shared freely between threads.
+class StringImpl : public AtomicReferenceCounted<StringImpl> {
 public:
 
     static NonNullReferencePointer<StringImpl> createUninitialized(size_t length, char*& buffer);
+
+    // As above, with room for `capacity` characters so that appendInPlace() doesn't need to grow it right away.
+
+    static NonNullReferencePointer<StringImpl> createUninitialized(size_t length, size_t capacity, char*& buffer);
     static ReferencePointer<StringImpl> create(char const* cstring, ShouldChomp = NoChomp);
     static ReferencePointer<StringImpl> create(char const* cstring, size_t length, ShouldChomp = NoChomp);
     static ReferencePointer<StringImpl> create(ReadOnlyBytes, ShouldChomp = NoChomp);
@@ -34,7 +39,7 @@ public:
 
     void operator delete(void* ptr) {
 
-        kfree_sized(ptr, allocationSizeForStringImpl(static_cast<StringImpl*>(ptr)->m_length));
+        kfree_sized(ptr, allocationSizeForStringImpl(static_cast<StringImpl*>(ptr)->m_capacity), AllocationSite::StringImpl);
     }
 
     static StringImpl& theEmptyStringImpl();
@@ -61,22 +66,51 @@ public:
         return __builtin_memcmp(characters(), other.characters(), length()) == 0;
     }
 
+    // Several threads may hash the same StringImpl at once. They all compute the same value, so the cache needs
+    // no more than relaxed atomics; 0 means not computed yet, which only costs strings that hash to 0 a recompute.
+
     unsigned hash() const
     {
-        if (!m_has_hash)
-            compute_hash();
-        return m_hash;
+        auto hash = m_hash.load(MemoryOrder::memory_order_relaxed);
+        if (hash == 0)
+            hash = compute_hash();
+        return hash;
     }
 
     unsigned existing_hash() const
     {
-        return m_hash;
+        return m_hash.load(MemoryOrder::memory_order_relaxed);
     }
 
     unsigned caseInsensitiveHash() const;
 
+    // Whether nobody but the caller can see this StringImpl, so that it may still be changed.
+
+    bool canAppendInPlace() const {
+
+        return m_refCount.load(MemoryOrder::memory_order_acquire) == 1 && !isFly();
+    }
+
+    // Appends `length` characters (which may be its own) to `impl`, which must satisfy canAppendInPlace(). Grows
+    // the allocation geometrically when it is full, which may move it: use the returned StringImpl from then on.
+
+    [[nodiscard]] static StringImpl* appendInPlace(StringImpl* impl, char const* characters, size_t length);
+
+    // Whether this is the interned copy of its characters, owned by FlyString's table.
+
+    bool isFly() const { return m_fly.load(MemoryOrder::memory_order_relaxed); }
+
+    // Called by AtomicReferenceCounted as the last reference goes away, before the destructor.
+
+    void will_be_destroyed() const;
+
 private:
 
+    friend class FlyString;
+    friend class StringBuilder;
+
+    void setFly(bool fly) const { m_fly.store(fly, MemoryOrder::memory_order_relaxed); }
+
     enum ConstructTheEmptyStringImplTag {
 
         ConstructTheEmptyStringImpl
@@ -94,13 +128,17 @@ private:
 
     StringImpl(ConstructWithInlineBufferTag, size_t length);
 
-    void compute_hash() const;
+    unsigned compute_hash() const;
 
     size_t m_length { 0 };
+
+    // Characters there is room for, not counting the NUL-terminator; more than m_length only after appendInPlace().
+
+    size_t m_capacity { 0 };
     
-    mutable unsigned m_hash { 0 };
-    
-    mutable bool m_has_hash { false };
+    mutable Atomic<unsigned> m_hash { 0 };
+
+    mutable Atomic<bool> m_fly { false };
     
     char m_inline_buffer[0];
 };
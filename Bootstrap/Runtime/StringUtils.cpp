@@ -6,9 +6,11 @@
  */
 
 #include "CharacterTypes.h"
+#include "FloatingPointStringConversions.h"
 #include "MemMem.h"
 #include "Memory.h"
 #include "Optional.h"
+#include "SWARDigits.h"
 #include "StringBuilder.h"
 #include "StringUtils.h"
 #include "StringView.h"
@@ -88,6 +90,71 @@ namespace StringUtils {
         return string_ptr == string_end && mask_ptr == mask_end;
     }
 
+    // All of `characters` as one decimal number, eight digits per step with one overflow check per step.
+    static Optional<UInt64> convert_decimal_digits(char const* characters, size_t length) {
+
+        UInt64 value = 0;
+
+        if (length < 8) {
+
+            // Too short to overflow, and too short for a chunk.
+
+            for (size_t i = 0; i < length; ++i) {
+
+                auto const digit = static_cast<UInt8>(characters[i] - '0');
+
+                if (digit > 9) {
+
+                    return { };
+                }
+
+                value = value * 10 + digit;
+            }
+
+            return value;
+        }
+
+        size_t i = 0;
+
+        for (; length - i >= 8; i += 8) {
+
+            auto const chunk = loadEightCharacters(characters + i);
+
+            if (!areEightAsciiDigits(chunk)) {
+
+                return { };
+            }
+
+            if (__builtin_mul_overflow(value, 100000000, &value) || __builtin_add_overflow(value, parseEightAsciiDigits(chunk), &value)) {
+
+                return { };
+            }
+        }
+
+        if (i < length) {
+
+            // Reload the last eight characters and turn the ones already consumed into leading zeros.
+
+            constexpr UInt64 powers_of_ten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+            auto const remaining = length - i;
+            auto const consumed_mask = (1ull << (8 * (8 - remaining))) - 1;
+            auto const chunk = (loadEightCharacters(characters + length - 8) & ~consumed_mask) | (0x3030303030303030 & consumed_mask);
+
+            if (!areEightAsciiDigits(chunk)) {
+
+                return { };
+            }
+
+            if (__builtin_mul_overflow(value, powers_of_ten[remaining], &value) || __builtin_add_overflow(value, parseEightAsciiDigits(chunk), &value)) {
+
+                return { };
+            }
+        }
+
+        return value;
+    }
+
     template<typename T>
     Optional<T> convert_to_int(StringView str, TrimWhitespace trim_whitespace) {
 
@@ -100,7 +167,7 @@ namespace StringUtils {
             return { };
         }
 
-        T sign = 1;
+        bool negative = false;
         
         size_t i = 0;
         
@@ -115,24 +182,31 @@ namespace StringUtils {
 
             i++;
             
-            if (characters[0] == '-') {
+            negative = characters[0] == '-';
+        }
 
-                sign = -1;
-            }
+        auto const magnitude = convert_decimal_digits(characters + i, string.length() - i);
+
+        if (!magnitude.hasValue()) {
+
+            return { };
         }
 
-        T value = 0;
-        for (; i < string.length(); i++) {
-            if (characters[i] < '0' || characters[i] > '9')
-                return {};
+        using Unsigned = MakeUnsigned<T>;
 
-            if (__builtin_mul_overflow(value, 10, &value))
-                return {};
+        auto const limit = static_cast<UInt64>(NumericLimits<T>::max()) + negative;
 
-            if (__builtin_add_overflow(value, sign * (characters[i] - '0'), &value))
-                return {};
+        if (magnitude.value() > limit) {
+
+            return { };
         }
-        return value;
+
+        if (negative) {
+
+            return static_cast<T>(static_cast<Unsigned>(0) - static_cast<Unsigned>(magnitude.value()));
+        }
+
+        return static_cast<T>(magnitude.value());
     }
 
     template Optional<Int8> convert_to_int(StringView str, TrimWhitespace);
@@ -150,20 +224,12 @@ namespace StringUtils {
         if (string.isEmpty())
             return {};
 
-        T value = 0;
-        auto const characters = string.charactersWithoutNullTermination();
+        auto const value = convert_decimal_digits(string.charactersWithoutNullTermination(), string.length());
 
-        for (size_t i = 0; i < string.length(); i++) {
-            if (characters[i] < '0' || characters[i] > '9')
-                return {};
-
-            if (__builtin_mul_overflow(value, 10, &value))
-                return {};
+        if (!value.hasValue() || value.value() > static_cast<UInt64>(NumericLimits<T>::max()))
+            return {};
 
-            if (__builtin_add_overflow(value, characters[i] - '0', &value))
-                return {};
-        }
-        return value;
+        return static_cast<T>(value.value());
     }
 
     template Optional<UInt8> convert_to_uint(StringView str, TrimWhitespace);
@@ -174,6 +240,62 @@ namespace StringUtils {
     template Optional<long> convert_to_uint(StringView str, TrimWhitespace);
     template Optional<long long> convert_to_uint(StringView str, TrimWhitespace);
 
+    template<typename T>
+    Optional<Vector<T>> convert_to_int(ReadOnlySpan<StringView> strings, TrimWhitespace trim_whitespace) {
+
+        Vector<T> values;
+
+        values.ensureCapacity(strings.size());
+
+        for (auto string : strings) {
+
+            auto const value = convert_to_int<T>(string, trim_whitespace);
+
+            if (!value.hasValue()) {
+
+                return { };
+            }
+
+            values.uncheckedAppend(value.value());
+        }
+
+        return values;
+    }
+
+    template Optional<Vector<Int8>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<Int16>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<Int32>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<long>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<long long>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace);
+
+    template<typename T>
+    Optional<Vector<T>> convert_to_uint(ReadOnlySpan<StringView> strings, TrimWhitespace trim_whitespace) {
+
+        Vector<T> values;
+
+        values.ensureCapacity(strings.size());
+
+        for (auto string : strings) {
+
+            auto const value = convert_to_uint<T>(string, trim_whitespace);
+
+            if (!value.hasValue()) {
+
+                return { };
+            }
+
+            values.uncheckedAppend(value.value());
+        }
+
+        return values;
+    }
+
+    template Optional<Vector<UInt8>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<UInt16>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<UInt32>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<unsigned long>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace);
+    template Optional<Vector<unsigned long long>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace);
+
     template<typename T>
     Optional<T> convert_to_uint_from_hex(StringView str, TrimWhitespace trim_whitespace)
     {
@@ -248,6 +370,45 @@ namespace StringUtils {
     template Optional<UInt32> convert_to_uint_from_octal(StringView str, TrimWhitespace);
     template Optional<UInt64> convert_to_uint_from_octal(StringView str, TrimWhitespace);
 
+#ifndef KERNEL
+
+    template<typename T>
+    static Optional<T> convert_to_floating_point(StringView str, TrimWhitespace trim_whitespace) {
+
+        auto string = trim_whitespace == TrimWhitespace::Yes
+            ? str.trim_whitespace()
+            : str;
+
+        if (string.isEmpty()) {
+
+            return { };
+        }
+
+        auto const* start = string.charactersWithoutNullTermination();
+        auto const* end = start + string.length();
+
+        auto const result = parseFirstFloatingPoint<T>(start, end);
+
+        if (!result.parsedValue() || result.endPointer != end) {
+
+            return { };
+        }
+
+        return result.value;
+    }
+
+    Optional<double> convert_to_double(StringView str, TrimWhitespace trim_whitespace) {
+
+        return convert_to_floating_point<double>(str, trim_whitespace);
+    }
+
+    Optional<float> convert_to_float(StringView str, TrimWhitespace trim_whitespace) {
+
+        return convert_to_floating_point<float>(str, trim_whitespace);
+    }
+
+#endif
+
     bool equalsIgnoringCase(StringView a, StringView b)
     {
         if (a.length() != b.length())
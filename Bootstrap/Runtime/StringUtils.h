@@ -52,10 +52,19 @@ template<typename T = int>
 Optional<T> convert_to_int(StringView, TrimWhitespace = TrimWhitespace::Yes);
 template<typename T = unsigned>
 Optional<T> convert_to_uint(StringView, TrimWhitespace = TrimWhitespace::Yes);
+// Batch forms: one value per view, or nothing at all if any view does not parse.
+template<typename T = int>
+Optional<Vector<T>> convert_to_int(ReadOnlySpan<StringView>, TrimWhitespace = TrimWhitespace::Yes);
+template<typename T = unsigned>
+Optional<Vector<T>> convert_to_uint(ReadOnlySpan<StringView>, TrimWhitespace = TrimWhitespace::Yes);
 template<typename T = unsigned>
 Optional<T> convert_to_uint_from_hex(StringView, TrimWhitespace = TrimWhitespace::Yes);
 template<typename T = unsigned>
 Optional<T> convert_to_uint_from_octal(StringView, TrimWhitespace = TrimWhitespace::Yes);
+#ifndef KERNEL
+Optional<double> convert_to_double(StringView, TrimWhitespace = TrimWhitespace::Yes);
+Optional<float> convert_to_float(StringView, TrimWhitespace = TrimWhitespace::Yes);
+#endif
 bool equalsIgnoringCase(StringView, StringView);
 bool endsWith(StringView a, StringView b, CaseSensitivity);
 bool startsWith(StringView, StringView, CaseSensitivity);
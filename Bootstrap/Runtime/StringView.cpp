@@ -12,6 +12,7 @@
 #include "Vector.h"
 
 #ifndef KERNEL
+#    include "FlyString.h"
 #    include "String.h"
 #endif
 
@@ -21,6 +22,10 @@ StringView::StringView(String const& string)
     : m_characters(string.characters()), 
       m_length(string.length()) { }
 
+StringView::StringView(FlyString const& string)
+    : m_characters(string.characters()), 
+      m_length(string.length()) { }
+
 #endif
 
 Vector<StringView> StringView::splitView(char const separator, bool keep_empty) const {
@@ -259,6 +264,20 @@ template Optional<long long> StringView::to_uint() const;
 
 #ifndef KERNEL
 
+Optional<double> StringView::to_double() const {
+
+    return StringUtils::convert_to_double(*this);
+}
+
+Optional<float> StringView::to_float() const {
+
+    return StringUtils::convert_to_float(*this);
+}
+
+#endif
+
+#ifndef KERNEL
+
 bool StringView::operator==(String const& string) const {
 
     return *this == string.view();
@@ -50,12 +50,16 @@ public:
 
     StringView(String const&);
 
+    StringView(FlyString const&);
+
 #endif
 
 #ifndef KERNEL
 
     explicit StringView(String&&) = delete;
 
+    explicit StringView(FlyString&&) = delete;
+
 #endif
 
     [[nodiscard]] constexpr bool isNull() const {
@@ -78,14 +82,14 @@ public:
     [[nodiscard]] constexpr ConstIterator begin() const { return ConstIterator::begin(*this); }
     [[nodiscard]] constexpr ConstIterator end() const { return ConstIterator::end(*this); }
 
-    [[nodiscard]] constexpr unsigned hash() const {
+    [[nodiscard]] unsigned hash() const {
 
         if (isEmpty()) {
 
             return 0;
         }
 
-        return stringHash(charactersWithoutNullTermination(), length());
+        return stringHash(charactersWithoutNullTermination(), length(), stringHashSeed());
     }
 
     [[nodiscard]] bool startsWith(StringView, CaseSensitivity = CaseSensitivity::CaseSensitive) const;
@@ -206,6 +210,11 @@ public:
     template<typename T = unsigned>
     Optional<T> to_uint() const;
 
+#ifndef KERNEL
+    Optional<double> to_double() const;
+    Optional<float> to_float() const;
+#endif
+
     // Create a new substring view of this string view, starting either at the beginning of
     // the given substring view, or after its end, and continuing until the end of this string
     // view (that is, for the remaining part of its length). For example,
@@ -392,7 +401,7 @@ struct CaseInsensitiveStringViewTraits : public Traits<StringView> {
             return 0;
         }
 
-        return caseInsensitiveStringHash(s.charactersWithoutNullTermination(), s.length());
+        return caseInsensitiveStringHash(s.charactersWithoutNullTermination(), s.length(), stringHashSeed());
     }
 };
 
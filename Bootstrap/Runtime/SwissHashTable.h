@@ -0,0 +1,832 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Checked.h"
+#include "Concepts.h"
+#include "Error.h"
+#include "Forward.h"
+#include "HashTable.h"
+#include "NumericLimits.h"
+#include "StdLibExtras.h"
+#include "Traits.h"
+#include "TypedTransfer.h"
+#include "Types.h"
+#include "kmalloc.h"
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
+// An open-addressing hash table in the style of Abseil's flat_hash_map ("Swiss table"). Next to the slots lives an
+// array of one-byte control words: the top bit tells an empty or deleted slot from a full one, and a full slot
+// keeps 7 bits of its hash there. A probe loads a whole group of control bytes at once and compares all of them
+// against the wanted fragment with a handful of vector instructions, so the slots themselves (and their cache
+// misses) are only touched for likely matches. It has the same interface as an unordered HashTable and is what
+// SwissHashMap is built on.
+
+namespace Detail {
+
+    enum class SwissControl : Int8 {
+
+        Empty = -128,   // 0b10000000
+        Deleted = -2,   // 0b11111110
+        Sentinel = -1,  // 0b11111111
+    };
+
+    constexpr bool isSwissFull(Int8 control) { return control >= 0; }
+
+    // The positions of the slots in a group that matched, lowest first. Vector compares produce one bit per slot;
+    // the portable and NEON versions produce one byte per slot with only its top bit kept.
+
+    template<typename MaskType, size_t Width, size_t Shift>
+    class SwissBitMask {
+
+    public:
+
+        explicit SwissBitMask(MaskType mask)
+            : m_mask(mask) { }
+
+        explicit operator bool() const { return m_mask != 0; }
+
+        size_t lowestBitSet() const { return static_cast<size_t>(__builtin_ctzll(m_mask)) >> Shift; }
+
+        size_t trailingZeros() const { return m_mask ? lowestBitSet() : Width; }
+
+        size_t leadingZeros() const {
+
+            constexpr size_t totalBits = sizeof(MaskType) * 8;
+
+            constexpr size_t extraBits = totalBits - (Width << Shift);
+
+            if (!m_mask) {
+
+                return Width;
+            }
+
+            return (static_cast<size_t>(__builtin_clzll(static_cast<UInt64>(m_mask) << (64 - totalBits))) - extraBits) >> Shift;
+        }
+
+        void clearLowestBit() { m_mask &= m_mask - 1; }
+
+    private:
+
+        MaskType m_mask;
+    };
+
+#if defined(__SSE2__)
+
+    struct SwissGroup {
+
+        static constexpr size_t width = 16;
+
+        using BitMask = SwissBitMask<UInt32, width, 0>;
+
+        explicit SwissGroup(Int8 const* control)
+            : m_control(_mm_loadu_si128(reinterpret_cast<__m128i const*>(control))) { }
+
+        BitMask match(Int8 fragment) const {
+
+            return BitMask(static_cast<UInt32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fragment), m_control))));
+        }
+
+        BitMask matchEmpty() const {
+
+            return match(static_cast<Int8>(SwissControl::Empty));
+        }
+
+        // Empty and Deleted are the only values below Sentinel.
+
+        BitMask matchEmptyOrDeleted() const {
+
+            return BitMask(static_cast<UInt32>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(static_cast<Int8>(SwissControl::Sentinel)), m_control))));
+        }
+
+        __m128i m_control;
+    };
+
+#else
+
+    struct SwissGroup {
+
+        static constexpr size_t width = 8;
+
+        using BitMask = SwissBitMask<UInt64, width, 3>;
+
+        static constexpr UInt64 lsbs = 0x0101010101010101;
+        static constexpr UInt64 msbs = 0x8080808080808080;
+
+        explicit SwissGroup(Int8 const* control) {
+
+            __builtin_memcpy(&m_control, control, sizeof(m_control));
+
+#    if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            m_control = __builtin_bswap64(m_control);
+#    endif
+        }
+
+        BitMask match(Int8 fragment) const {
+
+#    if defined(__ARM_NEON)
+            auto equal = vceq_u8(vcreate_u8(m_control), vdup_n_u8(static_cast<UInt8>(fragment)));
+
+            return BitMask(vget_lane_u64(vreinterpret_u64_u8(equal), 0) & msbs);
+#    else
+            // Zero bytes of x are found exactly by (x - 1) & ~x & 0x80; the borrow only produces false positives above
+            // a true match, which a lookup filters out with its equality check anyway.
+
+            auto x = m_control ^ (lsbs * static_cast<UInt8>(fragment));
+
+            return BitMask((x - lsbs) & ~x & msbs);
+#    endif
+        }
+
+        BitMask matchEmpty() const {
+
+            // Empty is the only value with the top bit set and bit 1 clear.
+
+            return BitMask((m_control & ~(m_control << 6)) & msbs);
+        }
+
+        BitMask matchEmptyOrDeleted() const {
+
+            // Empty and Deleted are the only values with the top bit set and bit 0 clear.
+
+            return BitMask((m_control & ~(m_control << 7)) & msbs);
+        }
+
+        UInt64 m_control;
+    };
+
+#endif
+
+}
+
+template<typename HashTableType, typename T>
+class SwissHashTableIterator {
+
+    friend HashTableType;
+
+public:
+
+    bool operator==(SwissHashTableIterator const& other) const { return m_slot == other.m_slot; }
+
+    bool operator!=(SwissHashTableIterator const& other) const { return m_slot != other.m_slot; }
+
+    T& operator*() { return *m_slot; }
+
+    T* operator->() { return m_slot; }
+
+    void operator++() {
+
+        ++m_control;
+        ++m_slot;
+
+        skipToFull();
+    }
+
+private:
+
+    SwissHashTableIterator(Int8 const* control, T* slot)
+        : m_control(control)
+        , m_slot(slot) {
+
+        skipToFull();
+    }
+
+    void skipToFull() {
+
+        if (!m_control) {
+
+            return;
+        }
+
+        while (!Detail::isSwissFull(*m_control)) {
+
+            if (*m_control == static_cast<Int8>(Detail::SwissControl::Sentinel)) {
+
+                m_control = nullptr;
+                m_slot = nullptr;
+
+                return;
+            }
+
+            ++m_control;
+            ++m_slot;
+        }
+    }
+
+    Int8 const* m_control { nullptr };
+    T* m_slot { nullptr };
+};
+
+template<typename T, typename TraitsForT>
+class SwissHashTable {
+
+    using Group = Detail::SwissGroup;
+    using SwissControl = Detail::SwissControl;
+
+    static constexpr size_t groupWidth = Group::width;
+
+    // Bytes past the sentinel that repeat the first slots, so a group starting anywhere can be loaded whole.
+    static constexpr size_t clonedControlBytes = groupWidth - 1;
+
+public:
+
+    SwissHashTable() = default;
+
+    explicit SwissHashTable(size_t capacity) { MUST(tryEnsureCapacity(capacity)); }
+
+    ~SwissHashTable() {
+
+        destroyAndDeallocate();
+    }
+
+    SwissHashTable(SwissHashTable const& other) {
+
+        MUST(tryEnsureCapacity(other.size()));
+
+        for (auto& value : other) {
+
+            set(value);
+        }
+    }
+
+    SwissHashTable& operator=(SwissHashTable const& other) {
+
+        SwissHashTable temporary(other);
+
+        swap(*this, temporary);
+
+        return *this;
+    }
+
+    SwissHashTable(SwissHashTable&& other) noexcept
+        : m_control(exchange(other.m_control, nullptr))
+        , m_slots(exchange(other.m_slots, nullptr))
+        , m_size(exchange(other.m_size, 0))
+        , m_capacity(exchange(other.m_capacity, 0))
+        , m_growthLeft(exchange(other.m_growthLeft, 0)) { }
+
+    SwissHashTable& operator=(SwissHashTable&& other) noexcept {
+
+        SwissHashTable temporary { move(other) };
+
+        swap(*this, temporary);
+
+        return *this;
+    }
+
+    friend void swap(SwissHashTable& a, SwissHashTable& b) noexcept {
+
+        swap(a.m_control, b.m_control);
+        swap(a.m_slots, b.m_slots);
+        swap(a.m_size, b.m_size);
+        swap(a.m_capacity, b.m_capacity);
+        swap(a.m_growthLeft, b.m_growthLeft);
+    }
+
+    [[nodiscard]] bool isEmpty() const { return m_size == 0; }
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+    template<typename U, size_t N>
+    ErrorOr<void> try_set_from(U (&from_array)[N]) {
+
+        for (size_t i = 0; i < N; ++i) {
+
+            TRY(try_set(from_array[i]));
+        }
+
+        return { };
+    }
+
+    template<typename U, size_t N>
+    void set_from(U (&from_array)[N]) {
+
+        MUST(try_set_from(from_array));
+    }
+
+    void ensureCapacity(size_t capacity) {
+
+        MUST(tryEnsureCapacity(capacity));
+    }
+
+    // Makes room for `capacity` values in total without any further rehashing.
+
+    ErrorOr<void> tryEnsureCapacity(size_t capacity) {
+
+        VERIFY(capacity >= size());
+
+        if (capacity <= m_size + m_growthLeft) {
+
+            return { };
+        }
+
+        return tryRehash(normalizedCapacity(capacityForGrowth(capacity)));
+    }
+
+    [[nodiscard]] bool contains(T const& value) const {
+
+        return find(value) != end();
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] bool contains(K const& value) const {
+
+        return find(value) != end();
+    }
+
+    using Iterator = SwissHashTableIterator<SwissHashTable, T>;
+
+    using ConstIterator = SwissHashTableIterator<const SwissHashTable, const T>;
+
+    [[nodiscard]] Iterator begin() {
+
+        if (isEmpty()) {
+
+            return end();
+        }
+
+        return Iterator(m_control, m_slots);
+    }
+
+    [[nodiscard]] Iterator end() { return Iterator(nullptr, nullptr); }
+
+    [[nodiscard]] ConstIterator begin() const {
+
+        if (isEmpty()) {
+
+            return end();
+        }
+
+        return ConstIterator(m_control, m_slots);
+    }
+
+    [[nodiscard]] ConstIterator end() const { return ConstIterator(nullptr, nullptr); }
+
+    void clear() {
+
+        *this = SwissHashTable();
+    }
+
+    void clearWithCapacity() {
+
+        if (!m_control) {
+
+            return;
+        }
+
+        destroyAll();
+
+        resetControl();
+    }
+
+    template<typename U = T>
+    ErrorOr<HashSetResult> try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behavior = HashSetExistingEntryBehavior::Replace) {
+
+        auto hash = TraitsForT::hash(value);
+
+        if (auto* existing = lookupWithHash(hash, [&](auto& other) { return TraitsForT::equals(other, value); })) {
+
+            if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep) {
+
+                return HashSetResult::KeptExistingEntry;
+            }
+
+            *existing = forward<U>(value);
+
+            return HashSetResult::ReplacedExistingEntry;
+        }
+
+        auto index = TRY(tryPrepareInsert(hash));
+
+        new (&m_slots[index]) T(forward<U>(value));
+
+        return HashSetResult::InsertedNewEntry;
+    }
+
+    template<typename U = T>
+    HashSetResult set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace) {
+
+        return MUST(try_set(forward<U>(value), existing_entry_behaviour));
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] Iterator find(UInt64 hash, TUnaryPredicate predicate) {
+
+        return iteratorFor(lookupWithHash(hash, move(predicate)));
+    }
+
+    [[nodiscard]] Iterator find(T const& value) {
+
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] ConstIterator find(UInt64 hash, TUnaryPredicate predicate) const {
+
+        return iteratorFor(lookupWithHash(hash, move(predicate)));
+    }
+
+    [[nodiscard]] ConstIterator find(T const& value) const {
+
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value) {
+
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(value, other); });
+    }
+
+    template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value, TUnaryPredicate predicate) {
+
+        return find(Traits<K>::hash(value), move(predicate));
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value) const {
+
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(value, other); });
+    }
+
+    template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value, TUnaryPredicate predicate) const {
+
+        return find(Traits<K>::hash(value), move(predicate));
+    }
+
+    bool remove(T const& value) {
+
+        auto it = find(value);
+
+        if (it != end()) {
+
+            remove(it);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) bool remove(K const& value) {
+
+        auto it = find(value);
+
+        if (it != end()) {
+
+            remove(it);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void remove(Iterator iterator) {
+
+        VERIFY(iterator.m_slot);
+
+        eraseAt(static_cast<size_t>(iterator.m_slot - m_slots));
+    }
+
+    template<typename TUnaryPredicate>
+    bool removeAllMatching(TUnaryPredicate predicate) {
+
+        size_t removed_count = 0;
+
+        for (size_t i = 0; i < m_capacity; ++i) {
+
+            if (Detail::isSwissFull(m_control[i]) && predicate(m_slots[i])) {
+
+                eraseAt(i);
+
+                ++removed_count;
+            }
+        }
+
+        return removed_count;
+    }
+
+private:
+
+    // Capacities are always 2^n - 1, so that the capacity itself is the mask for slot indices.
+
+    static constexpr size_t normalizedCapacity(size_t capacity) {
+
+        return capacity ? NumericLimits<size_t>::max() >> __builtin_clzll(capacity) : 1;
+    }
+
+    // At most 7/8 of the slots are ever full, which keeps probe sequences short.
+
+    static constexpr size_t growthForCapacity(size_t capacity) {
+
+        if (groupWidth == 8 && capacity == 7) {
+
+            return 6;
+        }
+
+        return capacity - capacity / 8;
+    }
+
+    static constexpr size_t capacityForGrowth(size_t growth) {
+
+        if (groupWidth == 8 && growth == 7) {
+
+            return 8;
+        }
+
+        return growth + (growth - 1) / 7;
+    }
+
+    static Int8 hashFragment(UInt64 hash) {
+
+        // The slot index comes from the low bits of the hash; the fragment comes from a multiplicative mix so that
+        // it is independent of them.
+
+        return static_cast<Int8>((hash * 0x9e3779b97f4a7c15) >> 57);
+    }
+
+    static ErrorOr<size_t> allocationSize(size_t capacity) {
+
+        Checked<size_t> size = sizeof(T);
+
+        size *= capacity;
+
+        size += slotsOffset(capacity);
+
+        if (size.hasOverflow()) {
+
+            return Error::fromErrorCode(EOVERFLOW);
+        }
+
+        return size.value();
+    }
+
+    static size_t slotsOffset(size_t capacity) {
+
+        return (capacity + groupWidth + (alignof(T) - 1)) / alignof(T) * alignof(T);
+    }
+
+    void setControl(size_t index, Int8 control) {
+
+        m_control[index] = control;
+
+        m_control[((index - clonedControlBytes) & m_capacity) + (clonedControlBytes & m_capacity)] = control;
+    }
+
+    void resetControl() {
+
+        __builtin_memset(m_control, static_cast<Int8>(SwissControl::Empty), m_capacity + groupWidth);
+
+        m_control[m_capacity] = static_cast<Int8>(SwissControl::Sentinel);
+
+        m_size = 0;
+
+        m_growthLeft = growthForCapacity(m_capacity);
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] T* lookupWithHash(UInt64 hash, TUnaryPredicate predicate) const {
+
+        if (isEmpty()) {
+
+            return nullptr;
+        }
+
+        auto fragment = hashFragment(hash);
+
+        size_t offset = hash & m_capacity;
+
+        size_t stride = 0;
+
+        for (;;) {
+
+            Group group(m_control + offset);
+
+            for (auto matches = group.match(fragment); matches; matches.clearLowestBit()) {
+
+                auto index = (offset + matches.lowestBitSet()) & m_capacity;
+
+                if (predicate(m_slots[index])) {
+
+                    return &m_slots[index];
+                }
+            }
+
+            if (group.matchEmpty()) {
+
+                return nullptr;
+            }
+
+            stride += groupWidth;
+
+            offset = (offset + stride) & m_capacity;
+        }
+    }
+
+    size_t findFirstNonFull(UInt64 hash) const {
+
+        size_t offset = hash & m_capacity;
+
+        size_t stride = 0;
+
+        for (;;) {
+
+            auto free_slots = Group(m_control + offset).matchEmptyOrDeleted();
+
+            if (free_slots) {
+
+                return (offset + free_slots.lowestBitSet()) & m_capacity;
+            }
+
+            stride += groupWidth;
+
+            offset = (offset + stride) & m_capacity;
+        }
+    }
+
+    ErrorOr<size_t> tryPrepareInsert(UInt64 hash) {
+
+        if (!m_control) {
+
+            TRY(tryRehash(normalizedCapacity(groupWidth - 1)));
+        }
+
+        auto index = findFirstNonFull(hash);
+
+        if (m_growthLeft == 0 && m_control[index] != static_cast<Int8>(SwissControl::Deleted)) {
+
+            // Out of never-used slots. If most of the used ones are tombstones, clearing them is enough.
+
+            if (m_capacity > groupWidth && m_size * 32 <= m_capacity * 25) {
+
+                TRY(tryRehash(m_capacity));
+            }
+            else {
+
+                TRY(tryRehash(m_capacity * 2 + 1));
+            }
+
+            index = findFirstNonFull(hash);
+        }
+
+        if (m_control[index] == static_cast<Int8>(SwissControl::Empty)) {
+
+            --m_growthLeft;
+        }
+
+        setControl(index, hashFragment(hash));
+
+        ++m_size;
+
+        return index;
+    }
+
+    ErrorOr<void> tryRehash(size_t new_capacity) {
+
+        auto size = TRY(allocationSize(new_capacity));
+
+        auto* memory = static_cast<UInt8*>(kmalloc(size, AllocationSite::HashTableBuckets));
+
+        if (!memory) {
+
+            return Error::fromErrorCode(ENOMEM);
+        }
+
+        auto* old_control = m_control;
+        auto* old_slots = m_slots;
+        auto old_capacity = m_capacity;
+
+        m_control = reinterpret_cast<Int8*>(memory);
+        m_slots = reinterpret_cast<T*>(memory + slotsOffset(new_capacity));
+        m_capacity = new_capacity;
+
+        resetControl();
+
+        if (!old_control) {
+
+            return { };
+        }
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+
+            if (!Detail::isSwissFull(old_control[i])) {
+
+                continue;
+            }
+
+            auto hash = TraitsForT::hash(old_slots[i]);
+
+            auto index = findFirstNonFull(hash);
+
+            setControl(index, hashFragment(hash));
+
+            TypedTransfer<T>::relocate(&m_slots[index], &old_slots[i], 1);
+
+            ++m_size;
+        }
+
+        m_growthLeft -= m_size;
+
+        kfree_sized(old_control, MUST(allocationSize(old_capacity)), AllocationSite::HashTableBuckets);
+
+        return { };
+    }
+
+    void eraseAt(size_t index) {
+
+        VERIFY(Detail::isSwissFull(m_control[index]));
+
+        m_slots[index].~T();
+
+        --m_size;
+
+        // A slot can go straight back to Empty if no probe sequence ever had to step over it, i.e. if it never sat
+        // inside a run of groupWidth full slots.
+
+        auto index_before = (index - groupWidth) & m_capacity;
+
+        auto empty_after = Group(m_control + index).matchEmpty();
+
+        auto empty_before = Group(m_control + index_before).matchEmpty();
+
+        bool was_never_full = empty_before && empty_after && (empty_after.trailingZeros() + empty_before.leadingZeros()) < groupWidth;
+
+        if (was_never_full) {
+
+            setControl(index, static_cast<Int8>(SwissControl::Empty));
+
+            ++m_growthLeft;
+        }
+        else {
+
+            setControl(index, static_cast<Int8>(SwissControl::Deleted));
+        }
+    }
+
+    Iterator iteratorFor(T* slot) {
+
+        if (!slot) {
+
+            return end();
+        }
+
+        return Iterator(m_control + (slot - m_slots), slot);
+    }
+
+    ConstIterator iteratorFor(T* slot) const {
+
+        if (!slot) {
+
+            return end();
+        }
+
+        return ConstIterator(m_control + (slot - m_slots), slot);
+    }
+
+    void destroyAll() {
+
+        if constexpr (!Detail::IsTriviallyDestructible<T>) {
+
+            for (size_t i = 0; i < m_capacity; ++i) {
+
+                if (Detail::isSwissFull(m_control[i])) {
+
+                    m_slots[i].~T();
+                }
+            }
+        }
+    }
+
+    void destroyAndDeallocate() {
+
+        if (!m_control) {
+
+            return;
+        }
+
+        destroyAll();
+
+        kfree_sized(m_control, MUST(allocationSize(m_capacity)), AllocationSite::HashTableBuckets);
+
+        m_control = nullptr;
+        m_slots = nullptr;
+    }
+
+    Int8* m_control { nullptr };
+    T* m_slots { nullptr };
+    size_t m_size { 0 };
+    size_t m_capacity { 0 };
+    size_t m_growthLeft { 0 };
+};
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "ThreadPool.h"
+#include "Arena.h"
+#include "Checked.h"
+#include "kmalloc.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace Detail {
+
+    WorkStealingDeque::~WorkStealingDeque() {
+
+        auto* ring = m_ring.load(MemoryOrder::memory_order_relaxed);
+
+        while (ring) {
+
+            auto* retired = ring->retired;
+
+            kfreeOnHeap(ring, sizeof(Ring) + static_cast<size_t>(ring->capacity) * sizeof(Atomic<Task*>));
+
+            ring = retired;
+        }
+    }
+
+    ErrorOr<WorkStealingDeque::Ring*> WorkStealingDeque::grow(Ring* ring, Int64 top, Int64 bottom) {
+
+        auto capacity = ring ? ring->capacity * 2 : initialCapacity;
+
+        Checked<size_t> size = static_cast<size_t>(capacity);
+
+        size *= sizeof(Atomic<Task*>);
+
+        size += sizeof(Ring);
+
+        if (size.hasOverflow()) {
+
+            return Error::fromErrorCode(EOVERFLOW);
+        }
+
+        // Never from an arena: a task running in an ArenaScope may be what pushes, but the ring outlives the scope.
+
+        auto* new_ring = static_cast<Ring*>(kcallocOnHeap(1, size.value()));
+
+        if (!new_ring) {
+
+            return Error::fromErrorCode(ENOMEM);
+        }
+
+        new_ring->capacity = capacity;
+
+        new_ring->retired = ring;
+
+        for (auto index = top; index < bottom; ++index) {
+
+            new_ring->at(index).store(ring->at(index).load(MemoryOrder::memory_order_relaxed), MemoryOrder::memory_order_relaxed);
+        }
+
+        m_ring.store(new_ring, MemoryOrder::memory_order_release);
+
+        return new_ring;
+    }
+}
+
+struct ThreadPool::SleepState {
+
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    pthread_cond_t condition = PTHREAD_COND_INITIALIZER;
+};
+
+struct ThreadPool::Worker {
+
+    ThreadPool* pool;
+
+    pthread_t thread;
+
+    bool started;
+
+    UInt64 random_state;
+
+    Detail::WorkStealingDeque deque;
+};
+
+static constinit thread_local void* t_currentWorker = nullptr;
+
+ErrorOr<NonNullReferencePointer<ThreadPool>> ThreadPool::create(size_t worker_count) {
+
+    // The pool outlives whatever scope it is created in, shared() included.
+
+    ArenaScope heap_scope { nullptr };
+
+    auto pool = TRY(adoptNonNullReferenceOrErrorNoMemory(new (nothrow) ThreadPool));
+
+    TRY(pool->start(worker_count));
+
+    return pool;
+}
+
+ThreadPool& ThreadPool::shared() {
+
+    static ThreadPool* pool = &MUST(create()).leak_ref();
+
+    return *pool;
+}
+
+size_t ThreadPool::defaultWorkerCount() {
+
+    auto cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cpus > 1 ? static_cast<size_t>(cpus) - 1 : 0;
+}
+
+ErrorOr<void> ThreadPool::start(size_t worker_count) {
+
+    m_sleep_state = new (nothrow) SleepState;
+
+    if (!m_sleep_state) {
+
+        return Error::fromErrorCode(ENOMEM);
+    }
+
+    TRY(m_workers.tryEnsureCapacity(worker_count));
+
+    for (size_t i = 0; i < worker_count; ++i) {
+
+        auto* worker = new (nothrow) Worker { this, { }, false, 0x9e3779b97f4a7c15 * (i + 1), { } };
+
+        if (!worker) {
+
+            return Error::fromErrorCode(ENOMEM);
+        }
+
+        // Every worker is in m_workers before the first thread starts, so the vector never changes under a thief.
+
+        m_workers.uncheckedAppend(worker);
+    }
+
+    for (size_t i = 0; i < worker_count; ++i) {
+
+        if (auto rc = pthread_create(&m_workers[i]->thread, nullptr, workerEntry, m_workers[i]); rc != 0) {
+
+            // The destructor stops the threads that did start.
+
+            return Error::fromErrorCode(rc);
+        }
+
+        m_workers[i]->started = true;
+    }
+
+    return { };
+}
+
+ThreadPool::~ThreadPool() {
+
+    m_stopping.store(true, MemoryOrder::memory_order_seq_cst);
+
+    if (m_sleep_state) {
+
+        pthread_mutex_lock(&m_sleep_state->mutex);
+
+        m_wake_epoch.fetchAdd(1, MemoryOrder::memory_order_seq_cst);
+
+        pthread_cond_broadcast(&m_sleep_state->condition);
+
+        pthread_mutex_unlock(&m_sleep_state->mutex);
+    }
+
+    for (auto* worker : m_workers) {
+
+        if (worker->started) {
+
+            pthread_join(worker->thread, nullptr);
+        }
+
+        VERIFY(worker->deque.isEmpty());
+
+        delete worker;
+    }
+
+    VERIFY(!m_shared_head);
+
+    delete m_sleep_state;
+}
+
+bool ThreadPool::isWorkerThread() const {
+
+    auto* worker = static_cast<Worker*>(t_currentWorker);
+
+    return worker && worker->pool == this;
+}
+
+ErrorOr<void> ThreadPool::submit(Task* task) {
+
+    auto* worker = static_cast<Worker*>(t_currentWorker);
+
+    if (worker && worker->pool == this) {
+
+        TRY(worker->deque.push(task));
+    }
+    else {
+
+        SpinLocker locker { m_shared_lock };
+
+        if (m_shared_tail) {
+
+            m_shared_tail->next = task;
+        }
+        else {
+
+            m_shared_head = task;
+        }
+
+        m_shared_tail = task;
+
+        m_shared_count.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+    }
+
+    // Pairs with the increment of m_sleeping in workerLoop(): either this sees the sleeper, or the sleeper's last
+    // look for work sees the task.
+
+    atomicThreadFence(MemoryOrder::memory_order_seq_cst);
+
+    if (m_sleeping.load(MemoryOrder::memory_order_relaxed) > 0) {
+
+        wakeWorker();
+    }
+
+    return { };
+}
+
+void ThreadPool::wakeWorker() {
+
+    pthread_mutex_lock(&m_sleep_state->mutex);
+
+    m_wake_epoch.fetchAdd(1, MemoryOrder::memory_order_seq_cst);
+
+    pthread_cond_signal(&m_sleep_state->condition);
+
+    pthread_mutex_unlock(&m_sleep_state->mutex);
+}
+
+ThreadPool::Task* ThreadPool::popShared() {
+
+    if (m_shared_count.load(MemoryOrder::memory_order_relaxed) == 0) {
+
+        return nullptr;
+    }
+
+    SpinLocker locker { m_shared_lock };
+
+    auto* task = m_shared_head;
+
+    if (task) {
+
+        m_shared_head = task->next;
+
+        if (!m_shared_head) {
+
+            m_shared_tail = nullptr;
+        }
+
+        task->next = nullptr;
+
+        m_shared_count.fetchSub(1, MemoryOrder::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+ThreadPool::Task* ThreadPool::findTask(Worker* worker) {
+
+    if (worker) {
+
+        if (auto* task = worker->deque.pop()) {
+
+            return task;
+        }
+    }
+
+    if (auto* task = popShared()) {
+
+        return task;
+    }
+
+    auto count = m_workers.size();
+
+    if (count == 0) {
+
+        return nullptr;
+    }
+
+    // Start at a random victim so that thieves spread out instead of all hammering the first worker.
+
+    size_t start = 0;
+
+    if (worker) {
+
+        auto& state = worker->random_state;
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        start = state % count;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+
+        auto* victim = m_workers[(start + i) % count];
+
+        if (victim == worker) {
+
+            continue;
+        }
+
+        if (auto* task = victim->deque.steal()) {
+
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void ThreadPool::runTask(Task* task) {
+
+    auto* group = task->group;
+
+    auto result = task->function();
+
+    // The task's captures go first: once the group sees its count drop to zero, whatever they refer to may be gone.
+
+    task->~Task();
+
+    kfreeOnHeap(task, sizeof(Task));
+
+    group->didFinish(move(result));
+}
+
+void* ThreadPool::workerEntry(void* argument) {
+
+    auto* worker = static_cast<Worker*>(argument);
+
+    t_currentWorker = worker;
+
+    worker->pool->workerLoop(*worker);
+
+    return nullptr;
+}
+
+void ThreadPool::workerLoop(Worker& worker) {
+
+    // Spinning a little before going to sleep keeps a worker at hand for the next task of a burst.
+
+    static constexpr int spinsBeforeSleeping = 64;
+
+    int idle_spins = 0;
+
+    while (!m_stopping.load(MemoryOrder::memory_order_relaxed)) {
+
+        if (auto* task = findTask(&worker)) {
+
+            runTask(task);
+
+            idle_spins = 0;
+
+            continue;
+        }
+
+        if (idle_spins++ < spinsBeforeSleeping) {
+
+#if ARCH(I386) || ARCH(X86_64)
+            __builtin_ia32_pause();
+#endif
+            continue;
+        }
+
+        idle_spins = 0;
+
+        m_sleeping.fetchAdd(1, MemoryOrder::memory_order_seq_cst);
+
+        auto epoch = m_wake_epoch.load(MemoryOrder::memory_order_seq_cst);
+
+        if (auto* task = findTask(&worker)) {
+
+            m_sleeping.fetchSub(1, MemoryOrder::memory_order_relaxed);
+
+            runTask(task);
+
+            continue;
+        }
+
+        pthread_mutex_lock(&m_sleep_state->mutex);
+
+        while (m_wake_epoch.load(MemoryOrder::memory_order_relaxed) == epoch && !m_stopping.load(MemoryOrder::memory_order_relaxed)) {
+
+            pthread_cond_wait(&m_sleep_state->condition, &m_sleep_state->mutex);
+        }
+
+        pthread_mutex_unlock(&m_sleep_state->mutex);
+
+        m_sleeping.fetchSub(1, MemoryOrder::memory_order_relaxed);
+    }
+}
+
+ErrorOr<void> TaskGroup::spawn(Function<ErrorOr<void>()> function) {
+
+    // Tasks are freed by whichever thread runs them, so they come from the heap even inside an ArenaScope.
+
+    auto* slot = kmallocOnHeap(sizeof(Detail::ThreadPoolTask));
+
+    if (!slot) {
+
+        return Error::fromErrorCode(ENOMEM);
+    }
+
+    auto* task = new (slot) Detail::ThreadPoolTask { move(function), this, nullptr };
+
+    m_pending.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+
+    if (auto result = m_pool.submit(task); result.isError()) {
+
+        m_pending.fetchSub(1, MemoryOrder::memory_order_relaxed);
+
+        task->~ThreadPoolTask();
+
+        kfreeOnHeap(task, sizeof(Detail::ThreadPoolTask));
+
+        return result.releaseError();
+    }
+
+    return { };
+}
+
+void TaskGroup::didFinish(ErrorOr<void>&& result) {
+
+    if (result.isError()) {
+
+        SpinLocker locker { m_error_lock };
+
+        if (!m_error.hasValue()) {
+
+            m_error = result.releaseError();
+
+            m_failed.store(true, MemoryOrder::memory_order_relaxed);
+        }
+    }
+
+    // Last: the joining thread may return, and destroy this group, as soon as it sees the count reach zero.
+
+    m_pending.fetchSub(1, MemoryOrder::memory_order_acq_rel);
+}
+
+ErrorOr<void> TaskGroup::join() {
+
+    auto* worker = m_pool.isWorkerThread() ? static_cast<ThreadPool::Worker*>(t_currentWorker) : nullptr;
+
+    int idle_rounds = 0;
+
+    while (m_pending.load(MemoryOrder::memory_order_acquire) > 0) {
+
+        if (auto* task = m_pool.findTask(worker)) {
+
+            m_pool.runTask(task);
+
+            idle_rounds = 0;
+
+            continue;
+        }
+
+        // The rest of the group is running on other threads.
+
+        if (++idle_rounds < 64) {
+
+#if ARCH(I386) || ARCH(X86_64)
+            __builtin_ia32_pause();
+#endif
+        }
+        else {
+
+            sched_yield();
+        }
+    }
+
+    SpinLocker locker { m_error_lock };
+
+    m_failed.store(false, MemoryOrder::memory_order_relaxed);
+
+    if (m_error.hasValue()) {
+
+        return m_error.releaseValue();
+    }
+
+    return { };
+}
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Atomic.h"
+#include "AtomicReferenceCounted.h"
+#include "Error.h"
+#include "Function.h"
+#include "Noncopyable.h"
+#include "NonNullReferencePointer.h"
+#include "Optional.h"
+#include "Platform.h"
+#include "ReferencePointer.h"
+#include "SpinLock.h"
+#include "StdLibExtras.h"
+#include "Try.h"
+#include "Types.h"
+#include "Vector.h"
+
+// A fixed set of worker threads that run tasks spawned into TaskGroups. Every worker owns a Chase-Lev deque: it
+// pushes and pops its own tasks at the bottom, newest first, while idle workers steal the oldest (and, for work
+// that splits recursively, the largest) tasks from the top of somebody else's. Tasks spawned from threads that are
+// not workers of the pool go through a shared queue. A thread waiting in TaskGroup::join() runs queued tasks
+// itself until the group is done, so joining from inside a task never ties a worker up.
+//
+// Tasks return ErrorOr<void>. The first error a group sees is what join() returns; the rest of the group still
+// runs, but can check hasFailed() to give up early.
+
+class TaskGroup;
+class ThreadPool;
+
+namespace Detail {
+
+    struct ThreadPoolTask {
+
+        Function<ErrorOr<void>()> function;
+
+        TaskGroup* group { nullptr };
+
+        ThreadPoolTask* next { nullptr };
+    };
+
+    // The deque from "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013). Only the
+    // owning worker may push() and pop(); any thread may steal(). A full ring is replaced by one twice the size,
+    // and the old rings are kept until the deque goes away since a thief may still be reading from one.
+
+    class WorkStealingDeque {
+
+        MAKE_NONCOPYABLE(WorkStealingDeque);
+        MAKE_NONMOVABLE(WorkStealingDeque);
+
+    public:
+
+        using Task = ThreadPoolTask;
+
+        WorkStealingDeque() = default;
+
+        ~WorkStealingDeque();
+
+        ErrorOr<void> push(Task* task) {
+
+            auto bottom = m_bottom.load(MemoryOrder::memory_order_relaxed);
+
+            auto top = m_top.load(MemoryOrder::memory_order_acquire);
+
+            auto* ring = m_ring.load(MemoryOrder::memory_order_relaxed);
+
+            if (!ring || bottom - top >= ring->capacity) {
+
+                ring = TRY(grow(ring, top, bottom));
+            }
+
+            ring->at(bottom).store(task, MemoryOrder::memory_order_relaxed);
+
+            // Publishes the task, and everything written to it, to thieves that read the new bottom.
+
+            m_bottom.store(bottom + 1, MemoryOrder::memory_order_release);
+
+            return { };
+        }
+
+        Task* pop() {
+
+            auto bottom = m_bottom.load(MemoryOrder::memory_order_relaxed) - 1;
+
+            auto* ring = m_ring.load(MemoryOrder::memory_order_relaxed);
+
+            m_bottom.store(bottom, MemoryOrder::memory_order_relaxed);
+
+            atomicThreadFence(MemoryOrder::memory_order_seq_cst);
+
+            auto top = m_top.load(MemoryOrder::memory_order_relaxed);
+
+            if (top > bottom) {
+
+                m_bottom.store(bottom + 1, MemoryOrder::memory_order_relaxed);
+
+                return nullptr;
+            }
+
+            auto* task = ring->at(bottom).load(MemoryOrder::memory_order_relaxed);
+
+            if (top == bottom) {
+
+                // The last task: whoever moves top past it first, this worker or a thief, gets it.
+
+                if (!m_top.compareExchangeStrong(top, top + 1, MemoryOrder::memory_order_seq_cst)) {
+
+                    task = nullptr;
+                }
+
+                m_bottom.store(bottom + 1, MemoryOrder::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        // Returns null both when the deque is empty and when another thread took the task first.
+
+        Task* steal() {
+
+            auto top = m_top.load(MemoryOrder::memory_order_acquire);
+
+            atomicThreadFence(MemoryOrder::memory_order_seq_cst);
+
+            auto bottom = m_bottom.load(MemoryOrder::memory_order_acquire);
+
+            if (top >= bottom) {
+
+                return nullptr;
+            }
+
+            auto* ring = m_ring.load(MemoryOrder::memory_order_acquire);
+
+            auto* task = ring->at(top).load(MemoryOrder::memory_order_relaxed);
+
+            if (!m_top.compareExchangeStrong(top, top + 1, MemoryOrder::memory_order_seq_cst)) {
+
+                return nullptr;
+            }
+
+            return task;
+        }
+
+        [[nodiscard]] bool isEmpty() const {
+
+            return m_top.load(MemoryOrder::memory_order_relaxed) >= m_bottom.load(MemoryOrder::memory_order_relaxed);
+        }
+
+    private:
+
+        struct Ring {
+
+            Int64 capacity;
+
+            Ring* retired;
+
+            // The slots follow the header in the same allocation.
+
+            Atomic<Task*>& at(Int64 index) { return reinterpret_cast<Atomic<Task*>*>(this + 1)[index & (capacity - 1)]; }
+        };
+
+        static constexpr Int64 initialCapacity = 64;
+
+        ErrorOr<Ring*> grow(Ring* ring, Int64 top, Int64 bottom);
+
+        Atomic<Int64> m_top { 0 };
+
+        Atomic<Int64> m_bottom { 0 };
+
+        Atomic<Ring*> m_ring { nullptr };
+    };
+}
+
+class ThreadPool : public AtomicReferenceCounted<ThreadPool> {
+
+    MAKE_NONCOPYABLE(ThreadPool);
+    MAKE_NONMOVABLE(ThreadPool);
+
+public:
+
+    static ErrorOr<NonNullReferencePointer<ThreadPool>> create(size_t worker_count = defaultWorkerCount());
+
+    // The pool parallelFor() and TaskGroups without a pool of their own use; it is started on first use and lives
+    // until the process exits.
+
+    static ThreadPool& shared();
+
+    // One worker per online CPU but one, since the thread that joins works as well.
+
+    static size_t defaultWorkerCount();
+
+    ~ThreadPool();
+
+    size_t workerCount() const { return m_workers.size(); }
+
+    // Whether the calling thread is one of this pool's workers.
+
+    bool isWorkerThread() const;
+
+private:
+
+    friend class TaskGroup;
+
+    using Task = Detail::ThreadPoolTask;
+
+    struct SleepState;
+
+    struct Worker;
+
+    ThreadPool() = default;
+
+    ErrorOr<void> start(size_t worker_count);
+
+    ErrorOr<void> submit(Task* task);
+
+    // Finds a task for the calling thread: its own deque first if it is a worker, then the shared queue, then
+    // the other workers' deques.
+
+    Task* findTask(Worker* worker);
+
+    Task* popShared();
+
+    void runTask(Task* task);
+
+    void wakeWorker();
+
+    void workerLoop(Worker& worker);
+
+    static void* workerEntry(void* argument);
+
+    Vector<Worker*> m_workers;
+
+    SpinLock m_shared_lock;
+
+    Task* m_shared_head { nullptr };
+
+    Task* m_shared_tail { nullptr };
+
+    Atomic<size_t> m_shared_count { 0 };
+
+    Atomic<size_t> m_sleeping { 0 };
+
+    Atomic<UInt64> m_wake_epoch { 0 };
+
+    Atomic<bool> m_stopping { false };
+
+    SleepState* m_sleep_state { nullptr };
+};
+
+class TaskGroup {
+
+    MAKE_NONCOPYABLE(TaskGroup);
+    MAKE_NONMOVABLE(TaskGroup);
+
+public:
+
+    TaskGroup()
+        : m_pool(ThreadPool::shared()) { }
+
+    explicit TaskGroup(ThreadPool& pool)
+        : m_pool(pool) { }
+
+    // Waits for tasks that were never joined; their errors are lost.
+
+    ~TaskGroup() { (void)join(); }
+
+    // Queues `function` to run on the pool. Fails only if the task could not be allocated.
+
+    ErrorOr<void> spawn(Function<ErrorOr<void>()> function);
+
+    // Runs queued tasks until every task spawned into this group has finished, then returns the first error one of
+    // them returned. The group can be reused afterwards.
+
+    ErrorOr<void> join();
+
+    bool hasFailed() const { return m_failed.load(MemoryOrder::memory_order_relaxed); }
+
+    ThreadPool& pool() { return m_pool; }
+
+private:
+
+    friend class ThreadPool;
+
+    void didFinish(ErrorOr<void>&& result);
+
+    ThreadPool& m_pool;
+
+    Atomic<size_t> m_pending { 0 };
+
+    Atomic<bool> m_failed { false };
+
+    SpinLock m_error_lock;
+
+    Optional<Error> m_error;
+};
+
+namespace Detail {
+
+    template<typename Callback>
+    ErrorOr<void> parallelForRange(TaskGroup& group, size_t begin, size_t end, size_t grain, Callback const& callback) {
+
+        // Keep handing off the upper half: what is left for thieves is always the largest ranges.
+
+        while (end - begin > grain) {
+
+            auto middle = begin + (end - begin) / 2;
+
+            TRY(group.spawn([&group, &callback, middle, end, grain]() -> ErrorOr<void> {
+
+                return parallelForRange(group, middle, end, grain, callback);
+            }));
+
+            end = middle;
+        }
+
+        if (group.hasFailed()) {
+
+            return { };
+        }
+
+        return callback(begin, end);
+    }
+}
+
+// Calls callback(chunk_begin, chunk_end) for chunks of at most `grain` indices that together cover [begin, end),
+// from several threads at once, and returns once all of them are done: with the first error a chunk returned, if
+// any. Chunks that have not started when a chunk fails are skipped. A grain of 0 picks one that gives each thread
+// a few chunks to balance with.
+//
+// The callback is a template parameter rather than a Function because one Function must not be called from
+// several threads at once.
+
+template<typename Callback>
+requires(IsCallableWithArguments<Callback, size_t, size_t>)
+ErrorOr<void> parallelFor(ThreadPool& pool, size_t begin, size_t end, size_t grain, Callback const& callback) {
+
+    if (begin >= end) {
+
+        return { };
+    }
+
+    if (grain == 0) {
+
+        grain = max(static_cast<size_t>(1), (end - begin) / ((pool.workerCount() + 1) * 8));
+    }
+
+    if (end - begin <= grain || pool.workerCount() == 0) {
+
+        return callback(begin, end);
+    }
+
+    TaskGroup group(pool);
+
+    auto result = Detail::parallelForRange(group, begin, end, grain, callback);
+
+    auto joined = group.join();
+
+    TRY(result);
+
+    return joined;
+}
+
+template<typename Callback>
+requires(IsCallableWithArguments<Callback, size_t, size_t>)
+ErrorOr<void> parallelFor(size_t begin, size_t end, size_t grain, Callback const& callback) {
+
+    return parallelFor(ThreadPool::shared(), begin, end, grain, callback);
+}
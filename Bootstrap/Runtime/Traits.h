@@ -21,6 +21,12 @@ struct GenericTraits {
     using ConstPeekType = T const&;
     
     static constexpr bool isTrivial() { return false; }
+
+    // Whether a value can be moved to a new address with memcpy, leaving the old bytes behind without running its
+    // destructor. True for anything trivially copyable; types that own memory but never point into themselves (the
+    // runtime's strings and smart pointers) opt in through their own Traits.
+
+    static constexpr bool isTriviallyRelocatable() { return IsTriviallyCopyable<T>; }
     
     static constexpr bool equals(const T& a, const T& b) { return a == b; }
     
@@ -89,7 +95,15 @@ struct Traits<T> : public GenericTraits<T> {
 template<typename T>
 requires(Detail::IsPointerOfType<char, T>) struct Traits<T> : public GenericTraits<T> {
 
-    static unsigned hash(T const value) { return stringHash(value, strlen(value)); }
+    // Empty strings hash to 0 like an empty String or StringView, so the three can be used to look each other up.
+
+    static unsigned hash(T const value) {
+
+        auto length = strlen(value);
+
+        return length ? stringHash(value, length, stringHashSeed()) : 0;
+    }
+
     
     static constexpr bool equals(T const a, T const b) { return strcmp(a, b); }
     
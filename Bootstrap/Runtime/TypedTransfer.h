@@ -29,6 +29,24 @@ public:
         }
     }
 
+    // Moves `count` values into uninitialized memory at `destination` and ends the lifetime of the originals. The two
+    // ranges must not overlap.
+    static void relocate(T* destination, T* source, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        if constexpr (Traits<T>::isTriviallyRelocatable()) {
+            __builtin_memcpy(static_cast<void*>(destination), static_cast<void const*>(source), count * sizeof(T));
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            new (&destination[i]) T(std::move(source[i]));
+            source[i].~T();
+        }
+    }
+
     static size_t copy(T* destination, const T* source, size_t count)
     {
         if (count == 0)
@@ -81,12 +81,7 @@ public:
 
             if (!m_outline_buffer) {
 
-                for (size_t i = 0; i < m_size; ++i) {
-
-                    new (&inline_buffer()[i]) StorageType(move(other.inline_buffer()[i]));
-                    
-                    other.inline_buffer()[i].~StorageType();
-                }
+                TypedTransfer<StorageType>::relocate(inline_buffer(), other.inline_buffer(), m_size);
             }
         }
 
@@ -95,6 +90,23 @@ public:
         other.resetCapacity();
     }
 
+    // Takes over a buffer released by another container (see KmallocBuffer in kmalloc.h) with its elements.
+
+    explicit Vector(KmallocBuffer<T> buffer) requires(!ContainsReference)
+        : m_size(buffer.size),
+          m_capacity(buffer.capacity),
+          m_outline_buffer(buffer.elements) {
+
+        if (!m_outline_buffer) {
+
+            resetCapacity();
+
+            return;
+        }
+
+        kmallocTransferBuffer(buffer, AllocationSite::VectorBuffer);
+    }
+
     Vector(Vector const& other) {
 
         ensureCapacity(other.size());
@@ -403,12 +415,7 @@ public:
 
                 if (!m_outline_buffer) {
                     
-                    for (size_t i = 0; i < m_size; ++i) {
-
-                        new (&inline_buffer()[i]) StorageType(move(other.inline_buffer()[i]));
-                        
-                        other.inline_buffer()[i].~StorageType();
-                    }
+                    TypedTransfer<StorageType>::relocate(inline_buffer(), other.inline_buffer(), m_size);
                 }
             }
 
@@ -456,7 +463,7 @@ public:
 
         if (m_outline_buffer) {
 
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType), AllocationSite::VectorBuffer);
             
             m_outline_buffer = nullptr;
         }
@@ -464,6 +471,26 @@ public:
         resetCapacity();
     }
 
+    // Gives up the heap buffer together with the elements in it, leaving the vector empty. Elements kept in the
+    // inline buffer can't be handed over; the vector is left alone and nothing is returned.
+
+    Optional<KmallocBuffer<T>> releaseBuffer() requires(!ContainsReference) {
+
+        if (!m_outline_buffer) {
+
+            return { };
+        }
+
+        KmallocBuffer<T> buffer { m_outline_buffer, m_size, m_capacity, AllocationSite::VectorBuffer };
+
+        m_outline_buffer = nullptr;
+        m_size = 0;
+
+        resetCapacity();
+
+        return buffer;
+    }
+
     void clearWithCapacity() {
 
         for (size_t i = 0; i < m_size; ++i) {
@@ -864,30 +891,40 @@ public:
         }
 
         size_t new_capacity = kmalloc_good_size(needed_capacity * sizeof(StorageType)) / sizeof(StorageType);
-        auto* new_buffer = static_cast<StorageType*>(kmalloc_array(new_capacity, sizeof(StorageType)));
 
-        if (new_buffer == nullptr) {
+        if constexpr (Traits<StorageType>::isTriviallyRelocatable()) {
 
-            return Error::fromErrorCode(ENOMEM);
-        }
+            // The allocator can move the elements itself, growing the block in place when there is room after it.
 
-        if constexpr (Traits<StorageType>::isTrivial()) {
-            
-            TypedTransfer<StorageType>::copy(new_buffer, data(), m_size);
-        }
-        else {
+            if (m_outline_buffer) {
 
-            for (size_t i = 0; i < m_size; ++i) {
+                auto* new_buffer = static_cast<StorageType*>(krealloc(m_outline_buffer, new_capacity * sizeof(StorageType), AllocationSite::VectorBuffer));
 
-                new (&new_buffer[i]) StorageType(move(at(i)));
+                if (new_buffer == nullptr) {
 
-                at(i).~StorageType();
+                    return Error::fromErrorCode(ENOMEM);
+                }
+
+                m_outline_buffer = new_buffer;
+
+                m_capacity = new_capacity;
+
+                return { };
             }
         }
 
+        auto* new_buffer = static_cast<StorageType*>(kmalloc_array(new_capacity, sizeof(StorageType), AllocationSite::VectorBuffer));
+
+        if (new_buffer == nullptr) {
+
+            return Error::fromErrorCode(ENOMEM);
+        }
+
+        TypedTransfer<StorageType>::relocate(new_buffer, data(), m_size);
+
         if (m_outline_buffer) {
 
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType), AllocationSite::VectorBuffer);
         }
 
         m_outline_buffer = new_buffer;
@@ -1100,5 +1137,24 @@ private:
     StorageType* m_outline_buffer { nullptr };
 };
 
+// data() finds the inline buffer from `this` every time, so a Vector holds no pointer into itself; with inline
+// capacity only its elements decide.
+
+template<typename T, size_t inline_capacity>
+struct Traits<Vector<T, inline_capacity>> : public GenericTraits<Vector<T, inline_capacity>> {
+
+    static constexpr bool isTriviallyRelocatable() {
+
+        if constexpr (inline_capacity == 0 || IsLValueReference<T>) {
+
+            return true;
+        }
+        else {
+
+            return Traits<T>::isTriviallyRelocatable();
+        }
+    }
+};
+
 template<class... Args>
 Vector(Args... args) -> Vector<CommonType<Args...>>;
@@ -11,6 +11,7 @@
 #else
 #    include "Assertions.h"
 #    include "Atomic.h"
+#    include "AtomicReferenceCounted.h"
 #    include "ReferenceCounted.h"
 #    include "ReferencePointer.h"
 #    include "StdLibExtras.h"
@@ -32,7 +33,7 @@ class WeakLink : public ReferenceCounted<WeakLink> {
 public:
 
     template<typename T>
-    ReferencePointer<T> strong_ref() const requires(IsBaseOf<ReferenceCountedBase, T>) {
+    ReferencePointer<T> strong_ref() const requires(IsBaseOf<ReferenceCountedBase, T> || IsBaseOf<AtomicReferenceCountedBase, T>) {
             
         ReferencePointer<T> ref;
 
@@ -5,6 +5,616 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#if !defined(KERNEL)
+
+#    include "Assertions.h"
+#    include "Atomic.h"
+#    include "Format.h"
+#    include "HashFunctions.h"
+#    include "SpinLock.h"
+#    include "StdLibExtras.h"
+#    include "Types.h"
+#    include "kmalloc.h"
+
+#    if RUNTIME_SLAB_ALLOCATOR
+
+#        include <sys/mman.h>
+
+// Slabs are carved 64 KiB at a time out of one range of address space reserved up front, so telling a slab block
+// from a malloc() one takes two comparisons. Pages only get memory behind them when they are first touched. A slab
+// belongs to one size class for good; its free blocks go back to that class's depot and are never unmapped.
+
+static constexpr size_t slabSize = 64 * KiB;
+
+static constexpr size_t maxSlabRegionSize = sizeof(void*) == 8 ? 64 * GiB : 512 * MiB;
+
+static constexpr size_t minSlabRegionSize = 256 * MiB;
+
+// Blocks move between a thread's magazine and its class's depot half a magazine at a time, so a thread that
+// alternates between allocating and freeing around the boundary doesn't hit the depot on every call.
+
+static constexpr size_t magazineCapacity = 64;
+
+static constexpr size_t depotBatchSize = magazineCapacity / 2;
+
+static Atomic<UInt8*> s_slabRegionStart { nullptr };
+static Atomic<UInt8*> s_slabRegionEnd { nullptr };
+static Atomic<UInt8*> s_slabRegionNext { nullptr };
+
+// The size class of every slab handed out so far, indexed by its offset in the region. Only krealloc() needs it.
+
+static UInt8 s_slabClasses[maxSlabRegionSize / slabSize];
+
+struct FreeBlock {
+
+    FreeBlock* next;
+};
+
+struct SlabDepot {
+
+    SpinLock lock;
+
+    FreeBlock* free_blocks { nullptr };
+
+    // The part of the class's newest slab that no block has been carved from yet.
+
+    UInt8* unused_start { nullptr };
+    UInt8* unused_end { nullptr };
+};
+
+static SlabDepot s_depots[kmallocSlabClassCount];
+
+struct Magazine {
+
+    size_t count { 0 };
+    void* blocks[magazineCapacity] { };
+};
+
+static void flushMagazine(Magazine&, size_t slab_class, size_t count);
+
+// Flushed when its thread exits so that the blocks can be reused by others.
+
+struct ThreadCache {
+
+    ~ThreadCache() {
+
+        for (size_t slab_class = 0; slab_class < kmallocSlabClassCount; ++slab_class) {
+
+            flushMagazine(magazines[slab_class], slab_class, magazines[slab_class].count);
+        }
+    }
+
+    Magazine magazines[kmallocSlabClassCount];
+};
+
+static constinit thread_local ThreadCache t_threadCache;
+
+static bool reserveSlabRegion() {
+
+    for (auto size = maxSlabRegionSize; size >= minSlabRegionSize; size /= 2) {
+
+        auto* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (region != MAP_FAILED) {
+
+            auto* start = static_cast<UInt8*>(region);
+
+            s_slabRegionNext.store(start, MemoryOrder::memory_order_relaxed);
+            s_slabRegionEnd.store(start + size, MemoryOrder::memory_order_relaxed);
+            s_slabRegionStart.store(start, MemoryOrder::memory_order_release);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ALWAYS_INLINE static bool isSlabBlock(void* ptr) {
+
+    auto* address = static_cast<UInt8*>(ptr);
+
+    return address >= s_slabRegionStart.load(MemoryOrder::memory_order_relaxed) && address < s_slabRegionEnd.load(MemoryOrder::memory_order_relaxed);
+}
+
+ALWAYS_INLINE static size_t slabClassOf(void* ptr) {
+
+    return s_slabClasses[static_cast<size_t>(static_cast<UInt8*>(ptr) - s_slabRegionStart.load(MemoryOrder::memory_order_relaxed)) / slabSize];
+}
+
+// Called with the depot's lock held.
+
+static bool takeNewSlab(SlabDepot& depot, size_t slab_class) {
+
+    static bool const reserved = reserveSlabRegion();
+
+    if (!reserved) {
+
+        return false;
+    }
+
+    auto* slab = s_slabRegionNext.fetchAdd(slabSize, MemoryOrder::memory_order_relaxed);
+
+    if (slab >= s_slabRegionEnd.load(MemoryOrder::memory_order_relaxed)) {
+
+        return false;
+    }
+
+    s_slabClasses[static_cast<size_t>(slab - s_slabRegionStart.load(MemoryOrder::memory_order_relaxed)) / slabSize] = static_cast<UInt8>(slab_class);
+
+    depot.unused_start = slab;
+    depot.unused_end = slab + slabSize;
+
+    return true;
+}
+
+// Fills an empty magazine with up to a batch of blocks and returns one more for the caller. Once the reserved
+// region is used up, blocks of the class size come from malloc() instead; slabFree() tells them apart.
+
+static NEVER_INLINE void* refillMagazine(Magazine& magazine, size_t slab_class) {
+
+    auto block_size = kmallocSlabClassSize(slab_class);
+
+    auto& depot = s_depots[slab_class];
+
+    {
+        SpinLocker locker { depot.lock };
+
+        while (magazine.count <= depotBatchSize) {
+
+            if (auto* block = depot.free_blocks) {
+
+                depot.free_blocks = block->next;
+
+                magazine.blocks[magazine.count++] = block;
+
+                continue;
+            }
+
+            if (static_cast<size_t>(depot.unused_end - depot.unused_start) < block_size && !takeNewSlab(depot, slab_class)) {
+
+                break;
+            }
+
+            magazine.blocks[magazine.count++] = depot.unused_start;
+
+            depot.unused_start += block_size;
+        }
+    }
+
+    if (magazine.count == 0) {
+
+        return malloc(block_size);
+    }
+
+    return magazine.blocks[--magazine.count];
+}
+
+// Hands the `count` blocks at the bottom of the magazine, the ones freed longest ago, back to the depot.
+
+static void flushMagazine(Magazine& magazine, size_t slab_class, size_t count) {
+
+    if (count == 0) {
+
+        return;
+    }
+
+    // Linked up before taking the lock, so that it is only held for two stores.
+
+    auto* last = static_cast<FreeBlock*>(magazine.blocks[count - 1]);
+
+    FreeBlock* first = nullptr;
+
+    for (size_t i = count; i > 0; --i) {
+
+        auto* block = static_cast<FreeBlock*>(magazine.blocks[i - 1]);
+
+        block->next = first;
+
+        first = block;
+    }
+
+    magazine.count -= count;
+
+    __builtin_memmove(magazine.blocks, magazine.blocks + count, magazine.count * sizeof(void*));
+
+    auto& depot = s_depots[slab_class];
+
+    SpinLocker locker { depot.lock };
+
+    last->next = depot.free_blocks;
+
+    depot.free_blocks = first;
+}
+
+void* slabAllocate(size_t slab_class) {
+
+    auto& magazine = t_threadCache.magazines[slab_class];
+
+    if (magazine.count > 0) [[likely]] {
+
+        return magazine.blocks[--magazine.count];
+    }
+
+    return refillMagazine(magazine, slab_class);
+}
+
+void slabFree(void* ptr, size_t slab_class) {
+
+    if (!isSlabBlock(ptr)) [[unlikely]] {
+
+        free(ptr);
+
+        return;
+    }
+
+    // A size that rounds up to another class than the block's would hand the block out at the wrong size later.
+
+    VERIFY(slabClassOf(ptr) == slab_class);
+
+    auto& magazine = t_threadCache.magazines[slab_class];
+
+    if (magazine.count == magazineCapacity) [[unlikely]] {
+
+        flushMagazine(magazine, slab_class, depotBatchSize);
+    }
+
+    magazine.blocks[magazine.count++] = ptr;
+}
+
+void* slabReallocate(void* ptr, size_t size) {
+
+    if (!ptr) {
+
+        return kmallocOnHeap(size);
+    }
+
+    // malloc() memory, whatever its size, is resized by realloc(); kfree_sized() tells it apart by its address.
+
+    if (!isSlabBlock(ptr)) {
+
+        return realloc(ptr, size);
+    }
+
+    auto slab_class = slabClassOf(ptr);
+
+    if (size <= kmallocMaxSlabSize && kmallocSlabClass(size) == slab_class) {
+
+        return ptr;
+    }
+
+    auto* new_ptr = kmallocOnHeap(size);
+
+    if (!new_ptr) {
+
+        return nullptr;
+    }
+
+    __builtin_memcpy(new_ptr, ptr, min(size, kmallocSlabClassSize(slab_class)));
+
+    slabFree(ptr, slab_class);
+
+    return new_ptr;
+}
+
+#    endif
+
+#    if RUNTIME_ALLOCATION_PROFILING && __has_include(<execinfo.h>)
+#        include <execinfo.h>
+#        define HAVE_BACKTRACE 1
+#    else
+#        define HAVE_BACKTRACE 0
+#    endif
+
+char const* allocationSiteName(AllocationSite site) {
+
+    switch (site) {
+
+    case AllocationSite::Other:
+        return "other";
+
+    case AllocationSite::ArrayStorage:
+        return "ArrayStorage";
+
+    case AllocationSite::HashTableBuckets:
+        return "HashTable buckets";
+
+    case AllocationSite::StringImpl:
+        return "StringImpl";
+
+    case AllocationSite::VectorBuffer:
+        return "Vector buffers";
+
+    case AllocationSite::Count:
+        break;
+    }
+
+    VERIFY_NOT_REACHED();
+
+    return "unknown";
+}
+
+static constexpr size_t allocationSiteCount = to_underlying(AllocationSite::Count);
+
+#    if RUNTIME_ALLOCATION_PROFILING
+
+struct SiteCounters {
+
+    Atomic<UInt64> allocations { 0 };
+    Atomic<UInt64> frees { 0 };
+    Atomic<UInt64> reallocations { 0 };
+    Atomic<UInt64> bytes_allocated { 0 };
+    Atomic<UInt64> bytes_freed { 0 };
+    Atomic<UInt64> bytes_reallocated { 0 };
+};
+
+static SiteCounters s_siteCounters[allocationSiteCount];
+
+// Sampling by bytes rather than by calls: a sample stands for `interval` bytes, so big allocations are as likely to
+// show up as the many small ones that add up to the same amount.
+
+static constexpr size_t defaultSampleInterval = 512 * KiB;
+
+static constexpr size_t maxSampledFrames = 24;
+
+static constexpr size_t stackSampleSlots = 1024;
+
+static Atomic<size_t> s_sampleInterval { defaultSampleInterval };
+
+static constinit thread_local Int64 t_bytesUntilSample = defaultSampleInterval;
+
+struct StackSample {
+
+    unsigned hash;
+    AllocationSite site;
+    int frame_count;
+    void* frames[maxSampledFrames];
+    UInt64 samples;
+    UInt64 bytes;
+};
+
+// Samples of the same stack and site are added up in one slot. Once every slot is taken, new stacks are dropped
+// and only counted.
+
+static StackSample s_stackSamples[stackSampleSlots];
+static UInt64 s_droppedSamples { 0 };
+static SpinLock s_stackSamplesLock;
+
+static NEVER_INLINE void sampleStack(AllocationSite site) {
+
+    auto interval = s_sampleInterval.load(MemoryOrder::memory_order_relaxed);
+
+    if (interval == 0) {
+
+        t_bytesUntilSample = defaultSampleInterval;
+
+        return;
+    }
+
+    t_bytesUntilSample = static_cast<Int64>(interval);
+
+#        if HAVE_BACKTRACE
+
+    // The first two frames are this function and profileAllocation(); kmalloc() itself is inlined into its caller.
+
+    constexpr int skippedFrames = 2;
+
+    void* frames[maxSampledFrames + skippedFrames];
+
+    auto frame_count = max(backtrace(frames, maxSampledFrames + skippedFrames) - skippedFrames, 0);
+
+    auto* sampled_frames = frames + skippedFrames;
+
+    unsigned hash = to_underlying(site);
+
+    for (int i = 0; i < frame_count; ++i) {
+
+        hash = pairUInt32Hash(hash, pointerHash(sampled_frames[i]));
+    }
+
+    SpinLocker locker { s_stackSamplesLock };
+
+    for (size_t probe = 0; probe < stackSampleSlots; ++probe) {
+
+        auto& sample = s_stackSamples[(hash + probe) % stackSampleSlots];
+
+        if (sample.samples == 0) {
+
+            sample.hash = hash;
+            sample.site = site;
+            sample.frame_count = frame_count;
+
+            __builtin_memcpy(sample.frames, sampled_frames, frame_count * sizeof(void*));
+        }
+        else if (sample.hash != hash || sample.site != site || sample.frame_count != frame_count || __builtin_memcmp(sample.frames, sampled_frames, frame_count * sizeof(void*)) != 0) {
+
+            continue;
+        }
+
+        ++sample.samples;
+
+        sample.bytes += interval;
+
+        return;
+    }
+
+    ++s_droppedSamples;
+
+#        else
+
+    (void)site;
+
+#        endif
+}
+
+ALWAYS_INLINE static void countTowardsSample(AllocationSite site, size_t size) {
+
+    t_bytesUntilSample -= static_cast<Int64>(size);
+
+    if (t_bytesUntilSample < 0) [[unlikely]] {
+
+        sampleStack(site);
+    }
+}
+
+void profileAllocation(AllocationSite site, size_t size) {
+
+    auto& counters = s_siteCounters[to_underlying(site)];
+
+    counters.allocations.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+    counters.bytes_allocated.fetchAdd(size, MemoryOrder::memory_order_relaxed);
+
+    countTowardsSample(site, size);
+}
+
+void profileReallocation(AllocationSite site, size_t size) {
+
+    auto& counters = s_siteCounters[to_underlying(site)];
+
+    counters.reallocations.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+    counters.bytes_reallocated.fetchAdd(size, MemoryOrder::memory_order_relaxed);
+
+    countTowardsSample(site, size);
+}
+
+void profileFree(AllocationSite site, size_t size) {
+
+    auto& counters = s_siteCounters[to_underlying(site)];
+
+    counters.frees.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+    counters.bytes_freed.fetchAdd(size, MemoryOrder::memory_order_relaxed);
+}
+
+AllocationCounters allocationCounters(AllocationSite site) {
+
+    auto& counters = s_siteCounters[to_underlying(site)];
+
+    return {
+        counters.allocations.load(MemoryOrder::memory_order_relaxed),
+        counters.frees.load(MemoryOrder::memory_order_relaxed),
+        counters.reallocations.load(MemoryOrder::memory_order_relaxed),
+        counters.bytes_allocated.load(MemoryOrder::memory_order_relaxed),
+        counters.bytes_freed.load(MemoryOrder::memory_order_relaxed),
+        counters.bytes_reallocated.load(MemoryOrder::memory_order_relaxed),
+    };
+}
+
+void setAllocationSampleInterval(size_t bytes) {
+
+    s_sampleInterval.store(bytes, MemoryOrder::memory_order_relaxed);
+}
+
+void dumpAllocationProfile() {
+
+    // Everything is copied out before anything is printed: printing allocates too.
+
+    AllocationCounters counters[allocationSiteCount];
+
+    for (size_t i = 0; i < allocationSiteCount; ++i) {
+
+        counters[i] = allocationCounters(static_cast<AllocationSite>(i));
+    }
+
+    constexpr size_t reportedStacks = 10;
+
+    StackSample top_samples[reportedStacks];
+
+    size_t top_count = 0;
+
+    UInt64 dropped_samples;
+
+    {
+        SpinLocker locker { s_stackSamplesLock };
+
+        for (auto& sample : s_stackSamples) {
+
+            if (sample.samples == 0 || (top_count == reportedStacks && sample.bytes <= top_samples[top_count - 1].bytes)) {
+
+                continue;
+            }
+
+            auto index = min(top_count, reportedStacks - 1);
+
+            for (; index > 0 && top_samples[index - 1].bytes < sample.bytes; --index) {
+
+                top_samples[index] = top_samples[index - 1];
+            }
+
+            top_samples[index] = sample;
+
+            top_count = min(top_count + 1, reportedStacks);
+        }
+
+        dropped_samples = s_droppedSamples;
+    }
+
+    warnln("Allocation profile:");
+    warnln("{:>18} {:>12} {:>12} {:>12} {:>14} {:>14} {:>14}", "site", "allocations", "frees", "reallocations", "bytes", "bytes freed", "bytes realloc");
+
+    for (size_t i = 0; i < allocationSiteCount; ++i) {
+
+        auto& site_counters = counters[i];
+
+        warnln("{:>18} {:>12} {:>12} {:>12} {:>14} {:>14} {:>14}", allocationSiteName(static_cast<AllocationSite>(i)), site_counters.allocations, site_counters.frees, site_counters.reallocations, site_counters.bytes_allocated, site_counters.bytes_freed, site_counters.bytes_reallocated);
+    }
+
+#        if HAVE_BACKTRACE
+
+    warnln("Most allocated stacks, one sample per {} bytes ({} samples dropped):", s_sampleInterval.load(MemoryOrder::memory_order_relaxed), dropped_samples);
+
+    for (size_t i = 0; i < top_count; ++i) {
+
+        auto& sample = top_samples[i];
+
+        warnln("  ~{} bytes in {} samples, {}:", sample.bytes, sample.samples, allocationSiteName(sample.site));
+
+        auto** symbols = backtrace_symbols(sample.frames, sample.frame_count);
+
+        for (int frame = 0; frame < sample.frame_count; ++frame) {
+
+            if (symbols) {
+
+                warnln("    {}", symbols[frame]);
+            }
+            else {
+
+                warnln("    {:p}", sample.frames[frame]);
+            }
+        }
+
+        free(symbols);
+    }
+
+#        else
+
+    (void)top_count;
+    (void)dropped_samples;
+
+#        endif
+}
+
+#    else
+
+AllocationCounters allocationCounters(AllocationSite) { return { }; }
+
+void setAllocationSampleInterval(size_t) { }
+
+void dumpAllocationProfile() { warnln("Allocation profile: not compiled in, build with RUNTIME_ALLOCATION_PROFILING"); }
+
+#    endif
+
+void dumpAllocationProfileAtExit() {
+
+    static Atomic<bool> registered { false };
+
+    if (!registered.exchange(true)) {
+
+        atexit(dumpAllocationProfile);
+    }
+}
+
+#endif
+
 #if defined(__serenity__) && !defined(KERNEL)
 
 #    include "Assertions.h"
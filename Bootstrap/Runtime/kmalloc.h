@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "Atomic.h"
 #include "Checked.h"
 
 #if defined(KERNEL)
@@ -15,14 +16,263 @@
 #    include <new>
 #    include <stdlib.h>
 
-#    define kcalloc calloc
-#    define kmalloc malloc
-#    define kmalloc_good_size malloc_good_size
+// Whether small allocations come from the size-class slabs in kmalloc.cpp rather than from malloc(). Building with
+// -DRUNTIME_SLAB_ALLOCATOR=0 (the CMake option of the same name) hands everything to malloc().
 
-inline void kfree_sized(void* ptr, size_t)
+#    ifndef RUNTIME_SLAB_ALLOCATOR
+#        define RUNTIME_SLAB_ALLOCATOR 1
+#    endif
+
+#    if RUNTIME_SLAB_ALLOCATOR
+
+// Requests of up to kmallocMaxSlabSize bytes are rounded up to a size class: steps of 16 bytes up to 128, then four
+// classes per power of two. Each thread keeps a magazine of free blocks per class, refilled from and flushed to a
+// shared depot a batch at a time. Nothing is stored in front of a block: kfree_sized() finds the class from the size
+// alone, so the size it is given must round up to the same class as the one the block was allocated with.
+
+constexpr size_t kmallocMaxSlabSize = 2048;
+
+constexpr size_t kmallocSlabClassCount = 24;
+
+constexpr size_t kmallocSlabClass(size_t size)
 {
+    if (size <= 128)
+        return size ? (size - 1) >> 4 : 0;
+
+    size_t shift = sizeof(size_t) * 8 - 1 - __builtin_clzl(size - 1);
+
+    return 8 + (shift - 7) * 4 + (((size - 1) >> (shift - 2)) & 3);
+}
+
+constexpr size_t kmallocSlabClassSize(size_t slab_class)
+{
+    if (slab_class < 8)
+        return (slab_class + 1) * 16;
+
+    size_t base = static_cast<size_t>(128) << ((slab_class - 8) / 4);
+
+    return base + ((slab_class - 8) % 4 + 1) * (base / 4);
+}
+
+static_assert(kmallocSlabClass(kmallocMaxSlabSize) == kmallocSlabClassCount - 1);
+static_assert(kmallocSlabClassSize(kmallocSlabClassCount - 1) == kmallocMaxSlabSize);
+
+void* slabAllocate(size_t slab_class);
+void slabFree(void*, size_t slab_class);
+void* slabReallocate(void*, size_t);
+
+#    endif
+
+// Arena chunks are whole, aligned 64 KiB granules of address space, and a two-level map records which granules
+// belong to one. That lets kfree_sized() and krealloc() recognize arena memory wherever it turns up: on a thread
+// with no scope, or after the scope that allocated it has ended. The map covers 48-bit addresses; leaves are
+// allocated as chunks are registered and never freed.
+
+constexpr size_t arenaGranuleShift = 16;
+
+constexpr size_t arenaGranuleSize = static_cast<size_t>(1) << arenaGranuleShift;
+
+constexpr size_t arenaGranulesPerLeaf = static_cast<size_t>(1) << 16;
+
+constexpr size_t arenaGranuleLeafCount = (static_cast<UInt64>(1) << 48) / arenaGranuleSize / arenaGranulesPerLeaf;
+
+struct ArenaGranuleLeaf {
+    Atomic<UInt64> bits[arenaGranulesPerLeaf / 64];
+};
+
+extern Atomic<ArenaGranuleLeaf*> g_arenaGranuleMap[arenaGranuleLeafCount];
+
+ALWAYS_INLINE bool isArenaMemory(void const* ptr)
+{
+    auto address = reinterpret_cast<uintptr_t>(ptr) >> arenaGranuleShift;
+    if (address / arenaGranulesPerLeaf >= arenaGranuleLeafCount) [[unlikely]]
+        return false;
+    auto* leaf = g_arenaGranuleMap[address / arenaGranulesPerLeaf].load(MemoryOrder::memory_order_acquire);
+    if (!leaf) [[likely]]
+        return false;
+    auto granule = address % arenaGranulesPerLeaf;
+    return leaf->bits[granule / 64].load(MemoryOrder::memory_order_relaxed) & (static_cast<UInt64>(1) << (granule % 64));
+}
+
+void registerArenaChunk(void*, size_t);
+void unregisterArenaChunk(void*, size_t);
+
+// Allocation that bypasses any ArenaScope.
+
+inline void* kmallocOnHeap(size_t size)
+{
+#    if RUNTIME_SLAB_ALLOCATOR
+    if (size <= kmallocMaxSlabSize)
+        return slabAllocate(kmallocSlabClass(size));
+#    endif
+    return malloc(size);
+}
+
+inline void* kcallocOnHeap(size_t count, size_t size)
+{
+#    if RUNTIME_SLAB_ALLOCATOR
+    size_t total;
+    if (!__builtin_mul_overflow(count, size, &total) && total <= kmallocMaxSlabSize) {
+        auto* ptr = slabAllocate(kmallocSlabClass(total));
+        if (ptr)
+            __builtin_memset(ptr, 0, total);
+        return ptr;
+    }
+#    endif
+    return calloc(count, size);
+}
+
+inline void* kreallocOnHeap(void* ptr, size_t size)
+{
+    VERIFY(!isArenaMemory(ptr));
+#    if RUNTIME_SLAB_ALLOCATOR
+    return slabReallocate(ptr, size);
+#    else
+    return realloc(ptr, size);
+#    endif
+}
+
+inline void kfreeOnHeap(void* ptr, [[maybe_unused]] size_t size)
+{
+    VERIFY(!isArenaMemory(ptr));
+#    if RUNTIME_SLAB_ALLOCATOR
+    if (size <= kmallocMaxSlabSize) {
+        if (ptr)
+            slabFree(ptr, kmallocSlabClass(size));
+        return;
+    }
+#    endif
     free(ptr);
 }
+
+// With RUNTIME_ALLOCATION_PROFILING (the CMake option of the same name), every kmalloc(), kcalloc(), krealloc() and
+// kfree_sized() is counted against the AllocationSite its caller passes, and allocations are sampled every so many
+// bytes together with the stack they were made from. Without it the site arguments are never looked at.
+
+#    ifndef RUNTIME_ALLOCATION_PROFILING
+#        define RUNTIME_ALLOCATION_PROFILING 0
+#    endif
+
+enum class AllocationSite : UInt8 {
+    Other,
+    ArrayStorage,
+    HashTableBuckets,
+    StringImpl,
+    VectorBuffer,
+    Count,
+};
+
+struct AllocationCounters {
+    UInt64 allocations { 0 };
+    UInt64 frees { 0 };
+    UInt64 reallocations { 0 };
+    UInt64 bytes_allocated { 0 };
+    UInt64 bytes_freed { 0 };
+    UInt64 bytes_reallocated { 0 };
+};
+
+char const* allocationSiteName(AllocationSite);
+
+// All zeroes when profiling is compiled out.
+AllocationCounters allocationCounters(AllocationSite);
+
+// Roughly one allocation is sampled per `bytes` allocated on a thread; 0 stops sampling.
+void setAllocationSampleInterval(size_t bytes);
+
+// Writes the counters of every site and the stacks that were sampled most, by bytes, to stderr.
+void dumpAllocationProfile();
+void dumpAllocationProfileAtExit();
+
+#    if RUNTIME_ALLOCATION_PROFILING
+void profileAllocation(AllocationSite, size_t);
+void profileReallocation(AllocationSite, size_t);
+void profileFree(AllocationSite, size_t);
+#    endif
+
+// A heap buffer of `capacity` objects, the first `size` of them alive, that one container hands to another instead
+// of copying the objects out of it. Both sides must get their buffers from kmalloc() and free them with
+// kfree_sized(elements, capacity * sizeof(T)), so that the receiver can free what the giver allocated. The receiver
+// owns the objects and the memory from then on, and calls kmallocTransferBuffer() so that profiling attributes the
+// memory to it.
+
+template<typename T>
+struct KmallocBuffer {
+    T* elements { nullptr };
+    size_t size { 0 };
+    size_t capacity { 0 };
+    AllocationSite site { AllocationSite::Other };
+};
+
+template<typename T>
+inline void kmallocTransferBuffer([[maybe_unused]] KmallocBuffer<T> const& buffer, [[maybe_unused]] AllocationSite new_site)
+{
+#    if RUNTIME_ALLOCATION_PROFILING
+    profileFree(buffer.site, buffer.capacity * sizeof(T));
+    profileAllocation(new_site, buffer.capacity * sizeof(T));
+#    endif
+}
+
+// While an ArenaScope is alive on this thread, allocations come from its Arena (see Arena.h); otherwise from the
+// heap functions above.
+
+class ArenaScope;
+
+extern constinit thread_local ArenaScope* t_currentArenaScope;
+
+void* kmallocInArenaScope(size_t);
+void* kcallocInArenaScope(size_t, size_t);
+void* kreallocInArenaScope(void*, size_t);
+
+// Moves arena memory found outside of any scope over that arena to a fresh allocation, which comes from the current
+// scope or the heap.
+void* kreallocOutOfArena(void*, size_t);
+
+inline void* kmalloc(size_t size, [[maybe_unused]] AllocationSite site = AllocationSite::Other)
+{
+#    if RUNTIME_ALLOCATION_PROFILING
+    profileAllocation(site, size);
+#    endif
+    if (t_currentArenaScope) [[unlikely]]
+        return kmallocInArenaScope(size);
+    return kmallocOnHeap(size);
+}
+
+inline void* kcalloc(size_t count, size_t size, [[maybe_unused]] AllocationSite site = AllocationSite::Other)
+{
+#    if RUNTIME_ALLOCATION_PROFILING
+    profileAllocation(site, count * size);
+#    endif
+    if (t_currentArenaScope) [[unlikely]]
+        return kcallocInArenaScope(count, size);
+    return kcallocOnHeap(count, size);
+}
+
+inline void* krealloc(void* ptr, size_t size, [[maybe_unused]] AllocationSite site = AllocationSite::Other)
+{
+#    if RUNTIME_ALLOCATION_PROFILING
+    if (ptr)
+        profileReallocation(site, size);
+    else
+        profileAllocation(site, size);
+#    endif
+    if (t_currentArenaScope) [[unlikely]]
+        return kreallocInArenaScope(ptr, size);
+    if (isArenaMemory(ptr)) [[unlikely]]
+        return kreallocOutOfArena(ptr, size);
+    return kreallocOnHeap(ptr, size);
+}
+
+inline void kfree_sized(void* ptr, size_t size, [[maybe_unused]] AllocationSite site = AllocationSite::Other)
+{
+#    if RUNTIME_ALLOCATION_PROFILING
+    if (ptr)
+        profileFree(site, size);
+#    endif
+    // Freeing one arena allocation does nothing, whichever thread does it and whether or not its scope is over.
+    if (isArenaMemory(ptr)) [[unlikely]]
+        return;
+    kfreeOnHeap(ptr, size);
+}
 #endif
 
 #ifndef __serenity__
@@ -37,13 +287,28 @@ inline size_t malloc_good_size(size_t size) { return size; }
 #    endif
 #endif
 
+#if !defined(KERNEL)
+
+// How many bytes an allocation of `size` really gets, so that containers can grow into the slack.
+
+inline size_t kmalloc_good_size(size_t size)
+{
+#    if RUNTIME_SLAB_ALLOCATOR
+    if (size <= kmallocMaxSlabSize)
+        return kmallocSlabClassSize(kmallocSlabClass(size));
+#    endif
+    return malloc_good_size(size);
+}
+
+#endif
+
 using std::nothrow;
 
-inline void* kmalloc_array(Checked<size_t> a, Checked<size_t> b)
+inline void* kmalloc_array(Checked<size_t> a, Checked<size_t> b, AllocationSite site = AllocationSite::Other)
 {
     auto size = a * b;
     VERIFY(!size.hasOverflow());
-    return kmalloc(size.value());
+    return kmalloc(size.value(), site);
 }
 
 inline void* kmalloc_array(Checked<size_t> a, Checked<size_t> b, Checked<size_t> c)
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Runtime/Format.h"
+
+// The few pieces the programs in this directory share. Each test is an executable that exits with 0 when every
+// EXPECT() held; unlike VERIFY(), EXPECT() is checked in Release builds too and carries on after a failure.
+
+namespace Test {
+
+    inline size_t failureCount = 0;
+
+    inline int exitCode() {
+
+        if (failureCount) {
+
+            warnln("{} expectation(s) failed", failureCount);
+
+            return 1;
+        }
+
+        return 0;
+    }
+}
+
+#define EXPECT(expression)                                                                 \
+    do {                                                                                   \
+        if (!(expression)) {                                                               \
+            warnln("{}:{}: EXPECT({}) failed", __FILE__, __LINE__, #expression);           \
+            ++Test::failureCount;                                                          \
+        }                                                                                  \
+    } while (0)
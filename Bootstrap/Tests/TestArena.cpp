@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/Arena.h"
+#include "Runtime/FlyString.h"
+#include "Runtime/String.h"
+#include "Runtime/kmalloc.h"
+#include <pthread.h>
+#include <string.h>
+
+// Arena memory has to be recognized wherever it is released: on a thread without a scope, and after its scope is
+// over. Handing it to the heap allocator instead corrupts the heap.
+
+static constexpr size_t blockCount = 1000;
+
+static void* freeBlocks(void* argument) {
+
+    auto** blocks = static_cast<void**>(argument);
+
+    for (size_t i = 0; i < blockCount; ++i) {
+
+        kfree_sized(blocks[i], 16 + i % 64);
+    }
+
+    return nullptr;
+}
+
+static void testFreeingOnAnotherThread() {
+
+    Arena arena;
+
+    void* blocks[blockCount];
+
+    {
+        ArenaScope scope { arena };
+
+        for (size_t i = 0; i < blockCount; ++i) {
+
+            blocks[i] = kmalloc(16 + i % 64);
+
+            EXPECT(isArenaMemory(blocks[i]));
+        }
+
+        pthread_t thread;
+
+        auto rc = pthread_create(&thread, nullptr, freeBlocks, blocks);
+
+        EXPECT(rc == 0);
+
+        if (rc == 0) {
+
+            pthread_join(thread, nullptr);
+        }
+    }
+
+    // The heap must still be in one piece.
+
+    for (size_t i = 0; i < blockCount; ++i) {
+
+        auto* block = kmalloc(16 + i % 64);
+
+        EXPECT(block && !isArenaMemory(block));
+
+        kfree_sized(block, 16 + i % 64);
+    }
+}
+
+static void testReleasingAfterTheScope() {
+
+    Arena arena;
+
+    void* block = nullptr;
+
+    void* grown = nullptr;
+
+    {
+        ArenaScope scope { arena };
+
+        block = kmalloc(100);
+
+        grown = kmalloc(100);
+
+        memset(grown, 'x', 100);
+    }
+
+    kfree_sized(block, 100);
+
+    grown = krealloc(grown, 5000);
+
+    EXPECT(grown && !isArenaMemory(grown));
+
+    char expected[100];
+
+    memset(expected, 'x', sizeof(expected));
+
+    EXPECT(grown && memcmp(grown, expected, sizeof(expected)) == 0);
+
+    kfree_sized(grown, 5000);
+}
+
+static void testChunksAreForgotten() {
+
+    void* block = nullptr;
+
+    {
+        Arena arena;
+
+        ArenaScope scope { arena };
+
+        block = kmalloc(64);
+
+        EXPECT(isArenaMemory(block));
+
+        EXPECT(isArenaMemory(static_cast<UInt8*>(block) + Arena::defaultFirstChunkSize - 64));
+    }
+
+    EXPECT(!isArenaMemory(block));
+
+    auto* heap_block = kmalloc(64);
+
+    EXPECT(!isArenaMemory(heap_block));
+
+    kfree_sized(heap_block, 64);
+}
+
+// A String made inside a scope and interned by a thread with none must be copied into the intern table, not
+// adopted: the table outlives the scope.
+
+static char const* const longName = "an identifier too long to be stored inline";
+
+static void* internLongName(void* argument) {
+
+    auto* string = static_cast<String const*>(argument);
+
+    return new FlyString(*string);
+}
+
+static void testInterningFromAnotherThread() {
+
+    Arena arena;
+
+    FlyString* fly = nullptr;
+
+    {
+        ArenaScope scope { arena };
+
+        String string { longName };
+
+        EXPECT(isArenaMemory(string.impl()));
+
+        pthread_t thread;
+
+        void* result = nullptr;
+
+        if (pthread_create(&thread, nullptr, internLongName, &string) == 0) {
+
+            pthread_join(thread, &result);
+        }
+
+        fly = static_cast<FlyString*>(result);
+    }
+
+    EXPECT(fly && !isArenaMemory(fly->impl()));
+
+    // Hand the arena's memory out again.
+
+    {
+        ArenaScope scope { arena };
+
+        for (size_t i = 0; i < 100; ++i) {
+
+            memset(kmalloc(64), 'z', 64);
+        }
+    }
+
+    EXPECT(fly && *fly == longName);
+
+    delete fly;
+}
+
+int main() {
+
+    testFreeingOnAnotherThread();
+
+    testReleasingAfterTheScope();
+
+    testChunksAreForgotten();
+
+    testInterningFromAnotherThread();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Builtins/Array.h"
+#include "Runtime/Arena.h"
+#include "Runtime/String.h"
+
+using NeuInternal::ArrayStorage;
+
+static UInt64 s_randomState = 0xd1b54a32d192ed03;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+// Knows its own address, so a copy with memcpy where a move was due shows, and counts itself, so a leaked or twice
+// destroyed element shows too.
+
+struct Tracked {
+
+    static inline Int64 s_alive = 0;
+
+    static inline size_t s_misplaced = 0;
+
+    static inline size_t s_copies = 0;
+
+    Tracked(size_t value = 0)
+        : value(value), self(this) { ++s_alive; }
+
+    Tracked(Tracked const& other)
+        : value(other.value), self(this) { other.check(); ++s_alive; ++s_copies; }
+
+    Tracked(Tracked&& other)
+        : value(other.value), self(this) { other.check(); ++s_alive; }
+
+    Tracked& operator=(Tracked const& other) {
+
+        check();
+
+        other.check();
+
+        value = other.value;
+
+        ++s_copies;
+
+        return *this;
+    }
+
+    ~Tracked() {
+
+        check();
+
+        self = nullptr;
+
+        --s_alive;
+    }
+
+    void check() const { s_misplaced += self != this; }
+
+    bool operator==(Tracked const& other) const { return value == other.value; }
+
+    size_t value;
+
+    Tracked* self;
+};
+
+template<typename T>
+static T makeValue(size_t i) {
+
+    if constexpr (IsSame<T, String>) {
+
+        return String::formatted("element {} of an array of strings", i);
+    }
+    else {
+
+        return T(i);
+    }
+}
+
+template<typename T>
+static bool holdsValues(ArrayStorage<T>& storage, size_t count) {
+
+    if (storage.size() != count) {
+
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+
+        if (!(storage.at(i) == makeValue<T>(i))) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The first elements live in the storage's own allocation; growing moves them out to a buffer, and shrinkToFit()
+// brings them back once they fit again.
+
+template<typename T>
+static void testStorageMovesBetweenRegions() {
+
+    auto storage = MUST(ArrayStorage<T>::create(8));
+
+    EXPECT(storage->inlineCapacity() >= 8);
+
+    EXPECT(storage->isInline() && storage->capacity() == storage->inlineCapacity());
+
+    auto inline_capacity = storage->inlineCapacity();
+
+    for (size_t i = 0; i < inline_capacity; ++i) {
+
+        MUST(storage->push(makeValue<T>(i)));
+    }
+
+    EXPECT(storage->isInline());
+
+    MUST(storage->push(makeValue<T>(inline_capacity)));
+
+    EXPECT(!storage->isInline() && storage->capacity() > inline_capacity);
+
+    EXPECT(holdsValues(*storage, inline_capacity + 1));
+
+    for (size_t i = inline_capacity + 1; i < 1000; ++i) {
+
+        MUST(storage->push(makeValue<T>(i)));
+    }
+
+    EXPECT(holdsValues(*storage, 1000));
+
+    MUST(storage->shrinkToFit());
+
+    EXPECT(storage->capacity() == 1000 && !storage->isInline());
+
+    MUST(storage->resize(inline_capacity));
+
+    MUST(storage->shrinkToFit());
+
+    EXPECT(storage->isInline() && storage->capacity() == inline_capacity);
+
+    EXPECT(holdsValues(*storage, inline_capacity));
+
+    MUST(storage->ensureCapacity(inline_capacity * 3));
+
+    EXPECT(!storage->isInline() && holdsValues(*storage, inline_capacity));
+}
+
+// A storage with no inline region at all, which is what large first requests get.
+
+static void testHeaderOnlyStorage() {
+
+    auto storage = MUST(ArrayStorage<String>::create(0));
+
+    auto inline_capacity = storage->inlineCapacity();
+
+    for (size_t i = 0; i < inline_capacity + 10; ++i) {
+
+        MUST(storage->push(makeValue<String>(i)));
+    }
+
+    EXPECT(!storage->isInline() && holdsValues(*storage, inline_capacity + 10));
+}
+
+// Random pushes, pops and resizes on an Array, checked against a Vector of what each element was made from; 0 is
+// for the default-constructed elements resize() adds.
+
+template<typename T>
+static T expectedValue(size_t origin) { return origin ? makeValue<T>(origin) : T(); }
+
+template<typename T>
+static void fuzzArray() {
+
+    Array<T> array;
+
+    Vector<size_t> reference;
+
+    for (size_t step = 0; step < 20000; ++step) {
+
+        auto choice = random64() % 8;
+
+        if (choice < 5) {
+
+            MUST(array.push(makeValue<T>(step + 1)));
+
+            reference.append(step + 1);
+        }
+        else if (choice == 5 && !reference.isEmpty()) {
+
+            auto popped = array.pop();
+
+            EXPECT(popped.hasValue() && popped.value() == expectedValue<T>(reference.takeLast()));
+        }
+        else if (choice == 6) {
+
+            auto size = random64() % (reference.size() + 8);
+
+            MUST(array.resize(size));
+
+            while (reference.size() > size) {
+
+                reference.takeLast();
+            }
+
+            while (reference.size() < size) {
+
+                reference.append(0);
+            }
+        }
+        else {
+
+            MUST(array.shrinkToFit());
+        }
+    }
+
+    size_t wrong = array.size() != reference.size();
+
+    for (size_t i = 0; i < reference.size() && !wrong; ++i) {
+
+        wrong += !(array[i] == expectedValue<T>(reference[i]));
+    }
+
+    EXPECT(wrong == 0);
+}
+
+// A large first request must not be co-allocated with the header: once the array grew past it, that region would
+// be dead memory until the array goes away. Measured in an arena, where every byte handed out stays counted.
+
+static void testLargeFirstRequestIsNotInline() {
+
+    constexpr size_t count = 100000;
+
+    Arena arena { 1 << 20 };
+
+    {
+        ArenaScope scope { arena };
+
+        Array<UInt8> array;
+
+        MUST(array.ensureCapacity(count));
+
+        EXPECT(array.capacity() >= count);
+
+        for (size_t i = 0; i <= count; ++i) {
+
+            MUST(array.push(static_cast<UInt8>(i)));
+        }
+
+        EXPECT(array.size() == count + 1 && array[count] == static_cast<UInt8>(count));
+
+        EXPECT(arena.bytesUsed() < 2 * count);
+    }
+
+    Array<int> small { 1, 2, 3 };
+
+    EXPECT(small.size() == 3 && small[0] == 1 && small[2] == 3);
+
+    EXPECT(small.capacity() >= 3);
+}
+
+static size_t sum(Span<int const> values) {
+
+    size_t total = 0;
+
+    for (auto value : values) {
+
+        total += value;
+    }
+
+    return total;
+}
+
+static Array<int> makeCountingArray(size_t size) {
+
+    Array<int> array;
+
+    for (size_t i = 0; i < size; ++i) {
+
+        MUST(array.push(static_cast<int>(i)));
+    }
+
+    return array;
+}
+
+// A slice is a view: it covers at most the elements that exist, reads and writes through to the array, and follows
+// it as it grows, moves its elements out of line, or shrinks.
+
+static void testSliceBounds() {
+
+    auto array = makeCountingArray(10);
+
+    auto middle = array.slice(2, 5);
+
+    EXPECT(middle.size() == 5 && middle[0] == 2 && middle.at(4) == 6);
+
+    auto clamped = array.slice(7, 100);
+
+    EXPECT(clamped.size() == 3 && clamped[2] == 9);
+
+    auto at_end = array.slice(10, 5);
+
+    EXPECT(at_end.isEmpty() && at_end.begin() == at_end.end());
+
+    EXPECT(ArraySlice<int>().isEmpty());
+
+    middle[0] = 100;
+
+    EXPECT(array[2] == 100);
+
+    array[3] = 200;
+
+    EXPECT(middle[1] == 200);
+}
+
+static void testSliceIteration() {
+
+    auto array = makeCountingArray(20);
+
+    auto slice = array.slice(5, 10);
+
+    size_t total = 0;
+
+    size_t count = 0;
+
+    for (auto value : slice) {
+
+        total += value;
+
+        ++count;
+    }
+
+    EXPECT(count == 10 && total == 5 + 6 + 7 + 8 + 9 + 10 + 11 + 12 + 13 + 14);
+
+    EXPECT(sum(slice) == total);
+
+    auto span = slice.span();
+
+    EXPECT(span.size() == 10 && span.data() == &array[5]);
+
+    auto const& const_slice = slice;
+
+    EXPECT(const_slice.span().data() == span.data());
+}
+
+static void testSubslices() {
+
+    auto array = makeCountingArray(20);
+
+    auto slice = array.slice(4, 10);
+
+    auto inner = slice.subslice(2, 3);
+
+    EXPECT(inner.size() == 3 && inner[0] == 6 && inner[2] == 8);
+
+    auto rest = slice.subslice(7);
+
+    EXPECT(rest.size() == 3 && rest[0] == 11 && rest[2] == 13);
+
+    // Never reaches past the slice it was taken from, even where the array goes on.
+
+    auto clamped = slice.subslice(8, 50);
+
+    EXPECT(clamped.size() == 2 && clamped[1] == 13);
+
+    EXPECT(slice.subslice(10).isEmpty());
+
+    inner[1] = -1;
+
+    EXPECT(array[7] == -1 && slice[3] == -1);
+}
+
+static void testSlicesFollowTheArray() {
+
+    auto array = makeCountingArray(10);
+
+    auto slice = array.slice(2, 6);
+
+    // Growing far past the inline region moves the elements; the slice reads them wherever they are.
+
+    for (size_t i = 10; i < 1000; ++i) {
+
+        MUST(array.push(static_cast<int>(i)));
+    }
+
+    EXPECT(slice.size() == 6 && slice[0] == 2 && slice[5] == 7);
+
+    MUST(array.resize(5));
+
+    EXPECT(slice.size() == 3 && slice[2] == 4);
+
+    EXPECT(sum(slice) == 2 + 3 + 4);
+
+    MUST(array.resize(1));
+
+    EXPECT(slice.isEmpty() && slice.begin() == slice.end());
+
+    EXPECT(slice.span().size() == 0);
+
+    MUST(array.resize(4));
+
+    EXPECT(slice.size() == 2);
+}
+
+template<typename T>
+static Vector<T> makeVector(size_t count) {
+
+    Vector<T> vector;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        vector.append(makeValue<T>(i));
+    }
+
+    return vector;
+}
+
+template<typename T>
+static bool holdsValues(Span<T const> values, size_t count) {
+
+    if (values.size() != count) {
+
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+
+        if (!(values[i] == makeValue<T>(i))) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Moving a Vector into an Array, and a uniquely held Array into a Vector, hands the heap buffer over as it is.
+// Elements an Array keeps inline are moved one by one; shared arrays and const sources are copied, once.
+
+template<typename T>
+static void testVectorAndArrayConversions() {
+
+    for (size_t count : { 0, 1, 3, 100 }) {
+
+        auto vector = makeVector<T>(count);
+
+        auto* buffer = vector.data();
+
+        Array<T> array { move(vector) };
+
+        EXPECT(vector.isEmpty());
+
+        EXPECT(holdsValues<T>(array.span(), count));
+
+        if (count) {
+
+            EXPECT(array.unsafeData() == buffer);
+        }
+
+        auto back = MUST(move(array).toVector());
+
+        EXPECT(holdsValues<T>(back.span(), count));
+
+        if (count) {
+
+            EXPECT(back.data() == buffer);
+        }
+    }
+
+    // A small array keeps its elements inline, so they have to move into the vector's buffer.
+
+    Array<T> small;
+
+    for (size_t i = 0; i < 3; ++i) {
+
+        MUST(small.push(makeValue<T>(i)));
+    }
+
+    auto copies_before = Tracked::s_copies;
+
+    auto from_inline = MUST(move(small).toVector());
+
+    EXPECT(holdsValues<T>(from_inline.span(), 3));
+
+    EXPECT(Tracked::s_copies == copies_before);
+
+    // Another reference to the storage: the elements are copied, and the other array keeps them.
+
+    auto shared = Array<T> { makeVector<T>(100) };
+
+    auto other = shared;
+
+    copies_before = Tracked::s_copies;
+
+    auto copied = MUST(move(shared).toVector());
+
+    EXPECT(holdsValues<T>(copied.span(), 100) && holdsValues<T>(other.span(), 100));
+
+    EXPECT(copied.data() != other.unsafeData());
+
+    if constexpr (IsSame<T, Tracked>) {
+
+        EXPECT(Tracked::s_copies == copies_before + 100);
+    }
+
+    copies_before = Tracked::s_copies;
+
+    auto const& const_other = other;
+
+    auto from_const = MUST(const_other.toVector());
+
+    auto source = makeVector<T>(50);
+
+    Array<T> from_const_vector { source };
+
+    EXPECT(holdsValues<T>(from_const.span(), 100) && holdsValues<T>(other.span(), 100));
+
+    EXPECT(holdsValues<T>(from_const_vector.span(), 50) && holdsValues<T>(source.span(), 50));
+
+    if constexpr (IsSame<T, Tracked>) {
+
+        EXPECT(Tracked::s_copies == copies_before + 150);
+    }
+}
+
+int main() {
+
+    testStorageMovesBetweenRegions<int>();
+
+    testStorageMovesBetweenRegions<String>();
+
+    testStorageMovesBetweenRegions<Tracked>();
+
+    testHeaderOnlyStorage();
+
+    fuzzArray<size_t>();
+
+    fuzzArray<String>();
+
+    fuzzArray<Tracked>();
+
+    EXPECT(Tracked::s_alive == 0);
+
+    EXPECT(Tracked::s_misplaced == 0);
+
+    testLargeFirstRequestIsNotInline();
+
+    testSliceBounds();
+
+    testSliceIteration();
+
+    testSubslices();
+
+    testSlicesFollowTheArray();
+
+    testVectorAndArrayConversions<int>();
+
+    testVectorAndArrayConversions<String>();
+
+    testVectorAndArrayConversions<Tracked>();
+
+    EXPECT(Tracked::s_alive == 0);
+
+    EXPECT(Tracked::s_misplaced == 0);
+
+    return Test::exitCode();
+}
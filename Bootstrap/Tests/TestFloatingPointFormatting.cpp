@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/FloatingPointStringConversions.h"
+#include "Runtime/String.h"
+#include "Runtime/Vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static UInt64 s_randomState = 0x2545f4914f6cdd1d;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+static void testKnownValues() {
+
+    EXPECT(String::formatted("{}", 0.1) == "0.1");
+
+    EXPECT(String::formatted("{}", 123.0) == "123");
+
+    EXPECT(String::formatted("{}", -1.5) == "-1.5");
+
+    EXPECT(String::formatted("{}", 1e21) == "1e+21");
+
+    EXPECT(String::formatted("{}", 1e-7) == "1e-7");
+
+    EXPECT(String::formatted("{}", 5e-324) == "5e-324");
+
+    EXPECT(String::formatted("{}", 0.1f) == "0.1");
+
+    EXPECT(String::formatted("{:.3}", 2.0 / 3) == "0.667");
+
+    EXPECT(String::formatted("{:f}", 0.5) == "0.5");
+}
+
+// The shortest form reads back as the same value, and one digit fewer never does.
+
+static void testShortestRoundTrips() {
+
+    size_t mismatches = 0;
+
+    size_t longer_than_needed = 0;
+
+    for (size_t i = 0; i < 200'000; ++i) {
+
+        double value;
+
+        auto bits = random64();
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if (!isfinite(value) || value == 0) {
+
+            continue;
+        }
+
+        auto text = String::formatted("{}", value);
+
+        mismatches += strtod(text.characters(), nullptr) != value;
+
+        auto decimal = convertToShortestDecimal(fabs(value));
+
+        char digits[32];
+
+        auto digit_count = static_cast<int>(snprintf(digits, sizeof(digits), "%llu", static_cast<unsigned long long>(decimal.significand)));
+
+        if (digit_count > 1) {
+
+            char shorter[64];
+
+            snprintf(shorter, sizeof(shorter), "%.*e", digit_count - 2, value);
+
+            longer_than_needed += strtod(shorter, nullptr) == value;
+        }
+    }
+
+    EXPECT(mismatches == 0);
+
+    EXPECT(longer_than_needed == 0);
+}
+
+static void testFloatsRoundTrip() {
+
+    size_t mismatches = 0;
+
+    for (UInt32 exponent = 0; exponent < 255; ++exponent) {
+
+        for (size_t i = 0; i < 200; ++i) {
+
+            auto bits = (exponent << 23) | static_cast<UInt32>(random64() & 0x7fffff);
+
+            float value;
+
+            memcpy(&value, &bits, sizeof(value));
+
+            if (value == 0) {
+
+                continue;
+            }
+
+            auto text = String::formatted("{}", value);
+
+            mismatches += strtof(text.characters(), nullptr) != value;
+        }
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+// Fixed digits are the exact binary value rounded half-to-even, which is what glibc prints too.
+
+static bool fixedMatchesPrintf(double value, size_t precision) {
+
+    Vector<char, 128> digits;
+
+    if (appendFixedPointDigits(digits, value, precision).isError()) {
+
+        return false;
+    }
+
+    auto expected_length = snprintf(nullptr, 0, "%.*f", static_cast<int>(precision), value);
+
+    Vector<char> expected;
+
+    expected.resize(expected_length + 1);
+
+    snprintf(expected.data(), expected.size(), "%.*f", static_cast<int>(precision), value);
+
+    return digits.size() == static_cast<size_t>(expected_length) && memcmp(digits.data(), expected.data(), digits.size()) == 0;
+}
+
+static void testFixedDigits() {
+
+    EXPECT(fixedMatchesPrintf(0.5, 0));
+
+    EXPECT(fixedMatchesPrintf(1.5, 0));
+
+    EXPECT(fixedMatchesPrintf(2.5, 0));
+
+    EXPECT(fixedMatchesPrintf(0.125, 2));
+
+    EXPECT(fixedMatchesPrintf(1e308, 0));
+
+    EXPECT(fixedMatchesPrintf(5e-324, 1100));
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 50'000; ++i) {
+
+        // Exponents from about 2^-70 to 2^70, where both the 128-bit and the big integer paths are taken.
+
+        auto bits = (static_cast<UInt64>(953 + random64() % 140) << 52) | (random64() & ((static_cast<UInt64>(1) << 52) - 1));
+
+        double value;
+
+        memcpy(&value, &bits, sizeof(value));
+
+        mismatches += !fixedMatchesPrintf(value, random64() % 40);
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+int main() {
+
+    testKnownValues();
+
+    testShortestRoundTrips();
+
+    testFloatsRoundTrip();
+
+    testFixedDigits();
+
+    return Test::exitCode();
+}
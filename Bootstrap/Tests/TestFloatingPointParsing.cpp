@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/FloatingPointStringConversions.h"
+#include "Runtime/String.h"
+#include "Runtime/StringView.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static UInt64 s_randomState = 0x9e3779b97f4a7c15;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+// Both the value and where parsing stopped have to agree with glibc, which rounds correctly.
+
+static bool parsesLikeStrtod(char const* text) {
+
+    auto length = strlen(text);
+
+    auto result = parseFirstFloatingPoint<double>(text, text + length);
+
+    char* expected_end = nullptr;
+
+    auto expected = strtod(text, &expected_end);
+
+    if (result.endPointer != expected_end) {
+
+        return false;
+    }
+
+    return isnan(expected) ? isnan(result.value) : memcmp(&expected, &result.value, sizeof(expected)) == 0;
+}
+
+static bool parsesLikeStrtof(char const* text) {
+
+    auto length = strlen(text);
+
+    auto result = parseFirstFloatingPoint<float>(text, text + length);
+
+    char* expected_end = nullptr;
+
+    auto expected = strtof(text, &expected_end);
+
+    return result.endPointer == expected_end && memcmp(&expected, &result.value, sizeof(expected)) == 0;
+}
+
+static void testKnownValues() {
+
+    EXPECT(StringView("0.1").to_double() == 0.1);
+
+    EXPECT(StringView("-2.5e-3").to_double() == -2.5e-3);
+
+    EXPECT(StringView("1.5").to_float() == 1.5f);
+
+    EXPECT(!StringView("1.5x").to_double().hasValue());
+
+    EXPECT(!StringView("").to_double().hasValue());
+
+    EXPECT(String(" 42.25 ").to_double() == 42.25);
+
+    // Hex floats are deliberately not accepted, so they are left out here.
+
+    static char const* const edge_cases[] = { "inf", "-infinity", "nan", "1e400", "1e-400", "12e", "1.e5", ".5", "-", "+.e1", "007", "1e+", "4.9e-324", "2.4703282292062328e-324" };
+
+    for (auto const* text : edge_cases) {
+
+        EXPECT(parsesLikeStrtod(text));
+    }
+}
+
+static void testRandomLiterals() {
+
+    char text[64];
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 200'000; ++i) {
+
+        double value;
+
+        auto bits = random64();
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if (!isfinite(value)) {
+
+            continue;
+        }
+
+        snprintf(text, sizeof(text), "%.17g", value);
+
+        mismatches += !parsesLikeStrtod(text);
+
+        snprintf(text, sizeof(text), "%.3f", fmod(value, 1e6));
+
+        mismatches += !parsesLikeStrtod(text);
+
+        // Up to 25 random digits with a random exponent, which takes the slow path now and then.
+
+        auto digits = 1 + random64() % 25;
+
+        size_t length = 0;
+
+        for (size_t digit = 0; digit < digits; ++digit) {
+
+            text[length++] = static_cast<char>('0' + random64() % 10);
+
+            if (digit == 0 && digits > 1) {
+
+                text[length++] = '.';
+            }
+        }
+
+        snprintf(text + length, sizeof(text) - length, "e%d", static_cast<int>(random64() % 700) - 350);
+
+        mismatches += !parsesLikeStrtod(text);
+
+        mismatches += !parsesLikeStrtof(text);
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+// Exactly halfway between two neighbouring doubles, written out in full, and the same nudged up by a last digit.
+
+static void testHalfwayPoints() {
+
+    static char text[900];
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 2000; ++i) {
+
+        double value;
+
+        auto bits = random64() & ~(static_cast<UInt64>(1) << 63);
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if (!isfinite(value) || !isfinite(nextafter(value, INFINITY))) {
+
+            continue;
+        }
+
+        auto halfway = (static_cast<long double>(value) + static_cast<long double>(nextafter(value, INFINITY))) / 2;
+
+        snprintf(text, sizeof(text), "%.780Le", halfway);
+
+        mismatches += !parsesLikeStrtod(text);
+
+        auto* exponent = strchr(text, 'e');
+
+        memmove(exponent + 1, exponent, strlen(exponent) + 1);
+
+        *exponent = '1';
+
+        mismatches += !parsesLikeStrtod(text);
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+// What the formatter writes, the parser reads back unchanged.
+
+static void testFormattingRoundTrips() {
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 100'000; ++i) {
+
+        double value;
+
+        auto bits = random64();
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if (!isfinite(value)) {
+
+            continue;
+        }
+
+        mismatches += String::formatted("{}", value).to_double() != value;
+
+        auto single = static_cast<float>(value);
+
+        if (isfinite(single)) {
+
+            mismatches += String::formatted("{}", single).to_float() != single;
+        }
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+int main() {
+
+    testKnownValues();
+
+    testRandomLiterals();
+
+    testHalfwayPoints();
+
+    testFormattingRoundTrips();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/FlyString.h"
+#include "Runtime/HashMap.h"
+#include "Runtime/String.h"
+#include "Runtime/Vector.h"
+#include <pthread.h>
+
+static String makeName(size_t i) {
+
+    return String::formatted("an identifier long enough for a StringImpl #{}", i);
+}
+
+// Whatever a FlyString is made from, equal characters end up in one StringImpl.
+
+static void testEqualStringsShareOneImpl() {
+
+    auto name = makeName(0);
+
+    FlyString from_string { name };
+
+    FlyString from_view { name.view() };
+
+    FlyString from_characters { name.characters() };
+
+    auto interned = name.intern();
+
+    EXPECT(from_string.impl() == from_view.impl());
+
+    EXPECT(from_string.impl() == from_characters.impl());
+
+    EXPECT(from_string.impl() == interned.impl());
+
+    EXPECT(from_string == from_view && from_view == interned);
+
+    EXPECT(from_string == name && from_string == name.view() && from_string == name.characters());
+
+    EXPECT(from_string.hash() == name.hash());
+
+    FlyString other { makeName(1) };
+
+    EXPECT(other != from_string);
+
+    EXPECT(other.impl() != from_string.impl());
+
+    // Short strings live inline in a String, so their FlyString needs an impl of its own, but one all the same.
+
+    FlyString short_one { "x" };
+
+    EXPECT(short_one.impl() == FlyString(String("x")).impl());
+
+    EXPECT(short_one.length() == 1 && short_one == "x");
+
+    EXPECT(FlyString().isNull());
+
+    EXPECT(FlyString("").isEmpty());
+}
+
+// A String nobody else holds hands its StringImpl over instead of having it copied.
+
+static void testInterningAdoptsHeapStrings() {
+
+    auto name = makeName(2);
+
+    auto* impl = name.impl();
+
+    FlyString fly { name };
+
+    EXPECT(fly.impl() == impl);
+}
+
+// The table does not keep its strings alive: entries go with the last reference, whether that was a FlyString or
+// a String made from one.
+
+static void testEntriesGoWithTheirLastReference() {
+
+    auto before = FlyString::internedCount();
+
+    {
+        Vector<FlyString> names;
+
+        for (size_t i = 0; i < 100; ++i) {
+
+            names.append(FlyString(makeName(i)));
+        }
+
+        EXPECT(FlyString::internedCount() == before + 100);
+
+        for (size_t i = 0; i < 100; ++i) {
+
+            names.append(FlyString(makeName(i)));
+        }
+
+        EXPECT(FlyString::internedCount() == before + 100);
+
+        String survivor { *names[0].impl() };
+
+        names.clear();
+
+        EXPECT(FlyString::internedCount() == before + 1);
+
+        EXPECT(FlyString(makeName(0)).impl() == survivor.impl());
+    }
+
+    EXPECT(FlyString::internedCount() == before);
+}
+
+static void testLookupsByView() {
+
+    HashMap<FlyString, size_t> map;
+
+    for (size_t i = 0; i < 100; ++i) {
+
+        MUST(map.set(FlyString(makeName(i)), i));
+    }
+
+    size_t misses = 0;
+
+    for (size_t i = 0; i < 100; ++i) {
+
+        auto name = makeName(i);
+
+        misses += map.get(FlyString(name)) != i;
+
+        misses += !map.contains(name.view());
+    }
+
+    EXPECT(misses == 0);
+
+    EXPECT(!map.contains(makeName(100).view()));
+}
+
+// Threads intern, drop and re-intern the same names at once. Whatever they hold at the end has to be shared, and
+// once they are gone every entry has to be gone too.
+
+static constexpr size_t threadCount = 4;
+
+static constexpr size_t nameCount = 200;
+
+static void* internNames(void* argument) {
+
+    auto& kept = *static_cast<Vector<FlyString>*>(argument);
+
+    for (size_t round = 0; round < 50; ++round) {
+
+        for (size_t i = 0; i < nameCount; ++i) {
+
+            FlyString fly { makeName(i) };
+
+            if (round % 2) {
+
+                kept[i] = fly;
+            }
+            else {
+
+                kept[i] = FlyString();
+            }
+        }
+    }
+
+    for (size_t i = 0; i < nameCount; ++i) {
+
+        kept[i] = FlyString(makeName(i));
+    }
+
+    return nullptr;
+}
+
+static void testInterningFromManyThreads() {
+
+    auto before = FlyString::internedCount();
+
+    {
+        Vector<FlyString> kept[threadCount];
+
+        pthread_t threads[threadCount];
+
+        bool started[threadCount];
+
+        for (size_t t = 0; t < threadCount; ++t) {
+
+            kept[t].resize(nameCount);
+
+            started[t] = pthread_create(&threads[t], nullptr, internNames, &kept[t]) == 0;
+
+            EXPECT(started[t]);
+        }
+
+        for (size_t t = 0; t < threadCount; ++t) {
+
+            if (started[t]) {
+
+                pthread_join(threads[t], nullptr);
+            }
+        }
+
+        size_t unshared = 0;
+
+        for (size_t t = 0; t < threadCount; ++t) {
+
+            for (size_t i = 0; i < nameCount && started[t]; ++i) {
+
+                unshared += kept[t][i].impl() != kept[0][i].impl() || kept[t][i] != makeName(i);
+            }
+        }
+
+        EXPECT(unshared == 0);
+
+        EXPECT(FlyString::internedCount() == before + nameCount);
+    }
+
+    EXPECT(FlyString::internedCount() == before);
+}
+
+int main() {
+
+    testEqualStringsShareOneImpl();
+
+    testInterningAdoptsHeapStrings();
+
+    testEntriesGoWithTheirLastReference();
+
+    testLookupsByView();
+
+    testInterningFromManyThreads();
+
+    return Test::exitCode();
+}
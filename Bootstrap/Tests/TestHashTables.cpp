@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/HashTable.h"
+#include "Runtime/String.h"
+#include "Runtime/SwissHashTable.h"
+#include "Runtime/Traits.h"
+#include "Runtime/Vector.h"
+
+static UInt64 s_randomState = 0xda942042e4dd58b5;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+// Hashes from good to degenerate: the last two put every key in one of four buckets, or all of them in the same
+// one, so probes run long and every removal has neighbours to deal with. With one hash, probes also get longer
+// than HashTable's state byte can record.
+
+struct FullHash : public Traits<UInt32> { };
+
+struct FourHashes : public GenericTraits<UInt32> {
+
+    static constexpr bool isTrivial() { return true; }
+
+    static unsigned hash(UInt32 value) { return value & 3; }
+};
+
+struct OneHash : public GenericTraits<UInt32> {
+
+    static constexpr bool isTrivial() { return true; }
+
+    static unsigned hash(UInt32) { return 0; }
+};
+
+struct CollidingStrings : public Traits<String> {
+
+    static unsigned hash(String const& value) { return value.length() & 1; }
+};
+
+static UInt32 keyOf(UInt32 value) { return value; }
+
+static UInt32 keyOf(String const& value) { return value.view().substringView(0, 6).to_uint<UInt32>().value(); }
+
+template<typename T>
+static T makeValue(UInt32 key) {
+
+    if constexpr (IsSame<T, String>) {
+
+        // Long enough to live in a StringImpl, so a value that is lost or freed twice shows up.
+
+        return String::formatted("{:06} is the value of this key", key);
+    }
+    else {
+
+        return key;
+    }
+}
+
+// Runs random sets, removals, lookups, iterations, copies and bulk removals against a plain array of flags, and
+// checks that the table holds exactly the flagged keys.
+
+template<typename T, typename Table>
+static void fuzzAgainstReference(size_t key_space, size_t operation_count) {
+
+    Table table;
+
+    Vector<bool> present;
+
+    present.resize(key_space);
+
+    size_t present_count = 0;
+
+    size_t mismatches = 0;
+
+    auto matchesReference = [&](Table const& candidate) {
+
+        if (candidate.size() != present_count) {
+
+            return false;
+        }
+
+        size_t seen = 0;
+
+        for (auto const& value : candidate) {
+
+            auto key = keyOf(value);
+
+            if (key >= key_space || !present[key]) {
+
+                return false;
+            }
+
+            ++seen;
+        }
+
+        return seen == present_count;
+    };
+
+    for (size_t operation = 0; operation < operation_count; ++operation) {
+
+        auto key = static_cast<UInt32>(random64() % key_space);
+
+        auto choice = random64() % 1000;
+
+        if (choice < 450) {
+
+            auto result = table.set(makeValue<T>(key));
+
+            mismatches += (result == HashSetResult::InsertedNewEntry) == present[key];
+
+            present_count += !present[key];
+
+            present[key] = true;
+        }
+        else if (choice < 750) {
+
+            mismatches += table.remove(makeValue<T>(key)) != present[key];
+
+            present_count -= present[key];
+
+            present[key] = false;
+        }
+        else if (choice < 900) {
+
+            mismatches += table.contains(makeValue<T>(key)) != present[key];
+        }
+        else if (choice < 950) {
+
+            auto it = table.find(makeValue<T>(key));
+
+            mismatches += (it != table.end()) != present[key];
+
+            if (it != table.end()) {
+
+                table.remove(it);
+
+                present_count -= 1;
+
+                present[key] = false;
+            }
+        }
+        else if (choice < 980) {
+
+            mismatches += !matchesReference(table);
+        }
+        else if (choice < 990) {
+
+            Table copy = table;
+
+            mismatches += !matchesReference(copy);
+
+            Table moved = move(copy);
+
+            mismatches += !matchesReference(moved);
+        }
+        else if (choice < 997) {
+
+            auto divisor = 2 + random64() % 5;
+
+            table.removeAllMatching([&](auto const& value) { return keyOf(value) % divisor == 0; });
+
+            for (size_t i = 0; i < key_space; i += divisor) {
+
+                present_count -= present[i];
+
+                present[i] = false;
+            }
+        }
+        else {
+
+            table.clearWithCapacity();
+
+            for (auto&& flag : present) {
+
+                flag = false;
+            }
+
+            present_count = 0;
+        }
+    }
+
+    mismatches += !matchesReference(table);
+
+    EXPECT(mismatches == 0);
+}
+
+template<template<typename, typename> typename Table>
+static void fuzzEveryHash() {
+
+    fuzzAgainstReference<UInt32, Table<UInt32, FullHash>>(5000, 200'000);
+
+    fuzzAgainstReference<UInt32, Table<UInt32, FourHashes>>(600, 50'000);
+
+    fuzzAgainstReference<UInt32, Table<UInt32, OneHash>>(400, 20'000);
+
+    fuzzAgainstReference<String, Table<String, CollidingStrings>>(300, 30'000);
+
+    fuzzAgainstReference<String, Table<String, Traits<String>>>(3000, 100'000);
+}
+
+template<typename T, typename TraitsForT>
+using UnorderedHashTable = HashTable<T, TraitsForT, false>;
+
+template<typename T, typename TraitsForT>
+using InsertionOrderedHashTable = HashTable<T, TraitsForT, true>;
+
+// Ordered tables iterate in insertion order, however their buckets are shifted around by insertions, removals
+// and rehashes.
+
+template<typename TraitsForT>
+static void testInsertionOrderIsKept() {
+
+    HashTable<UInt32, TraitsForT, true> table;
+
+    Vector<UInt32> order;
+
+    size_t mismatches = 0;
+
+    for (size_t operation = 0; operation < 20'000; ++operation) {
+
+        auto key = static_cast<UInt32>(random64() % 1000);
+
+        if (random64() % 3) {
+
+            if (table.set(key) == HashSetResult::InsertedNewEntry) {
+
+                order.append(key);
+            }
+        }
+        else if (table.remove(key)) {
+
+            order.removeFirstMatching([&](UInt32 value) { return value == key; });
+        }
+
+        if (operation % 500 == 0) {
+
+            size_t i = 0;
+
+            for (auto value : table) {
+
+                mismatches += i >= order.size() || order[i] != value;
+
+                ++i;
+            }
+
+            mismatches += i != order.size();
+        }
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+int main() {
+
+    fuzzEveryHash<SwissHashTable>();
+
+    fuzzEveryHash<UnorderedHashTable>();
+
+    fuzzEveryHash<InsertionOrderedHashTable>();
+
+    testInsertionOrderIsKept<FullHash>();
+
+    testInsertionOrderIsKept<FourHashes>();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Builtins/Dictionary.h"
+#include "Builtins/Set.h"
+#include "Runtime/Arena.h"
+#include "Runtime/String.h"
+#include "Runtime/StringView.h"
+
+static constexpr size_t keyCount = 1000;
+
+// Half the keys fit inline in a String, half need a StringImpl, so both hash paths get looked up.
+
+static String makeKey(size_t i) {
+
+    if (i % 2) {
+
+        return String::formatted("key {}", i);
+    }
+
+    return String::formatted("a key long enough to need a StringImpl, number {}", i);
+}
+
+static Dictionary<String, size_t> makeDictionary() {
+
+    Dictionary<String, size_t> dictionary;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        MUST(dictionary.set(makeKey(i), i));
+    }
+
+    return dictionary;
+}
+
+// Lookups by StringView and char const* find what lookups by String find.
+
+static void testDictionaryLookups() {
+
+    auto dictionary = makeDictionary();
+
+    size_t misses = 0;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        auto key = makeKey(i);
+
+        StringView view = key;
+
+        char const* characters = key.characters();
+
+        misses += dictionary.get(view) != i;
+
+        misses += dictionary.get(characters) != i;
+
+        misses += !dictionary.contains(view) || !dictionary.contains(characters);
+
+        misses += dictionary[view] != i || dictionary[characters] != i;
+
+        auto hash = Dictionary<String, size_t>::keyHash(view);
+
+        misses += hash != Dictionary<String, size_t>::keyHash(key);
+
+        misses += dictionary.get(view, hash) != i || !dictionary.contains(characters, hash);
+    }
+
+    EXPECT(misses == 0);
+
+    // Keys that are absent, including prefixes and extensions of present ones and the empty key.
+
+    static char const* const absent[] = { "", "key", "key 1000", "key 11 ", "Key 1", "a key long enough to need a StringImpl, number 1" };
+
+    for (auto const* characters : absent) {
+
+        StringView view { characters };
+
+        EXPECT(!dictionary.contains(view));
+
+        EXPECT(!dictionary.contains(characters));
+
+        EXPECT(!dictionary.get(view).hasValue());
+
+        EXPECT(!dictionary.get(view, Dictionary<String, size_t>::keyHash(view)).hasValue());
+    }
+
+    // Removal by view takes out exactly the matching entry.
+
+    for (size_t i = 0; i < keyCount; i += 3) {
+
+        auto key = makeKey(i);
+
+        EXPECT(dictionary.remove(StringView { key }));
+
+        EXPECT(!dictionary.remove(key.characters()));
+    }
+
+    size_t wrong = 0;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        auto key = makeKey(i);
+
+        wrong += dictionary.contains(StringView { key }) == (i % 3 == 0);
+    }
+
+    EXPECT(wrong == 0);
+
+    EXPECT(dictionary.size() == keyCount - (keyCount + 2) / 3);
+}
+
+static void testSetLookups() {
+
+    auto set = MUST(Set<String>::create_empty());
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        MUST(set.add(makeKey(i)));
+    }
+
+    size_t misses = 0;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        auto key = makeKey(i);
+
+        StringView view = key;
+
+        misses += !set.contains(view) || !set.contains(key.characters());
+
+        misses += !set.contains(view, Set<String>::valueHash(view));
+    }
+
+    EXPECT(misses == 0);
+
+    EXPECT(!set.contains(StringView { "key 1000" }));
+
+    EXPECT(set.remove(StringView { "key 1" }));
+
+    EXPECT(!set.contains("key 1"));
+
+    EXPECT(!set.remove("key 1"));
+
+    EXPECT(set.size() == keyCount - 1);
+}
+
+// None of the lookups by view or with a known hash builds a String, so none of them allocates: everything the
+// thread allocates inside the scope would come out of the arena.
+
+static void testLookupsDoNotAllocate() {
+
+    auto dictionary = makeDictionary();
+
+    auto set = MUST(Set<String>::create_empty());
+
+    Vector<String> keys;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+
+        keys.append(makeKey(i));
+
+        MUST(set.add(keys.last()));
+    }
+
+    Arena arena;
+
+    size_t found = 0;
+
+    {
+        ArenaScope scope { arena };
+
+        for (auto& key : keys) {
+
+            StringView view = key;
+
+            char const* characters = key.characters();
+
+            auto hash = Dictionary<String, size_t>::keyHash(view);
+
+            found += dictionary.contains(view) + dictionary.contains(characters) + dictionary.contains(view, hash);
+
+            found += dictionary.get(view).hasValue() + dictionary.get(characters, hash).hasValue();
+
+            found += set.contains(view) + set.contains(characters, hash);
+        }
+
+        EXPECT(arena.bytesUsed() == 0);
+    }
+
+    EXPECT(found == 7 * keyCount);
+}
+
+int main() {
+
+    testDictionaryLookups();
+
+    testSetLookups();
+
+    testLookupsDoNotAllocate();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/NumericLimits.h"
+#include "Runtime/Optional.h"
+#include "Runtime/String.h"
+#include "Runtime/StringUtils.h"
+#include "Runtime/StringView.h"
+#include "Runtime/Vector.h"
+#include <string.h>
+
+static UInt64 s_randomState = 0x853c49e6748fea9b;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+// A digit at a time with an overflow check per digit, the way convert_to_int and convert_to_uint used to work.
+
+template<typename T>
+static Optional<T> referenceParse(StringView string) {
+
+    if (string.isEmpty()) {
+
+        return { };
+    }
+
+    size_t i = 0;
+
+    bool negative = false;
+
+    if (string[0] == '-' || string[0] == '+') {
+
+        // Unsigned values take no sign at all.
+
+        if (string.length() == 1 || !IsSigned<T>) {
+
+            return { };
+        }
+
+        negative = string[0] == '-';
+
+        ++i;
+    }
+
+    T value = 0;
+
+    for (; i < string.length(); ++i) {
+
+        if (string[i] < '0' || string[i] > '9') {
+
+            return { };
+        }
+
+        T digit = string[i] - '0';
+
+        if (__builtin_mul_overflow(value, static_cast<T>(10), &value)) {
+
+            return { };
+        }
+
+        if (negative ? __builtin_sub_overflow(value, digit, &value) : __builtin_add_overflow(value, digit, &value)) {
+
+            return { };
+        }
+    }
+
+    return value;
+}
+
+// Adds one to the digits of a decimal string, leaving any sign alone.
+
+static String incrementMagnitude(StringView string) {
+
+    auto negative = string[0] == '-';
+
+    auto magnitude = negative ? string.substringView(1) : string;
+
+    // One spare digit in front for the carry.
+
+    char digits[32];
+
+    digits[0] = '0';
+
+    memcpy(digits + 1, magnitude.charactersWithoutNullTermination(), magnitude.length());
+
+    for (auto i = magnitude.length() + 1; i-- > 0;) {
+
+        if (digits[i] != '9') {
+
+            ++digits[i];
+
+            break;
+        }
+
+        digits[i] = '0';
+    }
+
+    auto start = digits[0] == '0' ? 1 : 0;
+
+    return String::formatted("{}{}", negative ? "-" : "", StringView(digits + start, magnitude.length() + 1 - start));
+}
+
+template<typename T>
+static Optional<T> parse(StringView string) {
+
+    if constexpr (IsSigned<T>) {
+
+        return StringUtils::convert_to_int<T>(string, TrimWhitespace::No);
+    }
+    else {
+
+        return StringUtils::convert_to_uint<T>(string, TrimWhitespace::No);
+    }
+}
+
+// Random digit strings of every length around the eight-digit chunks, with signs, leading zeros, stray characters
+// and the values on either side of each limit.
+
+template<typename T>
+static void testAgainstReference() {
+
+    static char const alphabet[] = "0123456789000999+- x:/";
+
+    size_t mismatches = 0;
+
+    char text[32];
+
+    for (size_t i = 0; i < 300'000; ++i) {
+
+        auto length = random64() % 26;
+
+        for (size_t j = 0; j < length; ++j) {
+
+            auto pick = random64() % 100;
+
+            text[j] = pick < 95 ? static_cast<char>('0' + pick % 10) : alphabet[random64() % (sizeof(alphabet) - 1)];
+        }
+
+        if (length && random64() % 4 == 0) {
+
+            text[0] = random64() % 2 ? '-' : '+';
+        }
+
+        StringView string { text, length };
+
+        mismatches += parse<T>(string) != referenceParse<T>(string);
+    }
+
+    // Each limit, the values just inside it, and the decimal strings just past it.
+
+    for (auto limit : { NumericLimits<T>::max(), NumericLimits<T>::min() }) {
+
+        auto inward = limit == NumericLimits<T>::max() ? -1 : 1;
+
+        for (int step = 0; step < 4; ++step) {
+
+            auto string = String::formatted("{}", static_cast<T>(limit + inward * step));
+
+            mismatches += parse<T>(string.view()) != referenceParse<T>(string.view());
+        }
+
+        auto digits = String::formatted("{}", limit);
+
+        for (int step = 0; step < 3; ++step) {
+
+            digits = incrementMagnitude(digits.view());
+
+            mismatches += parse<T>(digits.view()) != referenceParse<T>(digits.view());
+        }
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+// What the formatter writes, the parser reads back unchanged.
+
+template<typename T>
+static void testFormattingRoundTrips() {
+
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < 100'000; ++i) {
+
+        // Values of every magnitude, not only the ones near the limits that plain random bits give.
+
+        auto value = static_cast<T>(random64() >> (random64() % 64));
+
+        mismatches += parse<T>(String::formatted("{}", value).view()) != value;
+    }
+
+    mismatches += parse<T>(String::formatted("{}", NumericLimits<T>::max()).view()) != NumericLimits<T>::max();
+
+    mismatches += parse<T>(String::formatted("{}", NumericLimits<T>::min()).view()) != NumericLimits<T>::min();
+
+    EXPECT(mismatches == 0);
+}
+
+static void testWhitespaceAndBatches() {
+
+    EXPECT(StringUtils::convert_to_int<Int32>(" -42\n") == -42);
+
+    EXPECT(!StringUtils::convert_to_int<Int32>(" -42\n", TrimWhitespace::No).hasValue());
+
+    EXPECT(String("123456789012").to_uint<UInt64>() == 123456789012ull);
+
+    StringView good[] = { "1", "-22", "333333333", "+4" };
+
+    auto values = StringUtils::convert_to_int<Int32>(ReadOnlySpan<StringView>(good, 4));
+
+    EXPECT(values.hasValue() && values->size() == 4 && (*values)[1] == -22 && (*values)[2] == 333333333);
+
+    StringView bad[] = { "1", "2x", "3" };
+
+    EXPECT(!StringUtils::convert_to_int<Int32>(ReadOnlySpan<StringView>(bad, 3)).hasValue());
+
+    EXPECT(!StringUtils::convert_to_uint<UInt8>(ReadOnlySpan<StringView>(good, 1)).value().isEmpty());
+}
+
+int main() {
+
+    testAgainstReference<Int8>();
+    testAgainstReference<Int16>();
+    testAgainstReference<Int32>();
+    testAgainstReference<long long>();
+    testAgainstReference<UInt8>();
+    testAgainstReference<UInt16>();
+    testAgainstReference<UInt32>();
+    testAgainstReference<unsigned long long>();
+
+    testFormattingRoundTrips<Int8>();
+    testFormattingRoundTrips<Int32>();
+    testFormattingRoundTrips<long long>();
+    testFormattingRoundTrips<UInt16>();
+    testFormattingRoundTrips<unsigned long long>();
+
+    testWhitespaceAndBatches();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/Atomic.h"
+#include "Runtime/ParallelAlgorithms.h"
+#include "Runtime/ThreadPool.h"
+#include "Runtime/Vector.h"
+
+// Concatenating intervals is associative but not commutative: an interval that is joined to one it does not follow
+// directly comes out broken, so any reordering of the values shows up in the result.
+
+struct Interval {
+
+    int first;
+
+    int last;
+
+    bool unbroken { true };
+};
+
+static void testReduceKeepsTheOrder(ThreadPool& pool) {
+
+    auto concatenate = [](Interval a, Interval b) {
+
+        return Interval { a.first, b.last, a.unbroken && b.unbroken && a.last + 1 == b.first };
+    };
+
+    for (size_t size : { 5, 100, 12'345, 100'000 }) {
+
+        Vector<Interval> values;
+
+        for (size_t i = 0; i < size; ++i) {
+
+            values.append({ static_cast<int>(i), static_cast<int>(i) });
+        }
+
+        for (auto policy : { ExecutionPolicy::sequential(), ExecutionPolicy::vectorized(), ExecutionPolicy::parallel(pool) }) {
+
+            auto result = MUST(reduce(policy, values, Interval { -1, -1 }, concatenate));
+
+            EXPECT(result.first == -1);
+
+            EXPECT(result.last == static_cast<int>(size) - 1);
+
+            EXPECT(result.unbroken);
+        }
+    }
+}
+
+// Keys with many repeats and the position each value started at, to tell equal keys apart.
+
+struct Keyed {
+
+    UInt32 key;
+
+    UInt32 index;
+};
+
+static bool keyLess(Keyed const& a, Keyed const& b) { return a.key < b.key; }
+
+static void testMergesSplitIntoBoundedPieces() {
+
+    static constexpr size_t size = 1'000'000;
+
+    static constexpr size_t piece_size = 16'384;
+
+    // A long first run against a short second one, with keys in common.
+
+    static constexpr size_t a_size = size - size / 10;
+
+    Vector<Keyed> source;
+
+    for (size_t i = 0; i < size; ++i) {
+
+        auto key = i < a_size ? i / 3 : (i - a_size) * 29;
+
+        source.append({ static_cast<UInt32>(key), static_cast<UInt32>(i) });
+    }
+
+    Vector<Detail::MergePiece> pieces;
+
+    pieces.ensureCapacity(size / piece_size + 1);
+
+    auto less = keyLess;
+
+    Detail::splitMerge(source.data(), 0, a_size, size, piece_size, pieces, less);
+
+    EXPECT(pieces.size() == (size + piece_size - 1) / piece_size);
+
+    Vector<Keyed> merged;
+
+    merged.resize(size);
+
+    size_t out = 0;
+
+    for (auto const& piece : pieces) {
+
+        auto piece_length = (piece.a_end - piece.a_begin) + (piece.b_end - piece.b_begin);
+
+        EXPECT(piece.out == out && piece_length <= piece_size);
+
+        out += piece_length;
+
+        Detail::mergePiece(source.data(), merged.data(), piece, false, less);
+    }
+
+    EXPECT(out == size);
+
+    size_t misplaced = 0;
+
+    for (size_t i = 1; i < size; ++i) {
+
+        auto const& previous = merged[i - 1];
+
+        auto const& current = merged[i];
+
+        misplaced += previous.key > current.key || (previous.key == current.key && previous.index > current.index);
+    }
+
+    EXPECT(misplaced == 0);
+}
+
+static void testStableSortKeepsEqualKeysInOrder(ThreadPool& pool) {
+
+    static constexpr size_t size = 300'000;
+
+    Vector<Keyed> values;
+
+    UInt32 random_state = 2463534242;
+
+    for (size_t i = 0; i < size; ++i) {
+
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+
+        values.append({ random_state % 1000, static_cast<UInt32>(i) });
+    }
+
+    EXPECT(!stableSort(ExecutionPolicy::parallel(pool), values, keyLess).isError());
+
+    size_t misplaced = 0;
+
+    for (size_t i = 1; i < size; ++i) {
+
+        auto const& previous = values[i - 1];
+
+        auto const& current = values[i];
+
+        misplaced += previous.key > current.key || (previous.key == current.key && previous.index > current.index);
+    }
+
+    EXPECT(misplaced == 0);
+}
+
+// The passes that move values between buffers must touch every index exactly once.
+
+static void testParallelForAllCoversTheRange(ThreadPool& pool) {
+
+    static constexpr size_t count = 100'000;
+
+    static Atomic<UInt8> hits[count];
+
+    Detail::parallelForAll(pool, 0, count, 64, [&](size_t begin, size_t end) {
+
+        for (auto i = begin; i < end; ++i) {
+
+            hits[i].fetchAdd(1, MemoryOrder::memory_order_relaxed);
+        }
+    });
+
+    size_t wrong = 0;
+
+    for (auto& hit : hits) {
+
+        wrong += hit.load(MemoryOrder::memory_order_relaxed) != 1;
+    }
+
+    EXPECT(wrong == 0);
+}
+
+static void testSortAndPartition(ThreadPool& pool) {
+
+    static constexpr size_t size = 300'000;
+
+    Vector<UInt32> values;
+
+    UInt32 random_state = 88675123;
+
+    UInt64 sum = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+
+        values.append(random_state);
+
+        sum += random_state;
+    }
+
+    auto is_even = [](UInt32 value) { return value % 2 == 0; };
+
+    auto even_count = MUST(partition(ExecutionPolicy::parallel(pool), values, is_even));
+
+    size_t misplaced = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+
+        misplaced += is_even(values[i]) != (i < even_count);
+    }
+
+    EXPECT(misplaced == 0);
+
+    EXPECT(!sort(ExecutionPolicy::parallel(pool), values).isError());
+
+    UInt64 sorted_sum = values[0];
+
+    for (size_t i = 1; i < size; ++i) {
+
+        misplaced += values[i - 1] > values[i];
+
+        sorted_sum += values[i];
+    }
+
+    EXPECT(misplaced == 0);
+
+    EXPECT(sorted_sum == sum);
+}
+
+int main() {
+
+    auto pool = MUST(ThreadPool::create(4));
+
+    testReduceKeepsTheOrder(*pool);
+
+    testMergesSplitIntoBoundedPieces();
+
+    testStableSortKeepsEqualKeysInOrder(*pool);
+
+    testParallelForAllCoversTheRange(*pool);
+
+    testSortAndPartition(*pool);
+
+    return Test::exitCode();
+}
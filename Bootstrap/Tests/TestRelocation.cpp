@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Builtins/Array.h"
+#include "Builtins/Dictionary.h"
+#include "Runtime/FlyString.h"
+#include "Runtime/HashTable.h"
+#include "Runtime/Optional.h"
+#include "Runtime/String.h"
+#include "Runtime/SwissHashTable.h"
+#include "Runtime/TypedTransfer.h"
+#include "Runtime/Vector.h"
+
+// Knows its own address and counts itself, so that a memcpy where a move was due, a leak or a second destruction
+// all show. It is what every type that does not opt in looks like to the containers.
+
+struct Tracked {
+
+    static inline Int64 s_alive = 0;
+
+    static inline size_t s_misplaced = 0;
+
+    Tracked(size_t value = 0)
+        : value(value), self(this) { ++s_alive; }
+
+    Tracked(Tracked const& other)
+        : value(other.value), self(this) { other.check(); ++s_alive; }
+
+    Tracked(Tracked&& other)
+        : value(other.value), self(this) { other.check(); ++s_alive; }
+
+    Tracked& operator=(Tracked const& other) {
+
+        check();
+
+        other.check();
+
+        value = other.value;
+
+        return *this;
+    }
+
+    ~Tracked() {
+
+        check();
+
+        self = nullptr;
+
+        --s_alive;
+    }
+
+    void check() const { s_misplaced += self != this; }
+
+    bool operator==(Tracked const& other) const { return value == other.value; }
+
+    size_t value;
+
+    Tracked* self;
+};
+
+template<>
+struct Traits<Tracked> : public GenericTraits<Tracked> {
+
+    static unsigned hash(Tracked const& tracked) { return UInt64Hash(tracked.value); }
+};
+
+// Which types the containers may move with memcpy, and which they must not.
+
+static_assert(Traits<int>::isTriviallyRelocatable());
+static_assert(Traits<String>::isTriviallyRelocatable());
+static_assert(Traits<FlyString>::isTriviallyRelocatable());
+static_assert(Traits<ReferencePointer<StringImpl>>::isTriviallyRelocatable());
+static_assert(Traits<NonNullReferencePointer<StringImpl>>::isTriviallyRelocatable());
+static_assert(Traits<Optional<String>>::isTriviallyRelocatable());
+static_assert(Traits<Vector<String, 4>>::isTriviallyRelocatable());
+static_assert(Traits<Vector<Tracked>>::isTriviallyRelocatable());
+static_assert(Traits<Array<Tracked>>::isTriviallyRelocatable());
+static_assert(Traits<Dictionary<String, Tracked>>::isTriviallyRelocatable());
+static_assert(!Traits<Tracked>::isTriviallyRelocatable());
+static_assert(!Traits<Optional<Tracked>>::isTriviallyRelocatable());
+static_assert(!Traits<Vector<Tracked, 4>>::isTriviallyRelocatable());
+
+template<typename T>
+static T makeValue(size_t i) {
+
+    if constexpr (IsSame<T, String>) {
+
+        // Alternately inline and in a StringImpl.
+
+        return i % 2 ? String::formatted("{}", i) : String::formatted("string number {}, long enough for the heap", i);
+    }
+    else if constexpr (IsSame<T, Vector<String, 4>>) {
+
+        Vector<String, 4> vector;
+
+        for (size_t j = 0; j <= i % 7; ++j) {
+
+            vector.append(makeValue<String>(i + j));
+        }
+
+        return vector;
+    }
+    else {
+
+        return T(i);
+    }
+}
+
+template<typename T>
+static void testRelocate() {
+
+    constexpr size_t count = 50;
+
+    alignas(T) static UInt8 source_bytes[count * sizeof(T)];
+
+    alignas(T) static UInt8 destination_bytes[count * sizeof(T)];
+
+    auto* source = reinterpret_cast<T*>(source_bytes);
+
+    auto* destination = reinterpret_cast<T*>(destination_bytes);
+
+    for (size_t i = 0; i < count; ++i) {
+
+        new (&source[i]) T(makeValue<T>(i));
+    }
+
+    TypedTransfer<T>::relocate(destination, source, count);
+
+    size_t wrong = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        wrong += !(destination[i] == makeValue<T>(i));
+
+        destination[i].~T();
+    }
+
+    EXPECT(wrong == 0);
+}
+
+// Growing moves every element to new memory, a few times over.
+
+template<typename T, size_t inline_capacity>
+static void testVectorGrowth() {
+
+    constexpr size_t count = 5000;
+
+    Vector<T, inline_capacity> vector;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        vector.append(makeValue<T>(i));
+    }
+
+    // Inserting at the front shifts everything, then moving the vector moves the buffer or the inline elements.
+
+    vector.prepend(makeValue<T>(count));
+
+    auto moved = move(vector);
+
+    size_t wrong = moved.size() != count + 1 || !(moved[0] == makeValue<T>(count));
+
+    for (size_t i = 0; i < count && !wrong; ++i) {
+
+        wrong += !(moved[i + 1] == makeValue<T>(i));
+    }
+
+    EXPECT(wrong == 0);
+
+    // A vector that never leaves its inline buffer is moved element by element, or with memcpy if they allow it.
+
+    Vector<T, inline_capacity> small;
+
+    for (size_t i = 0; i < inline_capacity; ++i) {
+
+        small.append(makeValue<T>(i));
+    }
+
+    auto small_moved = move(small);
+
+    wrong = small_moved.size() != inline_capacity;
+
+    for (size_t i = 0; i < inline_capacity && !wrong; ++i) {
+
+        wrong += !(small_moved[i] == makeValue<T>(i));
+    }
+
+    EXPECT(wrong == 0);
+}
+
+template<typename T>
+static void testArrayGrowth() {
+
+    constexpr size_t count = 5000;
+
+    Array<T> array;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        MUST(array.push(makeValue<T>(i)));
+    }
+
+    MUST(array.resize(count / 2));
+
+    MUST(array.shrinkToFit());
+
+    size_t wrong = array.size() != count / 2;
+
+    for (size_t i = 0; i < count / 2 && !wrong; ++i) {
+
+        wrong += !(array[i] == makeValue<T>(i));
+    }
+
+    EXPECT(wrong == 0);
+}
+
+// Rehashing relocates every value into the new buckets; removals shift the Robin Hood buckets back.
+
+template<typename Table, typename T>
+static void testHashTableGrowth() {
+
+    constexpr size_t count = 5000;
+
+    Table table;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        MUST(table.try_set(makeValue<T>(i)));
+    }
+
+    for (size_t i = 0; i < count; i += 3) {
+
+        EXPECT(table.remove(makeValue<T>(i)));
+    }
+
+    size_t wrong = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        wrong += table.contains(makeValue<T>(i)) == (i % 3 == 0);
+    }
+
+    for (auto& value : table) {
+
+        if constexpr (IsSame<T, Tracked>) {
+
+            value.check();
+        }
+    }
+
+    EXPECT(wrong == 0);
+
+    EXPECT(table.size() == count - (count + 2) / 3);
+}
+
+int main() {
+
+    testRelocate<String>();
+
+    testRelocate<Tracked>();
+
+    testRelocate<Vector<String, 4>>();
+
+    testVectorGrowth<String, 0>();
+
+    testVectorGrowth<String, 16>();
+
+    testVectorGrowth<Tracked, 0>();
+
+    testVectorGrowth<Tracked, 16>();
+
+    testVectorGrowth<Vector<String, 4>, 2>();
+
+    testArrayGrowth<String>();
+
+    testArrayGrowth<Tracked>();
+
+    testHashTableGrowth<HashTable<String>, String>();
+
+    testHashTableGrowth<OrderedHashTable<String>, String>();
+
+    testHashTableGrowth<SwissHashTable<String>, String>();
+
+    testHashTableGrowth<HashTable<Tracked>, Tracked>();
+
+    testHashTableGrowth<SwissHashTable<Tracked>, Tracked>();
+
+    EXPECT(Tracked::s_alive == 0);
+
+    EXPECT(Tracked::s_misplaced == 0);
+
+    return Test::exitCode();
+}
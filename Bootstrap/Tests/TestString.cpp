@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/FlyString.h"
+#include "Runtime/String.h"
+#include "Runtime/StringBuilder.h"
+#include "Runtime/StringImpl.h"
+#include "Runtime/StringView.h"
+#include "Runtime/Vector.h"
+#include <string.h>
+
+#ifdef __GLIBC__
+#    include <malloc.h>
+#endif
+
+static UInt64 s_randomState = 0x9e3779b97f4a7c15;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+static char s_text[256];
+
+static void fillText() {
+
+    for (auto& character : s_text) {
+
+        character = static_cast<char>('!' + random64() % 94);
+    }
+}
+
+// Whether `string` holds exactly the first `length` characters of s_text, NUL-terminated.
+
+static bool holdsText(String const& string, size_t length) {
+
+    return !string.isNull()
+        && string.length() == length
+        && memcmp(string.characters(), s_text, length) == 0
+        && string.characters()[length] == '\0'
+        && string == StringView(s_text, length);
+}
+
+// Up to inlineCapacity (22) characters a String holds its characters itself; from 23 on it needs a StringImpl.
+
+static void testInlineBoundary() {
+
+    static_assert(String::inlineCapacity == 22);
+
+    for (size_t length = 0; length <= 40; ++length) {
+
+        String string { s_text, length };
+
+        EXPECT(holdsText(string, length));
+
+        EXPECT((string.impl() == nullptr) == (length <= String::inlineCapacity));
+
+        String viewed { StringView(s_text, length) };
+
+        EXPECT(holdsText(viewed, length));
+
+        EXPECT((viewed.impl() == nullptr) == (length <= String::inlineCapacity));
+    }
+
+    EXPECT(String().isNull());
+
+    EXPECT(String().impl() == nullptr);
+
+    EXPECT(!String::empty().isNull());
+
+    EXPECT(String::empty().isEmpty());
+
+    EXPECT(String(static_cast<char const*>(nullptr)).isNull());
+}
+
+// Copies of inline strings are independent objects; copies of longer ones share the StringImpl. Either way the
+// copy equals the original, and a moved-from String is null.
+
+static void testCopyAndMove() {
+
+    for (size_t length : { 0, 1, 21, 22, 23, 24, 100 }) {
+
+        String original { s_text, length };
+
+        String copy { original };
+
+        EXPECT(holdsText(copy, length));
+
+        EXPECT(copy.impl() == original.impl());
+
+        if (length <= String::inlineCapacity) {
+
+            EXPECT(copy.characters() != original.characters());
+        }
+
+        String moved { move(copy) };
+
+        EXPECT(holdsText(moved, length));
+
+        EXPECT(copy.isNull());
+
+        String assigned { "something else entirely, and long" };
+
+        assigned = moved;
+
+        EXPECT(holdsText(assigned, length));
+
+        assigned = move(moved);
+
+        EXPECT(holdsText(assigned, length));
+
+        auto& alias = assigned;
+
+        assigned = alias;
+
+        EXPECT(holdsText(assigned, length));
+
+        EXPECT(holdsText(original, length));
+    }
+}
+
+// A short string may also arrive in a StringImpl (from StringImpl::create(), say). It must compare and hash the
+// same as the inline form, or table lookups would miss it.
+
+static void testInlineAndImplFormsAgree() {
+
+    for (size_t length = 0; length <= String::inlineCapacity; ++length) {
+
+        String inline_form { s_text, length };
+
+        String impl_form { StringImpl::create(s_text, length) };
+
+        if (length) {
+
+            EXPECT(impl_form.impl() != nullptr);
+        }
+
+        EXPECT(holdsText(impl_form, length));
+
+        EXPECT(inline_form == impl_form);
+
+        EXPECT(impl_form == inline_form);
+
+        EXPECT(!(inline_form < impl_form) && !(impl_form < inline_form));
+
+        EXPECT(inline_form.hash() == impl_form.hash());
+
+        EXPECT(inline_form.caseInsensitiveHash() == impl_form.caseInsensitiveHash());
+
+        EXPECT(inline_form.hash() == StringView(s_text, length).hash());
+    }
+}
+
+// Strings of random lengths around the boundary kept in a Vector that keeps growing and shuffling, so that inline
+// and heap strings are copied, moved and destroyed in every combination.
+
+static void testRandomCopiesAndMoves() {
+
+    Vector<String> strings;
+
+    Vector<size_t> lengths;
+
+    for (size_t step = 0; step < 20000; ++step) {
+
+        auto choice = random64() % 4;
+
+        if (choice == 0 || strings.isEmpty()) {
+
+            auto length = random64() % 48;
+
+            strings.append(String(s_text, length));
+
+            lengths.append(length);
+        }
+        else if (choice == 1) {
+
+            auto from = random64() % strings.size();
+
+            strings.append(strings[from]);
+
+            lengths.append(lengths[from]);
+        }
+        else if (choice == 2) {
+
+            auto from = random64() % strings.size();
+
+            auto to = random64() % strings.size();
+
+            strings[to] = move(strings[from]);
+
+            lengths[to] = lengths[from];
+
+            if (from != to) {
+
+                strings[from] = String(s_text, 0);
+
+                lengths[from] = 0;
+            }
+        }
+        else {
+
+            auto at = random64() % strings.size();
+
+            strings.remove(at);
+
+            lengths.remove(at);
+        }
+    }
+
+    size_t wrong = 0;
+
+    for (size_t i = 0; i < strings.size(); ++i) {
+
+        wrong += !holdsText(strings[i], lengths[i]);
+    }
+
+    EXPECT(wrong == 0);
+}
+
+// A loop of += appends in place, growing the StringImpl geometrically, so it only moves a few dozen times.
+
+static void testAppendInPlace() {
+
+    String string;
+
+    Vector<char> expected;
+
+    size_t moves = 0;
+
+    StringImpl const* last_impl = nullptr;
+
+    for (size_t i = 0; i < 20000; ++i) {
+
+        auto piece = StringView(s_text + i % 200, 1 + i % 3);
+
+        string += piece;
+
+        expected.append(piece.charactersWithoutNullTermination(), piece.length());
+
+        if (string.impl() != last_impl) {
+
+            last_impl = string.impl();
+
+            ++moves;
+        }
+    }
+
+    EXPECT(string == StringView(expected.data(), expected.size()));
+
+    EXPECT(string.characters()[string.length()] == '\0');
+
+    EXPECT(moves < 40);
+}
+
+// Appending never changes what other Strings or FlyStrings see, even when they share the StringImpl.
+
+static void testAppendLeavesSharedStringsAlone() {
+
+    String original { s_text, 50 };
+
+    String copy = original;
+
+    copy += "tail";
+
+    EXPECT(holdsText(original, 50));
+
+    EXPECT(copy.length() == 54 && copy.view().startsWith(StringView(s_text, 50)) && copy.endsWith("tail"));
+
+    // The last reference to an interned StringImpl is still the table's string; it must be copied, not grown.
+
+    String from_fly;
+
+    {
+        FlyString fly { String(s_text, 60) };
+
+        from_fly = String(*fly.impl());
+    }
+
+    from_fly += "tail";
+
+    EXPECT(FlyString(StringView(s_text, 60)) == StringView(s_text, 60));
+
+    EXPECT(from_fly.length() == 64 && from_fly.endsWith("tail"));
+}
+
+// s += s, and s += a view into s, in every form s can take: inline, inline growing past the boundary, unique
+// StringImpl (whose buffer may move while its own characters are being appended) and shared StringImpl.
+
+static void testSelfAppend() {
+
+    for (size_t length : { 1, 5, 11, 15, 22, 23, 40, 200 }) {
+
+        String string { s_text, length };
+
+        string += string;
+
+        EXPECT(string.length() == 2 * length);
+
+        EXPECT(string.substringView(0, length) == StringView(s_text, length));
+
+        EXPECT(string.substringView(length) == StringView(s_text, length));
+
+        for (size_t round = 0; round < 6 && string.length() < 5000; ++round) {
+
+            auto before = string.length();
+
+            string += string.view();
+
+            EXPECT(string.length() == 2 * before && string.substringView(before) == string.substringView(0, before));
+        }
+
+        String shared { s_text, length };
+
+        String other = shared;
+
+        shared += shared;
+
+        EXPECT(holdsText(other, length));
+
+        EXPECT(shared.length() == 2 * length && shared.substringView(length) == StringView(s_text, length));
+
+        String tail { s_text, length };
+
+        tail += tail.substringView(length / 2);
+
+        EXPECT(tail.length() == length + (length - length / 2));
+
+        EXPECT(tail.substringView(length) == StringView(s_text + length / 2, length - length / 2));
+    }
+}
+
+static void testConcatenation() {
+
+    for (size_t a_length : { 0, 3, 20, 40 }) {
+
+        for (size_t b_length : { 0, 2, 19, 30 }) {
+
+            String a { s_text, a_length };
+
+            String b { s_text + 100, b_length };
+
+            String c { s_text + 200, 7 };
+
+            auto joined = a + b + c;
+
+            EXPECT(joined.length() == a_length + b_length + 7);
+
+            EXPECT(joined.substringView(0, a_length) == a);
+
+            EXPECT(joined.substringView(a_length, b_length) == b);
+
+            EXPECT(joined.substringView(a_length + b_length) == c);
+
+            EXPECT((joined.impl() == nullptr) == (joined.length() <= String::inlineCapacity));
+
+            EXPECT(holdsText(a, a_length));
+        }
+    }
+}
+
+// build() hands the builder's buffer to the String, without keeping more than a quarter of its length spare.
+
+static void testBuildGivesBackSlack() {
+
+    for (size_t length : { 1, 22, 23, 100, 3000, 600000 }) {
+
+        StringBuilder builder;
+
+        for (size_t i = 0; i < length; ++i) {
+
+            builder.append(s_text[i % 256]);
+        }
+
+        auto string = builder.build();
+
+        EXPECT(string.length() == length);
+
+        EXPECT(string.characters()[length] == '\0');
+
+        size_t wrong = 0;
+
+        for (size_t i = 0; i < length; ++i) {
+
+            wrong += string[i] != s_text[i % 256];
+        }
+
+        EXPECT(wrong == 0);
+
+        EXPECT(builder.isEmpty());
+
+#ifdef __GLIBC__
+        // Past the slab sizes the StringImpl comes straight from malloc().
+
+        if (length > 100000) {
+
+            EXPECT(malloc_usable_size(string.impl()) <= allocationSizeForStringImpl(length + length / 4));
+        }
+#endif
+
+        string += "more";
+
+        EXPECT(string.length() == length + 4 && string.endsWith("more"));
+    }
+}
+
+int main() {
+
+    fillText();
+
+    testInlineBoundary();
+
+    testCopyAndMove();
+
+    testInlineAndImplFormsAgree();
+
+    testRandomCopiesAndMoves();
+
+    testAppendInPlace();
+
+    testAppendLeavesSharedStringsAlone();
+
+    testSelfAppend();
+
+    testConcatenation();
+
+    testBuildGivesBackSlack();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/CharacterTypes.h"
+#include "Runtime/String.h"
+#include "Runtime/StringHash.h"
+#include "Runtime/StringView.h"
+#include "Runtime/Traits.h"
+#include <string.h>
+
+static UInt64 s_randomState = 0x5851f42d4c957f2d;
+
+static UInt64 random64() {
+
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 7;
+    s_randomState ^= s_randomState << 17;
+
+    return s_randomState;
+}
+
+// Long enough for the three-lane loop past 48 bytes, with mixed case for the case-insensitive hash.
+
+static constexpr char text[] = "The Quick Brown Fox jumps over the Lazy Dog, then keeps on RUNNING far beyond the fields.";
+
+static constexpr UInt64 testSeed = 0x0123456789abcdef;
+
+struct PrefixHashes {
+
+    UInt64 exact[sizeof(text)];
+
+    UInt64 ignoringCase[sizeof(text)];
+};
+
+static constexpr PrefixHashes constantHashes = [] {
+
+    PrefixHashes hashes { };
+
+    for (size_t length = 0; length < sizeof(text); ++length) {
+
+        hashes.exact[length] = stringHash64(text, length, testSeed);
+
+        hashes.ignoringCase[length] = caseInsensitiveStringHash64(text, length, testSeed);
+    }
+
+    return hashes;
+}();
+
+// Compile-time evaluation reads bytes one at a time, run time reads words; both have to land on the same hash.
+
+static void testConstantAndRuntimeHashesAgree() {
+
+    size_t mismatches = 0;
+
+    for (size_t length = 0; length < sizeof(text); ++length) {
+
+        mismatches += stringHash64(text, length, testSeed) != constantHashes.exact[length];
+
+        mismatches += caseInsensitiveStringHash64(text, length, testSeed) != constantHashes.ignoringCase[length];
+    }
+
+    EXPECT(mismatches == 0);
+}
+
+// Flipping any bit of any byte changes the hash, at every length the different word sizes and lanes handle, and
+// where the characters start in memory does not matter.
+
+static void testEveryByteCounts() {
+
+    static char buffer[208];
+
+    static char shifted[216];
+
+    size_t unchanged = 0;
+
+    size_t misaligned = 0;
+
+    for (size_t length = 1; length <= 200; ++length) {
+
+        for (size_t i = 0; i < length; ++i) {
+
+            buffer[i] = static_cast<char>(random64());
+        }
+
+        auto hash = stringHash64(buffer, length, testSeed);
+
+        for (size_t offset = 1; offset < 8; ++offset) {
+
+            memcpy(shifted + offset, buffer, length);
+
+            misaligned += stringHash64(shifted + offset, length, testSeed) != hash;
+        }
+
+        for (size_t i = 0; i < length; ++i) {
+
+            auto bit = static_cast<char>(1 << (random64() % 8));
+
+            buffer[i] ^= bit;
+
+            unchanged += stringHash64(buffer, length, testSeed) == hash;
+
+            buffer[i] ^= bit;
+        }
+
+        // The length counts too: a zero byte more is a different string.
+
+        buffer[length] = 0;
+
+        unchanged += stringHash64(buffer, length + 1, testSeed) == hash;
+    }
+
+    EXPECT(unchanged == 0);
+
+    EXPECT(misaligned == 0);
+}
+
+static void testCaseInsensitiveHashesIgnoreCase() {
+
+    static char mixed[200];
+
+    static char lower[200];
+
+    size_t mismatches = 0;
+
+    for (size_t length = 0; length <= 200; length += 7) {
+
+        for (size_t i = 0; i < length; ++i) {
+
+            lower[i] = static_cast<char>('a' + random64() % 26);
+
+            mixed[i] = random64() % 2 ? static_cast<char>(toAsciiUppercase(lower[i])) : lower[i];
+        }
+
+        mismatches += caseInsensitiveStringHash64(mixed, length, testSeed) != caseInsensitiveStringHash64(lower, length, testSeed);
+    }
+
+    EXPECT(mismatches == 0);
+
+    // Only ASCII letters fold: '@' and '`' sit next to 'A' and 'a' but are not letters.
+
+    EXPECT(caseInsensitiveStringHash64("@", 1, testSeed) != caseInsensitiveStringHash64("`", 1, testSeed));
+}
+
+// String (inline or not), StringView and char const* keys hash alike, so each can look up the others.
+
+static void testKeyTypesHashAlike() {
+
+    static char const* const keys[] = { "", "a", "short", "twenty-two characters", "a string too long to be kept inline by String" };
+
+    for (auto const* characters : keys) {
+
+        String string { characters };
+
+        StringView view { characters };
+
+        EXPECT(Traits<String>::hash(string) == Traits<StringView>::hash(view));
+
+        EXPECT(Traits<char const*>::hash(characters) == Traits<StringView>::hash(view));
+
+        EXPECT(CaseInsensitiveStringTraits::hash(string) == CaseInsensitiveStringViewTraits::hash(view));
+
+        EXPECT(CaseInsensitiveStringTraits::hash(string) == CaseInsensitiveStringTraits::hash(string.to_uppercase()));
+    }
+
+    EXPECT(Traits<StringView>::hash(StringView("")) == 0);
+}
+
+int main() {
+
+    testConstantAndRuntimeHashesAgree();
+
+    testEveryByteCounts();
+
+    testCaseInsensitiveHashesIgnoreCase();
+
+    testKeyTypesHashAlike();
+
+    return Test::exitCode();
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Test.h"
+#include "Runtime/Arena.h"
+#include "Runtime/Atomic.h"
+#include "Runtime/ThreadPool.h"
+#include "Runtime/Vector.h"
+#include <errno.h>
+
+static void testParallelForCoversTheRange(ThreadPool& pool) {
+
+    static constexpr size_t count = 100'000;
+
+    static Atomic<UInt8> hits[count];
+
+    auto result = parallelFor(pool, 0, count, 64, [&](size_t begin, size_t end) -> ErrorOr<void> {
+
+        for (auto i = begin; i < end; ++i) {
+
+            hits[i].fetchAdd(1, MemoryOrder::memory_order_relaxed);
+        }
+
+        return { };
+    });
+
+    EXPECT(!result.isError());
+
+    size_t wrong = 0;
+
+    for (auto& hit : hits) {
+
+        wrong += hit.load(MemoryOrder::memory_order_relaxed) != 1;
+    }
+
+    EXPECT(wrong == 0);
+}
+
+// Tasks are spawned by the thread in the scope but freed by workers that have none; they must not come from the
+// arena.
+
+static void testParallelForInsideAnArenaScope(ThreadPool& pool) {
+
+    Arena arena;
+
+    for (size_t round = 0; round < 10; ++round) {
+
+        ArenaScope scope { arena };
+
+        Atomic<size_t> total { 0 };
+
+        auto result = parallelFor(pool, 0, 100'000, 64, [&](size_t begin, size_t end) -> ErrorOr<void> {
+
+            // Allocations the chunks make themselves come from the heap: the workers have no scope.
+
+            Vector<size_t> scratch;
+
+            TRY(scratch.tryAppend(end - begin));
+
+            total.fetchAdd(scratch[0], MemoryOrder::memory_order_relaxed);
+
+            return { };
+        });
+
+        EXPECT(!result.isError());
+
+        EXPECT(total.load(MemoryOrder::memory_order_relaxed) == 100'000);
+    }
+}
+
+static void testFirstErrorIsReported(ThreadPool& pool) {
+
+    TaskGroup group { pool };
+
+    Atomic<size_t> ran { 0 };
+
+    for (size_t i = 0; i < 100; ++i) {
+
+        MUST(group.spawn([&ran, i]() -> ErrorOr<void> {
+
+            ran.fetchAdd(1, MemoryOrder::memory_order_relaxed);
+
+            if (i == 50) {
+
+                return Error::fromErrorCode(EINVAL);
+            }
+
+            return { };
+        }));
+    }
+
+    auto result = group.join();
+
+    EXPECT(result.isError() && result.error().code() == EINVAL);
+
+    EXPECT(ran.load(MemoryOrder::memory_order_relaxed) == 100);
+
+    EXPECT(!group.join().isError());
+}
+
+int main() {
+
+    auto pool = MUST(ThreadPool::create(4));
+
+    testParallelForCoversTheRange(*pool);
+
+    testParallelForInsideAnArenaScope(*pool);
+
+    testFirstErrorIsReported(*pool);
+
+    return Test::exitCode();
+}